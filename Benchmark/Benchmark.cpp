@@ -0,0 +1,239 @@
+import Assets.Mesh;
+import Engine;
+import Engine.Camera;
+import Engine.Viewport;
+import Geometry;
+import Math;
+import Render.Commands;
+import Render.DynamicResolution;
+import Render.Primitives;
+import Render.Viewport;
+import Systems.RenderSynchronizer;
+import World;
+import std;
+
+// Renders a fixed scene along a scripted camera path without a window and reports how long every frame took on the CPU.
+// Frames are rendered in lockstep with the simulation, so two runs of the same build draw exactly the same frames.
+// Frames that request a capture or encode one are flagged in the CSV and left out of the summary.
+//
+// Usage: Benchmark [--frames N] [--warmup N] [--size WxH] [--grid N] [--output timings.csv]
+//                  [--capture-dir DIR] [--capture-every N]
+
+namespace
+{
+    struct Options
+    {
+        UInt32 frames{1000};
+        UInt32 warmupFrames{60}; // Not timed, while pipelines and uploads settle
+        Size2D size{1920, 1080};
+        Int32 grid{64};          // Cones per side of the grid
+        std::filesystem::path output{"timings.csv"};
+        std::filesystem::path captureDirectory; // No captures when empty
+        UInt32 captureEvery{100};
+    };
+
+    std::optional<Options> parseOptions(std::span<char*> args)
+    {
+        Options options;
+
+        for (std::size_t i = 1; i < args.size(); ++i)
+        {
+            const std::string_view arg = args[i];
+            const bool hasValue = i + 1 < args.size();
+            const std::string_view value = hasValue ? args[i + 1] : "";
+
+            auto parseNumber = [&]<typename T>(T& result)
+            {
+                const auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), result);
+                return error == std::errc{} && end == value.data() + value.size();
+            };
+
+            bool valid = hasValue;
+
+            if (arg == "--frames")
+                valid = valid && parseNumber(options.frames);
+            else if (arg == "--warmup")
+                valid = valid && parseNumber(options.warmupFrames);
+            else if (arg == "--grid")
+                valid = valid && parseNumber(options.grid) && options.grid > 0;
+            else if (arg == "--capture-every")
+                valid = valid && parseNumber(options.captureEvery) && options.captureEvery > 0;
+            else if (arg == "--output")
+                options.output = value;
+            else if (arg == "--capture-dir")
+                options.captureDirectory = value;
+            else if (arg == "--size")
+            {
+                const std::size_t separator = value.find('x');
+                valid = valid && separator != std::string_view::npos
+                    && std::from_chars(value.data(), value.data() + separator, options.size.width).ec == std::errc{}
+                    && std::from_chars(value.data() + separator + 1, value.data() + value.size(), options.size.height).ec == std::errc{}
+                    && options.size.width > 0 && options.size.height > 0;
+            }
+            else
+                valid = false;
+
+            if (!valid)
+            {
+                std::cerr << "Invalid argument '" << arg << "'\n"
+                          << "Usage: Benchmark [--frames N] [--warmup N] [--size WxH] [--grid N] [--output timings.csv] "
+                             "[--capture-dir DIR] [--capture-every N]\n";
+                return std::nullopt;
+            }
+
+            ++i;
+        }
+
+        return options;
+    }
+
+    // A grid of cones on the XZ plane, centered on the origin
+    void createScene(WorldHandle world, const MeshData& mesh, Int32 grid)
+    {
+        static constexpr float spacing = 3.f;
+        const float offset = static_cast<float>(grid - 1) * spacing * 0.5f;
+
+        World& scene = Engine::getWorld(world);
+
+        for (Int32 x = 0; x < grid; ++x)
+        {
+            for (Int32 z = 0; z < grid; ++z)
+            {
+                const Vec3 position{static_cast<float>(x) * spacing - offset, 0.f, static_cast<float>(z) * spacing - offset};
+                const Vec4 tint{static_cast<float>(x) / static_cast<float>(grid), 0.5f, static_cast<float>(z) / static_cast<float>(grid), 1.f};
+
+                Engine::getRenderCommandQueue().addCommand(RenderCommands::AddObject
+                {
+                    .world = world,
+                    .entity = scene.createEntity(),
+                    .mesh = &mesh,
+                    .worldTransform = Math::translate(Mat4{1}, position),
+                    .tint = tint,
+                });
+            }
+        }
+    }
+
+    // Orbits the grid while bobbing up and down, so the visible set changes from frame to frame. Only depends on the
+    // frame index, never on time.
+    Camera cameraAt(UInt32 frame, UInt32 frameCount, float sceneRadius, float aspectRatio)
+    {
+        const float t = static_cast<float>(frame) / static_cast<float>(std::max(frameCount, 1u));
+        const float angle = t * 2.f * Math::pi<float>();
+
+        const Vec3 position
+        {
+            Math::cos(angle) * sceneRadius * 1.2f,
+            sceneRadius * (0.2f + 0.3f * (0.5f + 0.5f * Math::sin(angle * 3.f))),
+            Math::sin(angle) * sceneRadius * 1.2f,
+        };
+
+        Mat4 projection = Math::perspective(Math::radians(60.f), aspectRatio, 0.1f, sceneRadius * 4.f);
+        projection[1][1] *= -1.0f;
+
+        return {.view = Math::lookAt(position, Vec3{0.f}, upVector()), .proj = projection};
+    }
+
+    float percentile(std::span<const float> sorted, float fraction)
+    {
+        const auto index = static_cast<std::size_t>(fraction * static_cast<float>(sorted.size() - 1) + 0.5f);
+        return sorted[index];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::optional<Options> options = parseOptions({argv, static_cast<std::size_t>(argc)});
+    if (!options)
+        return 1;
+
+    Engine::addSystem(RenderSynchronizer::callbacks);
+    Engine::initHeadless(options->size);
+
+    const MeshData cone = Primitives::generateCone(0.5f, 1.5f, 32);
+    const WorldHandle world = Engine::createWorld();
+    createScene(world, cone, options->grid);
+
+    Engine::start();
+
+    // The world reaches the renderer with the first frame, only then can a viewport show it
+    Engine::update();
+    const ViewportId viewport = Engine::createViewport({world}, Rect{.position = {0, 0}, .size = options->size});
+
+    // Every frame renders at full resolution, otherwise a slower build would get away with drawing fewer pixels
+    Engine::viewports().setDynamicResolution(viewport, DynamicResolutionSettings{.enabled = false});
+
+    const float sceneRadius = static_cast<float>(options->grid) * 1.5f;
+    const float aspectRatio = static_cast<float>(options->size.width) / static_cast<float>(options->size.height);
+
+    std::vector<float> frameTimes;
+    std::vector<bool> capturedFrames;
+    frameTimes.reserve(options->frames);
+    capturedFrames.reserve(options->frames);
+
+    const UInt32 totalFrames = options->warmupFrames + options->frames;
+
+    for (UInt32 frame = 0; frame < totalFrames; ++frame)
+    {
+        const Camera camera = cameraAt(frame, totalFrames, sceneRadius, aspectRatio);
+        Engine::viewports().setCamera(viewport, camera);
+        Engine::getRenderCommandQueue().addCommand(RenderCommands::SetCamera{.world = world, .camera = camera});
+
+        const bool measured = frame >= options->warmupFrames;
+        const UInt32 measuredFrame = frame - options->warmupFrames;
+
+        const bool requestsCapture = measured && !options->captureDirectory.empty() && measuredFrame % options->captureEvery == 0;
+        if (requestsCapture)
+            Engine::captureFrame(options->captureDirectory / std::format("frame_{:05}.png", measuredFrame));
+
+        const UInt32 capturesBefore = Engine::getCapturedFrameCount();
+
+        const auto start = std::chrono::steady_clock::now();
+        Engine::update();
+        const auto end = std::chrono::steady_clock::now();
+
+        const bool captured = requestsCapture || Engine::getCapturedFrameCount() != capturesBefore;
+
+        if (measured)
+        {
+            frameTimes.push_back(std::chrono::duration<float, std::milli>(end - start).count());
+            capturedFrames.push_back(captured);
+        }
+    }
+
+    const auto graphStats = Engine::getRenderGraphStats();
+
+    Engine::shutdown();
+
+    if (std::ofstream file{options->output}; file)
+    {
+        file << "frame,cpu_ms,captured\n";
+        for (std::size_t i = 0; i < frameTimes.size(); ++i)
+            file << i << ',' << frameTimes[i] << ',' << (capturedFrames[i] ? 1 : 0) << '\n';
+    }
+    else
+        std::cerr << "Failed to write '" << options->output.generic_string() << "'\n";
+
+    std::vector<float> sorted;
+    sorted.reserve(frameTimes.size());
+    for (std::size_t i = 0; i < frameTimes.size(); ++i)
+    {
+        if (!capturedFrames[i])
+            sorted.push_back(frameTimes[i]);
+    }
+
+    if (sorted.empty())
+        return 0;
+
+    std::ranges::sort(sorted);
+
+    const float average = std::accumulate(sorted.begin(), sorted.end(), 0.f) / static_cast<float>(sorted.size());
+
+    std::cout << std::format("{} frames at {}x{}, {} objects\n", frameTimes.size(), options->size.width, options->size.height, options->grid * options->grid)
+              << std::format("{} frames with captures left out\n", frameTimes.size() - sorted.size())
+              << std::format("CPU frame time (ms): avg {:.3f}  p50 {:.3f}  p95 {:.3f}  p99 {:.3f}  max {:.3f}\n",
+                             average, percentile(sorted, 0.5f), percentile(sorted, 0.95f), percentile(sorted, 0.99f), sorted.back())
+              << std::format("Render graph: {} passes, {} barriers\n", graphStats.passes.size(), graphStats.barriers);
+
+    return 0;
+}
@@ -0,0 +1,173 @@
+import Math;
+import Physics;
+import Physics.AabbTree;
+import std;
+
+// Traces the same rays through one AABB tree with the scalar rayCast and with 4-wide ray packets, the way
+// Physics::lineTraceBatch does, and compares the time per ray. Coherent rays come from a pinhole camera, incoherent ones
+// have random origins and directions. Both paths have to agree on every hit.
+//
+// Usage: LineTraceBenchmark [--boxes N] [--rays N] [--repeats N]
+
+namespace
+{
+    struct Options
+    {
+        UInt32 boxes{10'000};
+        UInt32 rays{256 * 256};
+        UInt32 repeats{20}; // The fastest repeat is reported
+    };
+
+    std::optional<Options> parseOptions(std::span<char*> args)
+    {
+        Options options;
+
+        for (std::size_t i = 1; i + 1 < args.size(); i += 2)
+        {
+            const std::string_view arg = args[i];
+            const std::string_view value = args[i + 1];
+
+            UInt32* target = arg == "--boxes" ? &options.boxes : arg == "--rays" ? &options.rays : arg == "--repeats" ? &options.repeats : nullptr;
+            if (!target || std::from_chars(value.data(), value.data() + value.size(), *target).ec != std::errc{} || *target == 0)
+                return std::nullopt;
+        }
+
+        if (args.size() % 2 == 0)
+            return std::nullopt;
+
+        return options;
+    }
+
+    constexpr float worldSize = 200.f;
+
+    AabbTree createTree(UInt32 boxCount, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> position{-worldSize * 0.5f, worldSize * 0.5f};
+        std::uniform_real_distribution<float> extent{0.25f, 1.5f};
+
+        AabbTree tree;
+        for (UInt32 i = 0; i < boxCount; ++i)
+        {
+            const Vec3 center{position(random), position(random), position(random)};
+            const Vec3 halfSize{extent(random), extent(random), extent(random)};
+            tree.update(Entity{i}, {center - halfSize, center + halfSize}, TraceChannel{TraceChannelFlags::Default});
+        }
+
+        tree.rebuild();
+        return tree;
+    }
+
+    // Rows of neighbouring pixels, so consecutive rays, and with them each packet, are coherent
+    std::vector<Ray> createCameraRays(UInt32 count)
+    {
+        const auto side = static_cast<UInt32>(std::sqrt(static_cast<float>(count)));
+        const Vec3 origin{0.f, 0.f, -worldSize};
+
+        std::vector<Ray> rays;
+        rays.reserve(static_cast<std::size_t>(side) * side);
+
+        for (UInt32 y = 0; y < side; ++y)
+        {
+            for (UInt32 x = 0; x < side; ++x)
+            {
+                const Vec2 uv = (Vec2{static_cast<float>(x), static_cast<float>(y)} + 0.5f) / static_cast<float>(side) * 2.f - 1.f;
+                rays.push_back({origin, Math::normalize(Vec3{uv.x * 0.5f, uv.y * 0.5f, 1.f})});
+            }
+        }
+
+        return rays;
+    }
+
+    std::vector<Ray> createRandomRays(UInt32 count, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> position{-worldSize * 0.5f, worldSize * 0.5f};
+        std::uniform_real_distribution<float> direction{-1.f, 1.f};
+
+        std::vector<Ray> rays(count);
+        for (Ray& ray : rays)
+        {
+            ray.origin = {position(random), position(random), position(random)};
+            ray.direction = Math::normalize(Vec3{direction(random), direction(random), direction(random)} + Vec3{1e-3f});
+        }
+
+        return rays;
+    }
+
+    void traceScalar(const AabbTree& tree, std::span<const Ray> rays, std::span<Hit> hits)
+    {
+        for (std::size_t i = 0; i < rays.size(); ++i)
+            hits[i] = tree.rayCast(rays[i], TraceChannelFlags::Default);
+    }
+
+    void tracePackets(const AabbTree& tree, std::span<const Ray> rays, std::span<Hit> hits)
+    {
+        static constexpr std::size_t width = AabbUtils::RayPacket::width;
+
+        for (std::size_t offset = 0; offset < rays.size(); offset += width)
+        {
+            const std::size_t count = std::min(width, rays.size() - offset);
+            tree.rayCast(AabbUtils::RayPacket{rays.subspan(offset, count)}, TraceChannelFlags::Default, hits.subspan(offset, count));
+        }
+    }
+
+    // Fastest of the repeats, in milliseconds
+    template<typename Fn>
+    double measure(UInt32 repeats, Fn&& fn)
+    {
+        double best = std::numeric_limits<double>::max();
+        for (UInt32 i = 0; i < repeats; ++i)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    bool run(std::string_view name, const AabbTree& tree, std::span<const Ray> rays, UInt32 repeats)
+    {
+        std::vector<Hit> scalarHits(rays.size());
+        std::vector<Hit> packetHits(rays.size());
+
+        const double scalar = measure(repeats, [&] { traceScalar(tree, rays, scalarHits); });
+        const double packet = measure(repeats, [&] { tracePackets(tree, rays, packetHits); });
+
+        std::size_t hitCount = 0;
+        std::size_t mismatches = 0;
+        for (std::size_t i = 0; i < rays.size(); ++i)
+        {
+            hitCount += scalarHits[i].entity.isValid();
+            mismatches += scalarHits[i].entity != packetHits[i].entity;
+        }
+
+        auto nsPerRay = [&](double ms) { return ms * 1e6 / static_cast<double>(rays.size()); };
+
+        std::cout << std::format("{:<10} {} rays, {} hits: scalar {:.3f} ms ({:.1f} ns/ray), packets {:.3f} ms ({:.1f} ns/ray), {:.2f}x\n",
+                                 name, rays.size(), hitCount, scalar, nsPerRay(scalar), packet, nsPerRay(packet), scalar / packet);
+
+        if (mismatches != 0)
+            std::cerr << std::format("{}: {} rays hit a different entity in the packet path!\n", name, mismatches);
+
+        return mismatches == 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::optional<Options> options = parseOptions({argv, static_cast<std::size_t>(argc)});
+    if (!options)
+    {
+        std::cerr << "Usage: LineTraceBenchmark [--boxes N] [--rays N] [--repeats N]\n";
+        return 1;
+    }
+
+    std::mt19937 random{42};
+    const AabbTree tree = createTree(options->boxes, random);
+
+    std::cout << std::format("{} boxes, tree height {}\n", tree.size(), tree.getHeight());
+
+    const bool coherent = run("Coherent", tree, createCameraRays(options->rays), options->repeats);
+    const bool incoherent = run("Random", tree, createRandomRays(options->rays, random), options->repeats);
+
+    return coherent && incoherent ? 0 : 1;
+}
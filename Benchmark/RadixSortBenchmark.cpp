@@ -0,0 +1,148 @@
+import Core;
+import RadixSort;
+import std;
+
+// Sorts draw keys laid out like the renderer's, together with their draw indices, with RadixSorter and with the
+// comparison sorts it replaced, and compares the time per sort. Every repeat sorts a fresh copy of the same unsorted
+// keys. The radix sort is stable, so it has to produce exactly the order std::stable_sort does.
+//
+// Usage: RadixSortBenchmark [--draws N] [--meshes N] [--textures N] [--repeats N]
+
+namespace
+{
+    struct Options
+    {
+        UInt32 draws{100'000};
+        UInt32 meshes{256};
+        UInt32 textures{64};
+        UInt32 repeats{20}; // The fastest repeat is reported
+    };
+
+    std::optional<Options> parseOptions(std::span<char*> args)
+    {
+        Options options;
+
+        for (std::size_t i = 1; i + 1 < args.size(); i += 2)
+        {
+            const std::string_view arg = args[i];
+            const std::string_view value = args[i + 1];
+
+            UInt32* target = arg == "--draws" ? &options.draws
+                : arg == "--meshes" ? &options.meshes
+                : arg == "--textures" ? &options.textures
+                : arg == "--repeats" ? &options.repeats
+                : nullptr;
+
+            if (!target || std::from_chars(value.data(), value.data() + value.size(), *target).ec != std::errc{} || *target == 0)
+                return std::nullopt;
+        }
+
+        if (args.size() % 2 == 0)
+            return std::nullopt;
+
+        return options;
+    }
+
+    // Opaque world draws: layer (4) | pipeline (4) | mesh (20) | texture (20) | depth (16), as built by the render
+    // object manager. Only the mesh, texture and depth bits vary, so the sorter can skip the passes over the top byte.
+    std::vector<UInt64> createDrawKeys(const Options& options, std::mt19937& random)
+    {
+        std::uniform_int_distribution<UInt64> mesh{0, options.meshes - 1};
+        std::uniform_int_distribution<UInt64> texture{0, options.textures - 1};
+        std::uniform_real_distribution<float> depth{0.1f, 500.f};
+
+        std::vector<UInt64> keys(options.draws);
+        for (UInt64& key : keys)
+        {
+            const UInt64 depthBucket = std::bit_cast<UInt32>(depth(random)) >> 16;
+            key = mesh(random) << 36 | texture(random) << 16 | depthBucket;
+        }
+
+        return keys;
+    }
+
+    // Fastest of the repeats, in milliseconds. Each repeat starts from the unsorted keys, the copy is not timed.
+    template<typename Fn>
+    double measure(UInt32 repeats, std::span<const UInt64> unsorted, std::vector<UInt64>& keys, std::vector<UInt32>& values, Fn&& fn)
+    {
+        double best = std::numeric_limits<double>::max();
+        for (UInt32 i = 0; i < repeats; ++i)
+        {
+            keys.assign(unsorted.begin(), unsorted.end());
+            values.resize(keys.size());
+            std::iota(values.begin(), values.end(), 0u);
+
+            const auto start = std::chrono::steady_clock::now();
+            fn();
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    // Sorts pairs of key and draw index, the way the draw list was sorted before the radix sort
+    template<typename Sort>
+    void sortPairs(std::vector<UInt64>& keys, std::vector<UInt32>& values, std::vector<std::pair<UInt64, UInt32>>& pairs, Sort&& sort)
+    {
+        pairs.clear();
+        for (std::size_t i = 0; i < keys.size(); ++i)
+            pairs.emplace_back(keys[i], values[i]);
+
+        sort(pairs.begin(), pairs.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        for (std::size_t i = 0; i < pairs.size(); ++i)
+        {
+            keys[i] = pairs[i].first;
+            values[i] = pairs[i].second;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::optional<Options> options = parseOptions({argv, static_cast<std::size_t>(argc)});
+    if (!options)
+    {
+        std::cerr << "Usage: RadixSortBenchmark [--draws N] [--meshes N] [--textures N] [--repeats N]\n";
+        return 1;
+    }
+
+    std::mt19937 random{42};
+    const std::vector<UInt64> unsorted = createDrawKeys(*options, random);
+
+    std::vector<UInt64> radixKeys;
+    std::vector<UInt32> radixValues;
+    RadixSorter sorter;
+    const double radix = measure(options->repeats, unsorted, radixKeys, radixValues, [&] { sorter.sort(radixKeys, radixValues); });
+
+    std::vector<std::pair<UInt64, UInt32>> pairs;
+    pairs.reserve(unsorted.size());
+
+    std::vector<UInt64> stableKeys;
+    std::vector<UInt32> stableValues;
+    const double stable = measure(options->repeats, unsorted, stableKeys, stableValues, [&]
+    {
+        sortPairs(stableKeys, stableValues, pairs, [](auto first, auto last, auto less) { std::stable_sort(first, last, less); });
+    });
+
+    std::vector<UInt64> unstableKeys;
+    std::vector<UInt32> unstableValues;
+    const double unstable = measure(options->repeats, unsorted, unstableKeys, unstableValues, [&]
+    {
+        sortPairs(unstableKeys, unstableValues, pairs, [](auto first, auto last, auto less) { std::sort(first, last, less); });
+    });
+
+    auto nsPerDraw = [&](double ms) { return ms * 1e6 / static_cast<double>(unsorted.size()); };
+
+    std::cout << std::format("{} draws, {} meshes, {} textures\n", unsorted.size(), options->meshes, options->textures)
+              << std::format("RadixSorter       {:.3f} ms ({:.1f} ns/draw)\n", radix, nsPerDraw(radix))
+              << std::format("std::stable_sort  {:.3f} ms ({:.1f} ns/draw), {:.2f}x\n", stable, nsPerDraw(stable), stable / radix)
+              << std::format("std::sort         {:.3f} ms ({:.1f} ns/draw), {:.2f}x\n", unstable, nsPerDraw(unstable), unstable / radix);
+
+    if (radixKeys != stableKeys || radixValues != stableValues || radixKeys != unstableKeys)
+    {
+        std::cerr << "RadixSorter disagrees with the comparison sorts!\n";
+        return 1;
+    }
+
+    return 0;
+}
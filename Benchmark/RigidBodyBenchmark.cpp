@@ -0,0 +1,120 @@
+import Components.RigidBody;
+import Components.Transform;
+import Engine;
+import Math;
+import Systems.Physics;
+import Systems.Transform;
+import World;
+import std;
+
+// Updates the physics and transform systems headless, without starting the renderer, and reports how long each update
+// took. An update gathers the bodies, integrates them across the job system for as many fixed physics substeps as fit
+// in the headless time step and writes them back through the change-tracking path. Throughput is counted per substep.
+//
+// Usage: RigidBodyBenchmark [--bodies N] [--updates N]
+
+namespace
+{
+    struct Options
+    {
+        UInt32 bodies{50'000};
+        UInt32 updates{600};
+    };
+
+    std::optional<Options> parseOptions(std::span<char*> args)
+    {
+        Options options;
+
+        for (std::size_t i = 1; i + 1 < args.size(); i += 2)
+        {
+            const std::string_view arg = args[i];
+            const std::string_view value = args[i + 1];
+
+            UInt32* target = arg == "--bodies" ? &options.bodies : arg == "--updates" ? &options.updates : nullptr;
+            if (!target || std::from_chars(value.data(), value.data() + value.size(), *target).ec != std::errc{} || *target == 0)
+                return std::nullopt;
+        }
+
+        if (args.size() % 2 == 0)
+            return std::nullopt;
+
+        return options;
+    }
+
+    // Bodies spread over a cube, thrown in random directions and spinning, a tenth of them kinematic
+    void createBodies(World& world, UInt32 count)
+    {
+        std::mt19937 random{42};
+        std::uniform_real_distribution<float> position{-100.f, 100.f};
+        std::uniform_real_distribution<float> velocity{-5.f, 5.f};
+
+        for (UInt32 i = 0; i < count; ++i)
+        {
+            const Entity entity = world.createEntity();
+
+            world.addComponent<TransformComponent>(entity, TransformComponent
+            {
+                .position = {position(random), position(random), position(random)},
+                .rotation = Quat{1.f, 0.f, 0.f, 0.f},
+            });
+
+            world.addComponent<RigidBodyComponent>(entity, RigidBodyComponent
+            {
+                .velocity = {velocity(random), velocity(random), velocity(random)},
+                .angularVelocity = {velocity(random), velocity(random), velocity(random)},
+                .inverseMass = i % 10 == 0 ? 0.f : 1.f,
+            });
+        }
+    }
+
+    float percentile(std::span<const float> sorted, float fraction)
+    {
+        const auto index = static_cast<std::size_t>(fraction * static_cast<float>(sorted.size() - 1) + 0.5f);
+        return sorted[index];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const std::optional<Options> options = parseOptions({argv, static_cast<std::size_t>(argc)});
+    if (!options)
+    {
+        std::cerr << "Usage: RigidBodyBenchmark [--bodies N] [--updates N]\n";
+        return 1;
+    }
+
+    Engine::addSystem(PhysicsSystem::callbacks);
+    Engine::addSystem(TransformSystem::callbacks);
+    Engine::initHeadless({1, 1});
+
+    const WorldHandle world = Engine::createWorld();
+    createBodies(Engine::getWorld(world), options->bodies);
+
+    // Not timed, the first update also picks up every newly added body
+    Engine::update();
+
+    // Averaged, the accumulator can carry a fraction of a substep from one update to the next
+    const float substepsPerUpdate = Engine::getSimulationDeltaTime() / PhysicsSystem::fixedTimeStep;
+
+    std::vector<float> updateTimes;
+    updateTimes.reserve(options->updates);
+
+    for (UInt32 update = 0; update < options->updates; ++update)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        Engine::update();
+        updateTimes.push_back(std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    Engine::shutdown();
+
+    std::ranges::sort(updateTimes);
+    const float average = std::accumulate(updateTimes.begin(), updateTimes.end(), 0.f) / static_cast<float>(updateTimes.size());
+
+    std::cout << std::format("{} bodies, {} updates of {:.1f} physics substeps\n", options->bodies, updateTimes.size(), substepsPerUpdate)
+              << std::format("Update time (ms): avg {:.3f}  p50 {:.3f}  p95 {:.3f}  max {:.3f}\n",
+                             average, percentile(updateTimes, 0.5f), percentile(updateTimes, 0.95f), updateTimes.back())
+              << std::format("{:.1f} M body substeps per second\n", static_cast<float>(options->bodies) * substepsPerUpdate / average * 1e-3f);
+
+    return 0;
+}
@@ -18,9 +18,11 @@ import Input;
 import Math;
 import Physics;
 import Systems.BoundingBox;
+import Systems.Broadphase;
 import Systems.EntityProxy;
 import Systems.Hierarchy;
 import Systems.RenderSynchronizer;
+import Systems.SpatialHash;
 import Systems.Transform;
 import Thread;
 import World;
@@ -95,6 +97,8 @@ void Editor::init()
     Engine::addSystem(HierarchySystem::callbacks);
     Engine::addSystem(TransformSystem::callbacks);
     Engine::addSystem(BoundingBoxSystem::callbacks);
+    Engine::addSystem(BroadphaseSystem::callbacks);
+    Engine::addSystem(SpatialHashSystem::callbacks);
     Engine::addSystem(RenderSynchronizer::callbacks);
 
     Engine::init();
@@ -114,6 +114,7 @@ void ViewportController::update(float dt, Editor::SnapshotFrame& frame)
 {
     EditorControllerImpl::update(dt, frame);
     m_tools.update();
+    m_selectionGizmos.update();
 
     if (m_viewportId.isValid())
     {
@@ -248,7 +249,7 @@ void Panels::ViewportPanel::drawFpsCounter() const
     static constexpr ImColor color{255,255,255};
     ImVec2 pos = {max.x - 200.0f, min.y + 10.0f};
 
-    const float labelWidth = ImGui::CalcTextSize("Simulation:").x;
+    const float labelWidth = ImGui::CalcTextSize("Descriptors:").x;
 
     auto getFpsString = [](float dt) { return std::format("{:.0f} FPS ({:.1f} ms)", 1 / dt, dt * 1000); };
 
@@ -264,4 +265,47 @@ void Panels::ViewportPanel::drawFpsCounter() const
     smoothedRenderDeltaTime = Math::lerp(smoothedRenderDeltaTime, Engine::getRenderDeltaTime(), t);
     drawList->AddText(pos, color, "Render:");
     drawList->AddText({pos.x + labelWidth + 10.0f, pos.y}, color, getFpsString(smoothedRenderDeltaTime).c_str());
+
+    pos.y += ImGui::GetTextLineHeight();
+
+    drawList->AddText(pos, color, "Descriptors:");
+    drawList->AddText({pos.x + labelWidth + 10.0f, pos.y}, color, std::format("{} writes", Engine::getRenderDescriptorWrites()).c_str());
+
+    pos.y += ImGui::GetTextLineHeight();
+
+    drawList->AddText(pos, color, "Scale:");
+    drawList->AddText({pos.x + labelWidth + 10.0f, pos.y}, color, std::format("{:.0f}%", services().viewports.getRenderScale(m_viewportId) * 100).c_str());
+
+    pos.y += ImGui::GetTextLineHeight();
+
+    const RenderGraphStats& graphStats = Engine::getRenderGraphStats();
+    drawList->AddText(pos, color, "Barriers:");
+    drawList->AddText({pos.x + labelWidth + 10.0f, pos.y}, color, std::format("{} in {} batches", graphStats.barriers, graphStats.barrierBatches).c_str());
+
+    pos.y += ImGui::GetTextLineHeight();
+
+    drawList->AddText(pos, color, "Transient:");
+    drawList->AddText({pos.x + labelWidth + 10.0f, pos.y}, color, std::format("{} / {} KB", graphStats.transientBytes / 1024, graphStats.unaliasedBytes / 1024).c_str());
+
+    pos.y += ImGui::GetTextLineHeight();
+
+    const GpuMemoryStats memoryStats = Engine::getRenderMemoryStats();
+    drawList->AddText(pos, color, "Memory:");
+    drawList->AddText({pos.x + labelWidth + 10.0f, pos.y}, color, std::format("{} allocs, {:.0f}% frag", memoryStats.deviceAllocationCount(), memoryStats.fragmentation() * 100).c_str());
+
+    pos.y += ImGui::GetTextLineHeight();
+
+    UInt64 heapUsage = 0;
+    UInt64 heapBudget = 0;
+    for (const GpuHeapStats& heap : Engine::getRenderHeapStats())
+    {
+        if (!heap.deviceLocal)
+            continue;
+
+        heapUsage += heap.usage;
+        heapBudget += heap.budget;
+    }
+
+    drawList->AddText(pos, color, "VRAM:");
+    drawList->AddText({pos.x + labelWidth + 10.0f, pos.y}, color, std::format("{} / {} MB", heapUsage / (1024 * 1024), heapBudget / (1024 * 1024)).c_str());
 }
@@ -4,7 +4,6 @@ import Components.BoundingBox;
 import Components.EntityProxy;
 import Components.Gizmo;
 import Components.Hierarchy;
-import Components.LineRender;
 import Components.Model;
 import Components.Name;
 import Components.Render;
@@ -206,56 +205,6 @@ std::vector<GizmoHandle> Gizmos::createHandles(World& world, Entity gizmo, Entit
     }
 }
 
-constexpr std::vector<LineVertex> generateAABBVertices(const Vec3& min, const Vec3& max)
-{
-    std::vector<Vec3> vertices =
-    {
-        // Bottom face (4 lines)
-        {min.x, min.y, min.z}, {max.x, min.y, min.z},
-        {max.x, min.y, min.z}, {max.x, max.y, min.z},
-        {max.x, max.y, min.z}, {min.x, max.y, min.z},
-        {min.x, max.y, min.z}, {min.x, min.y, min.z},
-
-        // Top face (4 lines)
-        {min.x, min.y, max.z}, {max.x, min.y, max.z},
-        {max.x, min.y, max.z}, {max.x, max.y, max.z},
-        {max.x, max.y, max.z}, {min.x, max.y, max.z},
-        {min.x, max.y, max.z}, {min.x, min.y, max.z},
-
-        // Vertical lines (4 lines)
-        {min.x, min.y, min.z}, {min.x, min.y, max.z},
-        {max.x, min.y, min.z}, {max.x, min.y, max.z},
-        {max.x, max.y, min.z}, {max.x, max.y, max.z},
-        {min.x, max.y, min.z}, {min.x, max.y, max.z}
-    };
-
-    static constexpr Vec4 color{1.0f, 0.75f, 0.0f, 0.5f};
-    std::vector<LineVertex> lineVertices;
-    std::ranges::transform(vertices, std::back_inserter(lineVertices), [](const Vec3& pos)
-    {
-        return LineVertex{pos, color};
-    });
-    return lineVertices;
-}
-
-Entity Gizmos::createBoundingBoxGizmo(World& editorWorld, const World& sourceEntityWorld, Entity sourceEntity)
-{
-    std::string_view name = NameUtils::getName(sourceEntityWorld, sourceEntity);
-
-    Entity aabbGizmo = editorWorld.createEntity();
-
-    editorWorld.addComponent<NameComponent>(aabbGizmo, std::format("BoundingBoxGizmo_{}", name));
-    editorWorld.addComponent<TagsComponent>(aabbGizmo, {{Tag::editorOnly}});
-
-    editorWorld.addComponent<TransformComponent>(aabbGizmo);
-    editorWorld.addComponent<EntityProxyComponent>(aabbGizmo, {.sourceWorld = sourceEntityWorld.getHandle(), .sourceEntity = sourceEntity});
-
-    const BoundingBoxComponent& aabb = sourceEntityWorld.readComponent<BoundingBoxComponent>(sourceEntity);
-    editorWorld.addComponent<LineRenderComponent>(aabbGizmo, {.vertices = generateAABBVertices(aabb.minLocal, aabb.maxLocal)});
-
-    return aabbGizmo;
-}
-
 void Gizmos::setGizmoVisible(World& world, Entity gizmo, bool visible)
 {
     auto setVisible = [&](Entity entity)
@@ -1,53 +1,35 @@
 module Editor.SelectionGizmo;
-import Editor;
+import Components.BoundingBox;
+import Components.Transform;
 import Engine.WorldManager;
-import Editor.Events;
-import Editor.Gizmos;
-import World.Events;
+import Math;
+import Render.DebugDraw;
+import World;
 
-SelectionGizmoManager::SelectionGizmoManager(EditorServices& services, EditingContext& context)
-    : m_editorWorld{services.worlds.get(context.editorWorld)}
+namespace
 {
-    WorldManager& worldManager = services.worlds;
-
-    m_sub += services.events.subscribe([this, &worldManager, &context](const EditorEvents::SelectionChanged& event)
-    {
-        setSelectedEntities(worldManager.get(context.world), event.selection);
-    });
+    constexpr Vec4 outlineColor{1.0f, 0.75f, 0.0f, 0.5f};
 }
 
-void SelectionGizmoManager::setSelectedEntities(const World& world, std::span<const Entity> entities)
-{
-    std::vector<Entity> toRemove;
-    for (const Entity entity : m_entitiesToBoundingBoxGizmos | std::views::keys)
-    {
-        if (!std::ranges::contains(entities, entity))
-            toRemove.push_back(entity);
-    }
-
-    for (const Entity entity : toRemove)
-        destroyGizmo(m_editorWorld, entity);
-
-    for (const Entity entity : entities)
-    {
-        if (check(!m_entitiesToBoundingBoxGizmos.contains(entity), "Tried to add selection gizmo to an entity more than once!"))
-            m_entitiesToBoundingBoxGizmos.emplace(entity, SelectionGizmo{m_editorWorld, world, entity}).first;
-    }
-}
+SelectionGizmoManager::SelectionGizmoManager(EditorServices& services, EditingContext& context)
+    : m_services{services},
+      m_context{context} {}
 
-void SelectionGizmoManager::destroyGizmo(World& editorWorld, Entity sourceEntity)
+void SelectionGizmoManager::update()
 {
-    if (const auto node = m_entitiesToBoundingBoxGizmos.extract(sourceEntity); !node.empty())
+    const World& world = m_services.worlds.get(m_context.world);
+
+    for (const Entity entity : m_context.selection.get())
     {
-        if (const Entity gizmo = node.mapped().getGizmoEntity(); editorWorld.isValid(gizmo))
-            editorWorld.removeEntity(gizmo);
-    }
-}
+        if (!world.isValid(entity) || !world.hasComponent<BoundingBoxComponent>(entity))
+            continue;
 
-SelectionGizmo::SelectionGizmo(World& editorWorld, const World& sourceEntityWorld, Entity sourceEntity)
-    : m_gizmo{Gizmos::createBoundingBoxGizmo(editorWorld, sourceEntityWorld, sourceEntity)} {}
+        static constexpr Mat4 identity{1};
+        const Mat4& transform = world.hasComponent<RuntimeTransformComponent>(entity)
+            ? world.readComponent<RuntimeTransformComponent>(entity).worldMatrix
+            : identity;
 
-Entity SelectionGizmo::getGizmoEntity() const
-{
-    return m_gizmo;
+        const BoundingBoxComponent& bounds = world.readComponent<BoundingBoxComponent>(entity);
+        DebugDraw::box(m_context.editorWorld, bounds.minLocal, bounds.maxLocal, transform, outlineColor);
+    }
 }
@@ -2,31 +2,17 @@ export module Editor.SelectionGizmo;
 import Core;
 import Editor.EditingContext;
 import Editor.Services;
-import EditorUIContext;
-import EventBus;
-import World;
-
-class SelectionGizmo
-{
-public:
-    SelectionGizmo(World& editorWorld, const World& sourceEntityWorld, Entity sourceEntity);
-    Entity getGizmoEntity() const;
-
-private:
-    Entity m_gizmo;
-};
 
+// Outlines the bounding box of every selected entity. Outlines are debug lines redrawn each frame into the editor
+// world, so they follow their entities without any gizmo entities of their own and any selection costs one draw.
 export class SelectionGizmoManager : NoCopy, NoMove
 {
 public:
     SelectionGizmoManager(EditorServices& services, EditingContext& context);
 
-private:
-    void setSelectedEntities(const World& world, std::span<const Entity> entities);
-
-    void destroyGizmo(World& editorWorld, Entity sourceEntity);
+    void update();
 
-    World& m_editorWorld;
-    std::unordered_map<Entity, SelectionGizmo> m_entitiesToBoundingBoxGizmos;
-    EventSubscription m_sub;
+private:
+    EditorServices& m_services;
+    EditingContext& m_context;
 };
@@ -10,6 +10,7 @@ export struct ModelComponent
     Guid texture{};
     RenderLayer layer{RenderLayer::World};
     Vec4 tint{1};
+    bool occluder{}; // Rasterized on the CPU to cull what it hides. Best kept to a few large, simple meshes.
 };
 
 template<>
@@ -21,6 +22,8 @@ JsonObject serialize(const ModelComponent &component, Json::MemoryPoolAllocator<
     JsonObject json{Json::kObjectType};
     json.AddMember("mesh", JsonObject{component.mesh.toString().data(), allocator}, allocator);
     json.AddMember("texture", JsonObject{component.texture.toString().data(), allocator}, allocator);
+    if (component.occluder)
+        json.AddMember("occluder", true, allocator);
     return json;
 }
 
@@ -38,5 +41,11 @@ ModelComponent deserialize(const JsonObject &serializedData)
         }
     }
 
-    return {.mesh = meshGuid, .texture = textureGuid};
+    bool occluder{};
+    if (const auto it = serializedData.FindMember("occluder"); it != serializedData.MemberEnd())
+    {
+        occluder = it->value.GetBool();
+    }
+
+    return {.mesh = meshGuid, .texture = textureGuid, .occluder = occluder};
 }
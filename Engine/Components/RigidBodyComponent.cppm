@@ -0,0 +1,48 @@
+export module Components.RigidBody;
+import Core;
+import Math;
+import Properties;
+import Serialization.Json;
+
+// Dynamics of an entity, integrated into its local TransformComponent by the physics system.
+// An inverse mass of zero makes the body kinematic: it keeps its velocities but ignores gravity.
+export struct RigidBodyComponent
+{
+    Vec3 velocity{};
+    Vec3 angularVelocity{}; // Radians per second around each axis
+    float inverseMass{1.f};
+};
+
+template<>
+constexpr std::string_view getTypeName<RigidBodyComponent>() { return "RigidBodyComponent"; }
+
+template<>
+struct TypeProperties<RigidBodyComponent>
+{
+    static constexpr std::tuple list{
+        makeProperty("velocity", &RigidBodyComponent::velocity),
+        makeProperty("angularVelocity", &RigidBodyComponent::angularVelocity),
+        makeProperty("inverseMass", &RigidBodyComponent::inverseMass)
+    };
+};
+
+template<>
+JsonObject serialize(const RigidBodyComponent& component, Json::MemoryPoolAllocator<>& allocator)
+{
+    JsonObject json{Json::kObjectType};
+    json.AddMember("velocity", Json::fromVec3(component.velocity, allocator), allocator);
+    json.AddMember("angularVelocity", Json::fromVec3(component.angularVelocity, allocator), allocator);
+    json.AddMember("inverseMass", component.inverseMass, allocator);
+    return json;
+}
+
+template<>
+RigidBodyComponent deserialize(const JsonObject& data)
+{
+    return
+    {
+        .velocity = Json::toVec3(data, "velocity").value_or(Vec3{}),
+        .angularVelocity = Json::toVec3(data, "angularVelocity").value_or(Vec3{}),
+        .inverseMass = Json::toNumber<float>(data, "inverseMass").value_or(1.f)
+    };
+}
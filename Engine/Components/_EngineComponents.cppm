@@ -7,6 +7,7 @@ export import Components.Name;
 export import Components.Hierarchy;
 export import Components.PersistentId;
 export import Components.Render;
+export import Components.RigidBody;
 export import Components.Tags;
 export import Components.Transform;
 export import ComponentRegistry;
@@ -23,6 +24,7 @@ namespace EngineComponents
         ComponentRegistry::init<NameComponent>();
         ComponentRegistry::init<PersistentIdComponent>();
         ComponentRegistry::init<RenderComponent>();
+        ComponentRegistry::init<RigidBodyComponent>();
         ComponentRegistry::init<RuntimeTransformComponent>();
         ComponentRegistry::init<TagsComponent>();
         ComponentRegistry::init<TransformComponent>();
@@ -8,20 +8,28 @@ import Glfw;
 import Guid;
 import Render.Pipeline.Line;
 import Render.Pipeline.Mesh;
+import Render.PipelineCache;
 import Render.QueueFamily;
 import Render.TextureLoading;
 import Render.Utils;
 import Render.Vulkan;
 
 [[nodiscard]]
-vk::PipelineLayout createPipelineLayout(vk::Device device, vk::DescriptorSetLayout descriptorSetLayout)
+vk::PipelineLayout createPipelineLayout(vk::Device device, std::span<const vk::DescriptorSetLayout> descriptorSetLayouts)
 {
+    static constexpr vk::PushConstantRange pushConstantRange
+    {
+        .stageFlags = vk::ShaderStageFlagBits::eVertex,
+        .offset = 0,
+        .size = sizeof(ObjectPushConstants),
+    };
+
     const vk::PipelineLayoutCreateInfo pipelineLayoutInfo
     {
-        .setLayoutCount = 1,
-        .pSetLayouts = &descriptorSetLayout,
-        .pushConstantRangeCount = 0, // Optional
-        .pPushConstantRanges = nullptr, // Optional
+        .setLayoutCount = static_cast<UInt32>(descriptorSetLayouts.size()),
+        .pSetLayouts = descriptorSetLayouts.data(),
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange,
     };
 
     const vk::PipelineLayout pipelineLayout = device.createPipelineLayout(pipelineLayoutInfo, nullptr);
@@ -33,31 +41,12 @@ vk::PipelineLayout createPipelineLayout(vk::Device device, vk::DescriptorSetLayo
 }
 
 [[nodiscard]]
-vk::DescriptorSetLayout createDescriptorSetLayout(vk::Device device)
+vk::DescriptorSetLayout createDescriptorSetLayout(vk::Device device, const vk::DescriptorSetLayoutBinding& binding)
 {
-    static constexpr vk::DescriptorSetLayoutBinding layoutBinding
-    {
-        .binding = 0,
-        .descriptorType = vk::DescriptorType::eUniformBuffer,
-        .descriptorCount = 1,
-        .stageFlags = vk::ShaderStageFlagBits::eVertex,
-        .pImmutableSamplers = nullptr, // Optional
-    };
-
-    static constexpr vk::DescriptorSetLayoutBinding samplerLayoutBinding
+    const vk::DescriptorSetLayoutCreateInfo layoutInfo
     {
-        .binding = 1,
-        .descriptorType = vk::DescriptorType::eCombinedImageSampler,
-        .descriptorCount = 1,
-        .stageFlags = vk::ShaderStageFlagBits::eFragment,
-        .pImmutableSamplers = nullptr, // Optional
-    };
-
-    static constexpr std::array bindings{layoutBinding, samplerLayoutBinding};
-    static constexpr vk::DescriptorSetLayoutCreateInfo layoutInfo
-    {
-        .bindingCount = static_cast<UInt32>(bindings.size()),
-        .pBindings = bindings.data(),
+        .bindingCount = 1,
+        .pBindings = &binding,
     };
 
     const vk::DescriptorSetLayout descriptorSetLayout = device.createDescriptorSetLayout(layoutInfo, nullptr);
@@ -68,20 +57,36 @@ vk::DescriptorSetLayout createDescriptorSetLayout(vk::Device device)
     return descriptorSetLayout;
 }
 
+// Set 0: the view's camera, bound once per render world
+[[nodiscard]]
+vk::DescriptorSetLayout createCameraSetLayout(vk::Device device)
+{
+    static constexpr vk::DescriptorSetLayoutBinding layoutBinding
+    {
+        .binding = 0,
+        .descriptorType = vk::DescriptorType::eUniformBufferDynamic,
+        .descriptorCount = 1,
+        .stageFlags = vk::ShaderStageFlagBits::eVertex,
+        .pImmutableSamplers = nullptr, // Optional
+    };
+    return createDescriptorSetLayout(device, layoutBinding);
+}
+
 [[nodiscard]]
 vk::DescriptorPool createDescriptorPool(vk::Device device)
 {
-    static constexpr UInt32 count = MaxFramesInFlight;
+    // Camera sets are allocated per render world and frame in flight. Textures live in the texture table's own pool.
+    static constexpr UInt32 maxWorlds = 32;
+    static constexpr UInt32 count = maxWorlds * MaxFramesInFlight;
     static constexpr std::array poolSizes
     {
-        vk::DescriptorPoolSize{vk::DescriptorType::eUniformBuffer, count},
-        vk::DescriptorPoolSize{vk::DescriptorType::eCombinedImageSampler, count},
+        vk::DescriptorPoolSize{vk::DescriptorType::eUniformBufferDynamic, count},
     };
 
     static constexpr vk::DescriptorPoolCreateInfo poolInfo
     {
         .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
-        .maxSets = 1000, // TODO: figure this out
+        .maxSets = count,
         .poolSizeCount = static_cast<UInt32>(poolSizes.size()),
         .pPoolSizes = poolSizes.data(),
     };
@@ -90,19 +95,24 @@ vk::DescriptorPool createDescriptorPool(vk::Device device)
 }
 
 RenderManager::RenderManager()
-    : m_renderWorldManager{m_context, {.descriptorPool = m_descriptorPool, .descriptorSetLayout = m_descriptorSetLayout}},
+    : m_renderWorldManager{m_context, {.descriptorPool = m_descriptorPool, .cameraSetLayout = m_cameraSetLayout, .textures = m_textureTable, .uniforms = m_uniformRing, .uploads = m_uploads}},
       m_viewportManager{m_context},
-      m_commandProcessor{{.renderWorldManager = m_renderWorldManager}} {}
+      m_commandProcessor{{.renderWorldManager = m_renderWorldManager}},
+      m_uniformRing{m_context},
+      m_textureTable{m_context},
+      m_commandPools{m_context},
+      m_graph{m_context},
+      m_capture{m_context} {}
 
 RenderManager::~RenderManager() noexcept
 {
-    if (!m_terminated)
+    if (m_initialised && !m_terminated)
     {
         shutdown();
     }
 }
 
-void RenderManager::init(WindowHandle window)
+void RenderManager::init(WindowHandle window, JobSystem& jobs)
 {
     // Init window
     check(!m_initialised, "[RenderManager] Tried to initialise more than once!");
@@ -110,45 +120,9 @@ void RenderManager::init(WindowHandle window)
     check(window.isValid(), "[RenderManager] Can't initialise without a window!");
 
     m_window = window;
+    m_jobs = &jobs;
 
-    // Init Vulkan
-    {
-        vk::detail::defaultDispatchLoaderDynamic.init();
-
-        // Determine what API version is available
-        const UInt32 apiVersion = vk::enumerateInstanceVersion();
-        std::cout << "Loader/Runtime support detected for Vulkan " << vk::apiVersionMajor(apiVersion) << "." <<
-                vk::apiVersionMinor(apiVersion) << "\n";
-
-        createInstance();
-
-        RenderUtils::createDebugUtilsMessenger(m_context.instance, &m_debugMessenger, nullptr);
-        createSurface();
-        pickPhysicalDevice();
-        createLogicalDevice();
-        createSwapchain();
-        m_descriptorPool = createDescriptorPool(m_context.device);
-        m_descriptorSetLayout = createDescriptorSetLayout(m_context.device);
-        m_pipelineLayout = createPipelineLayout(m_context.device, m_descriptorSetLayout);
-
-        constexpr GraphicsPipelineConfig mainPipelineConfig{};
-        m_graphicsPipeline = createGraphicsPipeline(m_context.device, m_pipelineCache, m_pipelineLayout, mainPipelineConfig);
-
-        constexpr GraphicsPipelineConfig gizmoPipelineConfig
-        {
-            .cullMode = vk::CullModeFlagBits::eNone,
-            .depthTest = false,
-            .depthWrite = false,
-            .blending = true
-        };
-        m_gizmoPipeline = createGraphicsPipeline(m_context.device, m_pipelineCache, m_pipelineLayout, gizmoPipelineConfig);
-
-        m_linePipeline = createLinePipeline(m_context.device, m_pipelineCache, m_pipelineLayout);
-
-        createCommandPool();
-        createCommandBuffers();
-        createSyncObjects();
-    }
+    initVulkan();
 
     const ImGuiInitInfo imguiInfo
     {
@@ -178,16 +152,72 @@ void RenderManager::init(WindowHandle window)
     m_initialised = true;
 }
 
+void RenderManager::initHeadless(Size2D size, JobSystem& jobs)
+{
+    check(!m_initialised, "[RenderManager] Tried to initialise more than once!");
+    check(size.width > 0 && size.height > 0, "[RenderManager] Can't render headless to an empty image!", ErrorType::FatalError);
+
+    m_headless = true;
+    m_offscreenExtent = vk::Extent2D{static_cast<UInt32>(size.width), static_cast<UInt32>(size.height)};
+    m_jobs = &jobs;
+
+    initVulkan();
+
+    m_initialised = true;
+}
+
+void RenderManager::initVulkan()
+{
+    vk::detail::defaultDispatchLoaderDynamic.init();
+
+    // Determine what API version is available
+    const UInt32 apiVersion = vk::enumerateInstanceVersion();
+    std::cout << "Loader/Runtime support detected for Vulkan " << vk::apiVersionMajor(apiVersion) << "." <<
+            vk::apiVersionMinor(apiVersion) << "\n";
+
+    createInstance();
+
+    RenderUtils::createDebugUtilsMessenger(m_context.instance, &m_debugMessenger, nullptr);
+    if (!m_headless)
+        createSurface();
+    pickPhysicalDevice();
+    createLogicalDevice();
+    m_allocator.init(m_context.device, m_context.physicalDevice);
+    m_context.allocator = &m_allocator;
+    m_context.deletionQueue = &m_deletionQueue;
+    m_descriptorCache.init(m_context.device);
+    m_context.descriptorCache = &m_descriptorCache;
+    initUploads();
+    createCommandPool(); // The texture table records its default texture with it
+    if (m_headless)
+        createOffscreenTarget();
+    else
+        createSwapchain();
+    m_uniformRing.init();
+    m_descriptorPool = createDescriptorPool(m_context.device);
+    m_cameraSetLayout = createCameraSetLayout(m_context.device);
+    m_textureTable.init();
+    m_pipelineLayout = createPipelineLayout(m_context.device, std::array{m_cameraSetLayout, m_textureTable.getLayout()});
+    m_pipelineCache = PipelineCache::load(m_context.device, m_context.physicalDevice, getPipelineCachePath());
+    createPipelines();
+
+    createCommandBuffers();
+    createSyncObjects();
+}
+
 void RenderManager::update()
 {
     {
         std::lock_guard lock{m_updateLockMutex};
 
-        m_context.graphicsQueue.waitIdle(); // TODO(perf): Explore VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT.
+        beginFrame();
 
-        m_viewportManager.update();
+        m_viewportManager.update(m_currentFrame);
 
         m_commandProcessor.processAll();
+
+        // Everything uploaded while processing goes out in one submission, which this frame's draw waits on
+        m_uploads.submit();
     }
 
     drawFrame();
@@ -202,21 +232,32 @@ void RenderManager::shutdown()
     m_context.device.waitIdle();
 
     m_renderWorldManager.clear();
+    m_uniformRing.shutdown();
+    m_uploads.shutdown();
 
-    m_imguiHelper.shutdown();
+    if (!m_headless)
+        m_imguiHelper.shutdown();
 
     cleanupSwapchain();
+    m_offscreenImage.reset();
+    m_capture.shutdown();
     m_viewportManager.shutdown();
+    m_commandPools.shutdown();
+    m_graph.shutdown();
+    m_deletionQueue.flushAll();
+    m_textureTable.shutdown();
 
     m_context.device.destroyDescriptorPool(m_descriptorPool);
-    m_context.device.destroyDescriptorSetLayout(m_descriptorSetLayout);
+    m_context.device.destroyDescriptorSetLayout(m_cameraSetLayout);
     m_context.device.destroyCommandPool(m_context.commandPool);
-    m_context.device.destroyCommandPool(m_transferCommandPool);
     m_context.device.destroyPipeline(m_graphicsPipeline);
     m_context.device.destroyPipeline(m_gizmoPipeline);
     m_context.device.destroyPipeline(m_linePipeline);
     m_context.device.destroyPipelineLayout(m_pipelineLayout);
 
+    PipelineCache::save(m_context.device, m_context.physicalDevice, m_pipelineCache, getPipelineCachePath());
+    m_context.device.destroyPipelineCache(m_pipelineCache);
+
     for (std::size_t i = 0; i < MaxFramesInFlight; ++i)
     {
         m_context.device.destroySemaphore(m_imageAvailableSemaphores[i]);
@@ -224,6 +265,7 @@ void RenderManager::shutdown()
         m_context.device.destroyFence(m_inFlightFences[i]);
     }
 
+    m_allocator.shutdown();
     m_context.device.destroy();
     m_context.instance.destroySurfaceKHR(m_context.surface);
 
@@ -240,8 +282,11 @@ void RenderManager::clear()
     if (!m_initialised)
         return;
 
+    m_uploads.clear();
     m_context.device.waitIdle();
     m_renderWorldManager.clear();
+    m_deletionQueue.flushAll();
+    m_allocator.releaseEmptyBlocks();
 }
 
 void RenderManager::updateFramebufferSize()
@@ -263,17 +308,22 @@ ViewportId RenderManager::createViewport(std::span<WorldHandle> worlds, Rect are
 
     return m_viewportManager.createViewport({
         .requestedArea = area,
-        .colorFormat = m_swapchain.imageFormat,
+        .colorFormat = m_headless ? offscreenFormat : m_swapchain.imageFormat,
         .renderWorlds = std::move(renderWorlds)
     });
 }
 
-std::vector<const char*> RenderManager::getRequiredExtensions()
+std::vector<const char*> RenderManager::getRequiredExtensions() const
 {
-    UInt32 glfwExtensionCount = 0;
-    const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char*> extensions;
 
-    std::vector extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    // Nothing is presented headless, so no window system extensions are needed, nor is GLFW initialised
+    if (!m_headless)
+    {
+        UInt32 glfwExtensionCount = 0;
+        const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+        extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if constexpr (vk::EnableValidationLayers)
     {
@@ -322,6 +372,14 @@ void RenderManager::createInstance()
     vk::detail::defaultDispatchLoaderDynamic.init(m_context.instance);
 }
 
+std::span<const char* const> RenderManager::getDeviceExtensions() const
+{
+    if (m_headless)
+        return RenderUtils::HeadlessDeviceExtensions;
+
+    return RenderUtils::DeviceExtensions;
+}
+
 void RenderManager::createSurface()
 {
     check(glfw::createWindowSurface(m_context.instance, Platform::Window::getGlfwWindow(m_window), nullptr, &m_context.surface) == vk::Result::eSuccess, "Failed to create window surface!");
@@ -357,8 +415,20 @@ void RenderManager::createLogicalDevice()
         .samplerAnisotropy = vk::True,
     };
 
-    constexpr vk::PhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures
+    // Descriptor indexing backs the texture table, timeline semaphores the uploads
+    vk::PhysicalDeviceVulkan12Features vulkan12Features
     {
+        .descriptorIndexing = vk::True,
+        .shaderSampledImageArrayNonUniformIndexing = vk::True,
+        .descriptorBindingSampledImageUpdateAfterBind = vk::True,
+        .descriptorBindingPartiallyBound = vk::True,
+        .runtimeDescriptorArray = vk::True,
+        .timelineSemaphore = vk::True,
+    };
+
+    const vk::PhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures
+    {
+        .pNext = &vulkan12Features,
         .dynamicRendering = vk::True
     };
 
@@ -378,8 +448,8 @@ void RenderManager::createLogicalDevice()
             if constexpr (vk::EnableValidationLayers) return RenderUtils::ValidationLayers.data();
             else return nullptr;
         }(),
-        .enabledExtensionCount = static_cast<UInt32>(RenderUtils::DeviceExtensions.size()),
-        .ppEnabledExtensionNames = RenderUtils::DeviceExtensions.data(),
+        .enabledExtensionCount = static_cast<UInt32>(getDeviceExtensions().size()),
+        .ppEnabledExtensionNames = getDeviceExtensions().data(),
         .pEnabledFeatures = &deviceFeatures,
     };
 
@@ -391,6 +461,45 @@ void RenderManager::createLogicalDevice()
     m_transferQueue = m_context.device.getQueue(*indices.get(QueueFamilyType::Transfer), 0);
 }
 
+void RenderManager::initUploads()
+{
+    const QueueFamilyIndices indices = QueueFamilyUtils::findQueueFamilies(m_context.physicalDevice, m_context.surface);
+    m_uploads.init(m_context.device, m_allocator, m_transferQueue, *indices.get(QueueFamilyType::Transfer), *indices.get(QueueFamilyType::Graphics));
+}
+
+// Compiled on the workers, the cache is internally synchronised
+void RenderManager::createPipelines()
+{
+    static constexpr GraphicsPipelineConfig mainPipelineConfig{};
+
+    static constexpr GraphicsPipelineConfig gizmoPipelineConfig
+    {
+        .cullMode = vk::CullModeFlagBits::eNone,
+        .depthTest = false,
+        .depthWrite = false,
+        .blending = true
+    };
+
+    const std::array<std::function<void()>, 3> pipelineJobs
+    {
+        [&] { m_graphicsPipeline = createGraphicsPipeline(m_context.device, m_pipelineCache, m_pipelineLayout, mainPipelineConfig); },
+        [&] { m_gizmoPipeline = createGraphicsPipeline(m_context.device, m_pipelineCache, m_pipelineLayout, gizmoPipelineConfig); },
+        [&] { m_linePipeline = createLinePipeline(m_context.device, m_pipelineCache, m_pipelineLayout); },
+    };
+
+    m_jobs->parallelFor(pipelineJobs.size(), 1, [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+            pipelineJobs[i]();
+    });
+}
+
+const std::filesystem::path& RenderManager::getPipelineCachePath()
+{
+    static const std::filesystem::path path = RenderUtils::getExecutableRoot() / "PipelineCache.bin";
+    return path;
+}
+
 void RenderManager::recreateSwapchain()
 {
     int width = 0, height = 0;
@@ -478,6 +587,18 @@ void RenderManager::createSwapchain()
     }
 }
 
+// Stands in for the swapchain headless. Viewports are drawn into it like into a swapchain image.
+void RenderManager::createOffscreenTarget()
+{
+    m_offscreenImage.emplace(m_context, ImageCreateInfo
+    {
+        .extent = m_offscreenExtent,
+        .format = offscreenFormat,
+        .usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eTransferSrc,
+        .aspect = vk::ImageAspectFlagBits::eColor,
+    });
+}
+
 void RenderManager::cleanupSwapchain()
 {
     for (vk::ImageView imageView : m_swapchain.imageViews)
@@ -507,18 +628,7 @@ void RenderManager::createCommandPool()
         fatalError("failed to create command pool!");
     }
 
-    const vk::CommandPoolCreateInfo transferPoolInfo
-    {
-        .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
-        .queueFamilyIndex = *queueFamilyIndices.get(QueueFamilyType::Transfer),
-    };
-
-    m_transferCommandPool = m_context.device.createCommandPool(transferPoolInfo, nullptr);
-
-    if (!m_transferCommandPool)
-    {
-        fatalError("failed to create transfer command pool!");
-    }
+    m_commandPools.init(*queueFamilyIndices.get(QueueFamilyType::Graphics));
 }
 
 void RenderManager::createCommandBuffers()
@@ -571,17 +681,28 @@ void RenderManager::pickPhysicalDevice()
     auto isDeviceSuitable = [&](vk::PhysicalDevice device)
     {
         if (!QueueFamilyUtils::areAllIndicesSet(QueueFamilyUtils::findQueueFamilies(device, m_context.surface))
-            || !RenderUtils::checkDeviceExtensionSupport(device))
+            || !RenderUtils::checkDeviceExtensionSupport(device, getDeviceExtensions()))
             return false;
 
-        const RenderUtils::SwapChainSupportDetails swapChainSupport = RenderUtils::querySwapChainSupport(
-            device, m_context.surface);
-        if (swapChainSupport.formats.empty() || swapChainSupport.presentModes.empty())
-            return false;
+        if (!m_headless)
+        {
+            const RenderUtils::SwapChainSupportDetails swapChainSupport = RenderUtils::querySwapChainSupport(
+                device, m_context.surface);
+            if (swapChainSupport.formats.empty() || swapChainSupport.presentModes.empty())
+                return false;
+        }
 
         if (const vk::PhysicalDeviceFeatures features = device.getFeatures(); !features.samplerAnisotropy)
             return false;
-        return true;
+
+        const auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+        const auto& vulkan12Features = features.get<vk::PhysicalDeviceVulkan12Features>();
+        return vulkan12Features.descriptorIndexing
+            && vulkan12Features.shaderSampledImageArrayNonUniformIndexing
+            && vulkan12Features.descriptorBindingSampledImageUpdateAfterBind
+            && vulkan12Features.descriptorBindingPartiallyBound
+            && vulkan12Features.runtimeDescriptorArray
+            && vulkan12Features.timelineSemaphore;
     };
 
     auto found = std::ranges::find_if(devices, isDeviceSuitable);
@@ -610,8 +731,32 @@ bool RenderManager::checkValidationLayerSupport()
     return std::ranges::all_of(RenderUtils::ValidationLayers, isLayerAvailable);
 }
 
+// Waits for the frame slot about to be recorded rather than for the whole queue, so the CPU records the next frame while
+// the GPU is still executing the previous one. Everything a frame slot owns (command buffer, uniform ring buffer) is
+// reused from here on, and what was retired MaxFramesInFlight frames ago is destroyed.
+void RenderManager::beginFrame()
+{
+    const vk::Fence fence = m_inFlightFences[m_currentFrame];
+    if (m_context.device.waitForFences(1, &fence, vk::False, std::numeric_limits<UInt64>::max()) != vk::Result::eSuccess)
+    {
+        fatalError("failed to wait for fences!");
+    }
+
+    m_deletionQueue.beginFrame(m_currentFrame);
+    m_descriptorCache.beginFrame();
+    m_uniformRing.beginFrame(m_currentFrame);
+    m_commandPools.beginFrame(m_currentFrame);
+    m_capture.beginFrame(m_currentFrame);
+}
+
 void RenderManager::drawFrame()
 {
+    if (m_headless)
+    {
+        drawOffscreenFrame();
+        return;
+    }
+
     //--------------------------------------------------------------------------
     // Build ImGui draw data
     //--------------------------------------------------------------------------
@@ -630,11 +775,6 @@ void RenderManager::drawFrame()
     const vk::Semaphore renderFinishedSemaphore = m_renderFinishedSemaphores[m_currentFrame];
     const vk::CommandBuffer commandBuffer = m_commandBuffers[m_currentFrame];
 
-    if (m_context.device.waitForFences(1, &fence, vk::False, std::numeric_limits<UInt64>::max()) != vk::Result::eSuccess)
-    {
-        fatalError("failed to wait for fences!");
-    }
-
     const auto imageResult = m_context.device.acquireNextImageKHR(m_swapchain.handle, std::numeric_limits<UInt64>::max(), imageAvailableSemaphore, nullptr);
 
     if (imageResult.result == vk::Result::eErrorOutOfDateKHR)
@@ -652,126 +792,85 @@ void RenderManager::drawFrame()
     commandBuffer.reset();
     commandBuffer.begin(vk::CommandBufferBeginInfo{});
 
+    const UInt64 uploadValue = m_uploads.acquire(commandBuffer);
+
     const UInt32 imageIndex = imageResult.value;
 
     //--------------------------------------------------------------------------
-    // Prepare swapchain image
+    // Build and execute the frame's render graph
     //--------------------------------------------------------------------------
-    RenderUtils::transitionImageLayout
+
+    // Acquiring the image is waited on at color attachment output, so the first barrier waits there too
+    ImageState swapchainState{.layout = m_swapchain.layouts[imageIndex], .stages = vk::PipelineStageFlagBits::eColorAttachmentOutput};
+
+    const RenderGraphImage swapchainImage = addScenePasses
     (
         commandBuffer,
-        m_swapchain.images[imageIndex],
-        m_swapchain.layouts[imageIndex],
-        vk::ImageLayout::eTransferDstOptimal,
-        {},
-        vk::AccessFlagBits::eTransferWrite,
-        vk::PipelineStageFlagBits::eTopOfPipe,
-        vk::PipelineStageFlagBits::eTransfer
-    );
-    m_swapchain.layouts[imageIndex] = vk::ImageLayout::eTransferDstOptimal;
-
-    {
-        static constexpr std::array ranges
         {
-            vk::ImageSubresourceRange
-            {
-                .aspectMask = vk::ImageAspectFlagBits::eColor,
-                .baseMipLevel = 0,
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = 1,
-            }
-        };
-
-        static constexpr vk::ClearColorValue clearColor{0.f, 0.f, 0.f, 1.f};
-
-        commandBuffer.clearColorImage(m_swapchain.images[imageIndex], vk::ImageLayout::eTransferDstOptimal, clearColor, ranges);
-    }
-
-    const RenderPassContext renderContext
-    {
-        .commandBuffer = commandBuffer,
-        .pipelines = {.mesh = m_graphicsPipeline, .gizmo = m_gizmoPipeline, .line = m_linePipeline, .layout = m_pipelineLayout},
-        .frameIndex = m_currentFrame,
-        .imageIndex = static_cast<Int32>(imageIndex),
-        .destination = {
             .image = m_swapchain.images[imageIndex],
             .view = m_swapchain.imageViews[imageIndex],
-            .layout = &m_swapchain.layouts[imageIndex],
             .extent = m_swapchain.extent,
             .format = m_swapchain.imageFormat
-        }
-    };
-
-    m_viewportManager.drawViewports(renderContext);
-
-    //--------------------------------------------------------------------------
-    // Render ImGui over the swapchain
-    //--------------------------------------------------------------------------
-    RenderUtils::transitionImageLayout
-    (
-        commandBuffer,
-        m_swapchain.images[imageIndex],
-        m_swapchain.layouts[imageIndex],
-        vk::ImageLayout::eColorAttachmentOptimal,
-        vk::AccessFlagBits::eTransferWrite,
-        vk::AccessFlagBits::eColorAttachmentWrite,
-        vk::PipelineStageFlagBits::eTransfer,
-        vk::PipelineStageFlagBits::eColorAttachmentOutput
+        },
+        swapchainState
     );
-    m_swapchain.layouts[imageIndex] = vk::ImageLayout::eColorAttachmentOptimal;
 
-    const vk::RenderingAttachmentInfo imGuiColorAttachmentInfo
+    // ImGui renders over the swapchain
+    m_graph.addPass("ImGui", {{swapchainImage, ImageUsage::ColorAttachment}}, [&](vk::CommandBuffer cmd, const RenderGraph& graph)
     {
-        .imageView = m_swapchain.imageViews[imageIndex],
-        .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
-        .loadOp = vk::AttachmentLoadOp::eLoad,
-        .storeOp = vk::AttachmentStoreOp::eStore,
-    };
+        const vk::RenderingAttachmentInfo imGuiColorAttachmentInfo
+        {
+            .imageView = graph.getView(swapchainImage),
+            .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+            .loadOp = vk::AttachmentLoadOp::eLoad,
+            .storeOp = vk::AttachmentStoreOp::eStore,
+        };
 
-    const vk::RenderingInfo imGuiRenderingInfo
-    {
-        .renderArea = {{0, 0}, m_swapchain.extent},
-        .layerCount = 1,
-        .colorAttachmentCount = 1,
-        .pColorAttachments = &imGuiColorAttachmentInfo,
-    };
+        const vk::RenderingInfo imGuiRenderingInfo
+        {
+            .renderArea = {{0, 0}, m_swapchain.extent},
+            .layerCount = 1,
+            .colorAttachmentCount = 1,
+            .pColorAttachments = &imGuiColorAttachmentInfo,
+        };
 
-    commandBuffer.beginRendering(imGuiRenderingInfo);
-    m_imguiHelper.renderFrame(commandBuffer);
-    commandBuffer.endRendering();
+        cmd.beginRendering(imGuiRenderingInfo);
+        m_imguiHelper.renderFrame(cmd);
+        cmd.endRendering();
+    });
 
-    //--------------------------------------------------------------------------
-    // Transition to present
-    //--------------------------------------------------------------------------
-    RenderUtils::transitionImageLayout
-    (
-        commandBuffer,
-        m_swapchain.images[imageIndex],
-        m_swapchain.layouts[imageIndex],
-        vk::ImageLayout::ePresentSrcKHR,
-        vk::AccessFlagBits::eColorAttachmentWrite,
-        {},
-        vk::PipelineStageFlagBits::eColorAttachmentOutput,
-        vk::PipelineStageFlagBits::eBottomOfPipe
-    );
-    m_swapchain.layouts[imageIndex] = vk::ImageLayout::ePresentSrcKHR;
+    m_graph.addPass("Present", {{swapchainImage, ImageUsage::Present}});
+
+    m_graph.execute(commandBuffer);
+    m_swapchain.layouts[imageIndex] = swapchainState.layout;
 
     commandBuffer.end();
 
     //--------------------------------------------------------------------------
     // Submit
     //--------------------------------------------------------------------------
-    const vk::Semaphore waitSemaphores[] = { imageAvailableSemaphore };
+    // The upload timeline is only waited on when something was submitted since the last frame. The binary semaphore
+    // ignores its wait value.
+    const vk::Semaphore waitSemaphores[] = { imageAvailableSemaphore, m_uploads.getTimeline() };
+    const UInt64 waitValues[] = { 0, uploadValue };
     const vk::Semaphore signalSemaphores[] = { renderFinishedSemaphore };
     static constexpr vk::PipelineStageFlags waitStages[]
     {
-        vk::PipelineStageFlagBits::eColorAttachmentOutput
+        vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        UploadManager::consumerStages,
+    };
+    const UInt32 waitCount = uploadValue != 0 ? 2 : 1;
+
+    const vk::TimelineSemaphoreSubmitInfo timelineInfo
+    {
+        .waitSemaphoreValueCount = waitCount,
+        .pWaitSemaphoreValues = waitValues,
     };
 
     const vk::SubmitInfo submitInfo
     {
-        .waitSemaphoreCount = 1,
+        .pNext = &timelineInfo,
+        .waitSemaphoreCount = waitCount,
         .pWaitSemaphores = waitSemaphores,
         .pWaitDstStageMask = waitStages,
         .commandBufferCount = 1,
@@ -820,3 +919,110 @@ void RenderManager::drawFrame()
 
     m_currentFrame = (m_currentFrame + 1) % MaxFramesInFlight;
 }
+
+// Starts the frame's graph with the target cleared and every viewport drawn into it
+RenderGraphImage RenderManager::addScenePasses(vk::CommandBuffer commandBuffer, const PresentationImage& target, ImageState& targetState)
+{
+    m_graph.reset();
+
+    const RenderGraphImage targetImage = m_graph.importImage(target.image, target.view, vk::ImageAspectFlagBits::eColor, targetState);
+
+    m_graph.addPass("Clear", {{targetImage, ImageUsage::TransferDst}}, [targetImage](vk::CommandBuffer cmd, const RenderGraph& graph)
+    {
+        static constexpr std::array ranges
+        {
+            vk::ImageSubresourceRange
+            {
+                .aspectMask = vk::ImageAspectFlagBits::eColor,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            }
+        };
+
+        static constexpr vk::ClearColorValue clearColor{0.f, 0.f, 0.f, 1.f};
+
+        cmd.clearColorImage(graph.getImage(targetImage), vk::ImageLayout::eTransferDstOptimal, clearColor, ranges);
+    });
+
+    const RenderPassContext renderContext
+    {
+        .commandBuffer = commandBuffer,
+        .pipelines = {.mesh = m_graphicsPipeline, .gizmo = m_gizmoPipeline, .line = m_linePipeline, .layout = m_pipelineLayout},
+        .frameIndex = static_cast<Int32>(m_currentFrame),
+        .destination = target,
+        .jobs = m_jobs,
+    };
+
+    m_viewportManager.drawViewports(renderContext, m_commandPools, m_graph, targetImage);
+
+    return targetImage;
+}
+
+// Renders into the offscreen target without acquiring or presenting anything, reading the frame back when a capture
+// was requested
+void RenderManager::drawOffscreenFrame()
+{
+    const vk::Fence fence = m_inFlightFences[m_currentFrame];
+    const vk::CommandBuffer commandBuffer = m_commandBuffers[m_currentFrame];
+
+    if (m_context.device.resetFences(1, &fence) != vk::Result::eSuccess)
+        fatalError("failed to reset fences!");
+
+    commandBuffer.reset();
+    commandBuffer.begin(vk::CommandBufferBeginInfo{});
+
+    const UInt64 uploadValue = m_uploads.acquire(commandBuffer);
+
+    const RenderGraphImage target = addScenePasses
+    (
+        commandBuffer,
+        {
+            .image = m_offscreenImage->getImage(),
+            .view = m_offscreenImage->getView(),
+            .extent = m_offscreenExtent,
+            .format = offscreenFormat
+        },
+        m_offscreenState
+    );
+
+    if (m_capture.isRequested())
+    {
+        m_graph.addPass("Capture", {{target, ImageUsage::TransferSrc}}, [this, target](vk::CommandBuffer cmd, const RenderGraph& graph)
+        {
+            m_capture.record(cmd, m_currentFrame, graph.getImage(target), m_offscreenExtent);
+        });
+    }
+
+    m_graph.execute(commandBuffer);
+
+    commandBuffer.end();
+
+    const vk::Semaphore waitSemaphore = m_uploads.getTimeline();
+    static constexpr vk::PipelineStageFlags waitStage = UploadManager::consumerStages;
+    const UInt32 waitCount = uploadValue != 0 ? 1 : 0;
+
+    const vk::TimelineSemaphoreSubmitInfo timelineInfo
+    {
+        .waitSemaphoreValueCount = waitCount,
+        .pWaitSemaphoreValues = &uploadValue,
+    };
+
+    const vk::SubmitInfo submitInfo
+    {
+        .pNext = &timelineInfo,
+        .waitSemaphoreCount = waitCount,
+        .pWaitSemaphores = &waitSemaphore,
+        .pWaitDstStageMask = &waitStage,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer,
+    };
+
+    if (m_context.graphicsQueue.submit(1, &submitInfo, fence) != vk::Result::eSuccess)
+    {
+        fatalError("failed to submit draw command buffer!");
+    }
+
+    m_currentFrame = (m_currentFrame + 1) % MaxFramesInFlight;
+}
@@ -5,12 +5,23 @@ import Engine.Camera;
 import Engine.FrameTimer;
 import Geometry;
 import Guid;
+import Job;
 import Math;
 import Render.CommandProcessor;
+import Render.DeletionQueue;
+import Render.DescriptorCache;
 import Render.EditorCallbacks;
+import Render.FrameCapture;
+import Render.Graph;
+import Render.Image;
 import Render.ImGui;
+import Render.MemoryAllocator;
 import Render.RenderObject;
 import Render.RenderWorld;
+import Render.TextureTable;
+import Render.ThreadCommandPools;
+import Render.UniformRing;
+import Render.UploadManager;
 import Render.Viewport;
 import Render.Vulkan;
 import Render.VulkanResource;
@@ -46,7 +57,11 @@ public:
     ~RenderManager();
 
     bool hasBeenInitialized() const { return m_initialised; }
-    void init(WindowHandle window);
+    void init(WindowHandle window, JobSystem& jobs);
+    // Renders into an offscreen image of the given size instead of a window. Nothing is presented and no editor UI
+    // is drawn, and the windowing platform doesn't have to be initialised.
+    void initHeadless(Size2D size, JobSystem& jobs);
+    bool isHeadless() const { return m_headless; }
     void update();
     void shutdown();
     void clear();
@@ -65,33 +80,59 @@ public:
     ViewportManager& viewports() { return m_viewportManager; }
     const ViewportManager& viewports() const { return m_viewportManager; }
 
-private:
-    class RenderCommandBase;
-    template <typename T>
-    class RenderCommand;
+    // For profiling: allocation counts, fragmentation and heap usage
+    const GpuAllocator& getMemoryAllocator() const { return m_allocator; }
+
+    // Descriptor writes issued during the last frame, zero in steady state
+    UInt32 getDescriptorWrites() const { return m_descriptorCache.getLastFrameWrites(); }
+
+    // Barriers and transient memory of the last frame, per pass
+    const RenderGraphStats& getGraphStats() const { return m_graph.getStats(); }
 
+    // Writes the next frame drawn to a PNG file, once the GPU is done with it. Only captures headless.
+    void captureFrame(std::filesystem::path path) { m_capture.request(std::move(path)); }
+    UInt32 getCapturedFrameCount() const { return m_capture.getWrittenCount(); }
+
+private:
     std::mutex m_updateLockMutex;
     EditorCallbacks m_editorCallbacks;
 
     bool m_initialised{};
+    bool m_headless{};
     RenderWorldManager m_renderWorldManager;
     ViewportManager m_viewportManager;
     RenderCommandProcessor m_commandProcessor;
     WindowHandle m_window{};
+    JobSystem* m_jobs{};
     VulkanContext m_context;
+    GpuAllocator m_allocator;
+    DeletionQueue m_deletionQueue;
+    DescriptorCache m_descriptorCache;
+    UniformRing m_uniformRing;
+    TextureTable m_textureTable;
+    ThreadCommandPools m_commandPools; // Secondary command buffers for the viewports
+    RenderGraph m_graph;
+    UploadManager m_uploads;
     Swapchain m_swapchain;
+
+    // Replaces the swapchain headless
+    static constexpr vk::Format offscreenFormat = vk::Format::eB8G8R8A8Srgb; // What the pipelines render to
+    std::optional<Image> m_offscreenImage;
+    ImageState m_offscreenState;
+    vk::Extent2D m_offscreenExtent{};
+    FrameCapture m_capture;
+
     vk::Queue m_presentQueue{};
     vk::Queue m_transferQueue{};
-    vk::DescriptorSetLayout m_descriptorSetLayout{};
+    vk::DescriptorSetLayout m_cameraSetLayout{};
     vk::PipelineLayout m_pipelineLayout{};
     vk::Pipeline m_graphicsPipeline{};
     vk::Pipeline m_gizmoPipeline{};
     vk::Pipeline m_linePipeline{};
 
-    vk::CommandPool m_transferCommandPool{};
     std::vector<vk::CommandBuffer> m_commandBuffers;
 
-    vk::PipelineCache m_pipelineCache{};
+    vk::PipelineCache m_pipelineCache{}; // Saved to disk on shutdown
     vk::DescriptorPool m_descriptorPool{};
 
     std::vector<vk::Semaphore> m_imageAvailableSemaphores;
@@ -106,20 +147,29 @@ private:
     bool m_terminated{};
     std::atomic<bool> m_framebufferResized{false};
 
-    static std::vector<const char*> getRequiredExtensions();
+    std::vector<const char*> getRequiredExtensions() const;
+    std::span<const char* const> getDeviceExtensions() const;
 
+    void initVulkan();
     void createInstance();
     void createSurface();
     void createLogicalDevice();
+    void createPipelines();
+    static const std::filesystem::path& getPipelineCachePath();
+    void initUploads();
 
     void recreateSwapchain();
     void createSwapchain();
     void cleanupSwapchain();
+    void createOffscreenTarget();
 
     void createCommandPool();
     void createCommandBuffers();
     void createSyncObjects();
     void pickPhysicalDevice();
     [[nodiscard]] static bool checkValidationLayerSupport();
+    void beginFrame();
     void drawFrame();
+    void drawOffscreenFrame();
+    RenderGraphImage addScenePasses(vk::CommandBuffer commandBuffer, const PresentationImage& target, ImageState& targetState);
 };
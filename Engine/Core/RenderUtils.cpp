@@ -1,24 +1,5 @@
 module Render.Utils;
 import Log;
-import Render.QueueFamily;
-
-[[nodiscard]] UInt32 RenderUtils::findMemoryType(vk::PhysicalDevice physicalDevice, UInt32 typeFilter,
-                                                 vk::MemoryPropertyFlags properties)
-{
-    vk::PhysicalDeviceMemoryProperties memProperties = physicalDevice.getMemoryProperties();
-
-    for (UInt32 i = 0; i < memProperties.memoryTypeCount; ++i)
-    {
-        if ((typeFilter & (1 << i))
-            && (memProperties.memoryTypes[i].propertyFlags & properties) == properties)
-        {
-            return i;
-        }
-    }
-
-    fatalError("failed to find suitable memory type!");
-    return 0;
-}
 
 vk::CommandBuffer RenderUtils::beginSingleTimeCommands(vk::Device device, vk::CommandPool commandPool)
 {
@@ -53,10 +34,12 @@ void RenderUtils::endSingleTimeCommands(vk::Device device, vk::CommandBuffer buf
     device.freeCommandBuffers(pool, 1, &buffer);
 }
 
-std::tuple<vk::Buffer, vk::DeviceMemory> RenderUtils::createBuffer(const CreateBufferInfo& info)
+std::tuple<vk::Buffer, GpuAllocation> RenderUtils::createBuffer(const CreateBufferInfo& info)
 {
-    std::tuple<vk::Buffer, vk::DeviceMemory> result;
-    auto& [buffer, memory] = result;
+    check(info.allocator, "[RenderUtils::createBuffer] Missing allocator!", ErrorType::FatalError);
+
+    std::tuple<vk::Buffer, GpuAllocation> result;
+    auto& [buffer, allocation] = result;
 
     const vk::BufferCreateInfo bufferInfo
     {
@@ -77,84 +60,15 @@ std::tuple<vk::Buffer, vk::DeviceMemory> RenderUtils::createBuffer(const CreateB
 
     const vk::MemoryRequirements memRequirements = info.device.getBufferMemoryRequirements(buffer);
 
-    const vk::MemoryAllocateInfo allocInfo
-    {
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = findMemoryType(info.physicalDevice, memRequirements.memoryTypeBits,
-                                          vk::MemoryPropertyFlagBits::eHostVisible |
-                                          vk::MemoryPropertyFlagBits::eHostCoherent),
-    };
-
-    memory = info.device.allocateMemory(allocInfo, nullptr);
-    if (!memory)
-    {
-        fatalError("failed to allocate vertex buffer memory!");
-    }
-
-    info.device.bindBufferMemory(buffer, memory, 0);
+    allocation = info.allocator->allocate(memRequirements, info.properties, ResourceKind::Buffer, info.strategy);
+    info.device.bindBufferMemory(buffer, allocation.memory, allocation.offset);
 
     return result;
 }
 
-std::tuple<vk::Buffer, vk::DeviceMemory> RenderUtils::createDataBuffer(const void* data, vk::DeviceSize size,
-                                                                       const CreateDataBufferInfo& info)
-{
-    auto allFamilyIndices = QueueFamilyUtils::findQueueFamilies(info.physicalDevice, info.surface);
-    const auto familyIndicesToUse = {
-        *allFamilyIndices.get(QueueFamilyType::Graphics), *allFamilyIndices.get(QueueFamilyType::Transfer)
-    };
-
-    const CreateBufferInfo stagingBufferInfo
-    {
-        .device = info.device,
-        .physicalDevice = info.physicalDevice,
-        .size = size,
-        .usage = vk::BufferUsageFlagBits::eTransferSrc,
-        .properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-        .queueFamilyIndices = familyIndicesToUse,
-    };
-
-    auto [stagingBuffer, stagingBufferMemory] = createBuffer(stagingBufferInfo);
-
-    void* mapData = info.device.mapMemory(stagingBufferMemory, 0, size);
-    std::memcpy(mapData, data, size);
-    info.device.unmapMemory(stagingBufferMemory);
-
-    const CreateBufferInfo bufferInfo
-    {
-        .device = info.device,
-        .physicalDevice = info.physicalDevice,
-        .size = size,
-        .usage = vk::BufferUsageFlagBits::eTransferDst | static_cast<vk::BufferUsageFlags>(info.usageType),
-        .properties = vk::MemoryPropertyFlagBits::eDeviceLocal,
-        .queueFamilyIndices = familyIndicesToUse,
-    };
-
-    auto result = createBuffer(bufferInfo);
-
-    copyBuffer(info.device, info.transferCommandPool, info.transferQueue, size, stagingBuffer,
-               std::get<vk::Buffer>(result));
-    info.device.destroyBuffer(stagingBuffer);
-    info.device.freeMemory(stagingBufferMemory);
-
-    return result;
-}
-
-void RenderUtils::copyBuffer(vk::Device device, vk::CommandPool commandPool, vk::Queue queue, vk::DeviceSize size,
-                             vk::Buffer srcBuffer, vk::Buffer dstBuffer)
-{
-    const vk::CommandBuffer commandBuffer = beginSingleTimeCommands(device, commandPool);
-
-    vk::BufferCopy copyRegion{};
-    copyRegion.size = size;
-    commandBuffer.copyBuffer(srcBuffer, dstBuffer, 1, &copyRegion);
-    endSingleTimeCommands(device, commandBuffer, queue, commandPool);
-}
-
-bool RenderUtils::checkDeviceExtensionSupport(vk::PhysicalDevice device)
+bool RenderUtils::checkDeviceExtensionSupport(vk::PhysicalDevice device, std::span<const char* const> extensions)
 {
     const std::vector<vk::ExtensionProperties> availableExtensions = device.enumerateDeviceExtensionProperties(nullptr);
-    const std::set<std::string> requiredExtensions(DeviceExtensions.begin(), DeviceExtensions.end());
 
     auto available = [&](const char* requiredExtName)
     {
@@ -165,7 +79,7 @@ bool RenderUtils::checkDeviceExtensionSupport(vk::PhysicalDevice device)
         return std::ranges::any_of(availableExtensions, matchesRequiredName);
     };
 
-    return std::ranges::all_of(DeviceExtensions, available);
+    return std::ranges::all_of(extensions, available);
 }
 
 namespace RenderUtils
@@ -275,160 +189,17 @@ vk::Extent2D RenderUtils::chooseSwapExtent(const vk::SurfaceCapabilitiesKHR& cap
     return actualExtent;
 }
 
-std::vector<char> RenderUtils::readFile(const std::filesystem::path& path)
-{
-    std::cout << "Reading file at: " << path << std::endl;
-    std::ifstream file{path, std::ios::ate | std::ios::binary};
-    if (!file.is_open())
-    {
-        fatalError("failed to open file!");
-    }
-
-    const int fileSize = static_cast<int>(file.tellg());
-    std::vector<char> buffer(fileSize);
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-    file.close();
-
-    return buffer;
-}
-
-vk::ShaderModule RenderUtils::createShaderModule(const std::vector<char>& code, vk::Device device)
+vk::ShaderModule RenderUtils::createShaderModule(std::span<const UInt32> code, vk::Device device)
 {
     const vk::ShaderModuleCreateInfo createInfo
     {
-        .codeSize = code.size(),
-        .pCode = reinterpret_cast<const UInt32*>(code.data()),
+        .codeSize = code.size_bytes(),
+        .pCode = code.data(),
     };
 
     return device.createShaderModule(createInfo, nullptr);
 }
 
-void RenderUtils::transitionImageLayout(vk::Device device, vk::Queue commandQueue, vk::CommandPool commandPool,
-                                        vk::Image image, vk::Format format, vk::ImageLayout oldLayout,
-                                        vk::ImageLayout newLayout)
-{
-    const vk::CommandBuffer commandBuffer = beginSingleTimeCommands(device, commandPool);
-
-    vk::ImageAspectFlags aspectFlags;
-    if (newLayout == vk::ImageLayout::eDepthStencilAttachmentOptimal) // NOLINT(bugprone-branch-clone)
-    {
-        aspectFlags = vk::ImageAspectFlagBits::eDepth;
-
-        if (RenderUtils::hasStencilComponent(format))
-            aspectFlags |= vk::ImageAspectFlagBits::eStencil;
-    }
-    else
-    {
-        aspectFlags = vk::ImageAspectFlagBits::eColor;
-    }
-
-    const struct Flags
-    {
-        vk::AccessFlags srcAccessMask;
-        vk::AccessFlags dstAccessMask;
-        vk::PipelineStageFlags srcStage;
-        vk::PipelineStageFlags dstStage;
-    } flags = [oldLayout, newLayout]() -> Flags
-        {
-            if (oldLayout == vk::ImageLayout::eUndefined
-                && newLayout == vk::ImageLayout::eTransferDstOptimal)
-                return
-                {
-                    .srcAccessMask = {},
-                    .dstAccessMask = vk::AccessFlagBits::eTransferWrite,
-                    .srcStage = vk::PipelineStageFlagBits::eTopOfPipe,
-                    .dstStage = vk::PipelineStageFlagBits::eTransfer,
-                };
-
-            if (oldLayout == vk::ImageLayout::eTransferDstOptimal
-                && newLayout == vk::ImageLayout::eShaderReadOnlyOptimal)
-                return
-                {
-                    .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
-                    .dstAccessMask = vk::AccessFlagBits::eShaderRead,
-                    .srcStage = vk::PipelineStageFlagBits::eTransfer,
-                    .dstStage = vk::PipelineStageFlagBits::eFragmentShader,
-                };
-
-            if (oldLayout == vk::ImageLayout::eUndefined
-                && newLayout == vk::ImageLayout::eDepthStencilAttachmentOptimal)
-                return
-                {
-                    .srcAccessMask = {},
-                    .dstAccessMask = vk::AccessFlagBits::eDepthStencilAttachmentRead |
-                    vk::AccessFlagBits::eDepthStencilAttachmentWrite,
-                    .srcStage = vk::PipelineStageFlagBits::eTopOfPipe,
-                    .dstStage = vk::PipelineStageFlagBits::eEarlyFragmentTests,
-                };
-
-            fatalError("unsupported layout transition!");
-            return {};
-        }();
-
-    const vk::ImageMemoryBarrier barrier
-    {
-        .srcAccessMask = flags.srcAccessMask,
-        .dstAccessMask = flags.dstAccessMask,
-        .oldLayout = oldLayout,
-        .newLayout = newLayout,
-        .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
-        .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
-        .image = image,
-        .subresourceRange
-        {
-            .aspectMask = aspectFlags,
-            .baseMipLevel = 0,
-            .levelCount = 1,
-            .baseArrayLayer = 0,
-            .layerCount = 1
-        },
-    };
-
-    commandBuffer.pipelineBarrier
-    (
-        flags.srcStage,
-        flags.dstStage,
-        {},
-        0, nullptr,
-        0, nullptr,
-        1, &barrier
-    );
-
-    endSingleTimeCommands(device, commandBuffer, commandQueue, commandPool);
-}
-
-void RenderUtils::copyBufferToImage(vk::Device device, vk::Queue commandQueue, vk::CommandPool commandPool,
-                                    vk::Buffer buffer, vk::Image image,
-                                    vk::Extent2D extent)
-{
-    const vk::CommandBuffer commandBuffer = beginSingleTimeCommands(device, commandPool);
-
-    const vk::BufferImageCopy region
-    {
-        .bufferOffset = 0u,
-        .bufferRowLength = 0u,
-        .bufferImageHeight = 0u,
-        .imageSubresource
-        {
-            .aspectMask = vk::ImageAspectFlagBits::eColor,
-            .mipLevel = 0,
-            .baseArrayLayer = 0,
-            .layerCount = 1,
-        },
-        .imageOffset = {0, 0, 0},
-        .imageExtent
-        {
-            extent.width,
-            extent.height,
-            1
-        },
-    };
-
-    commandBuffer.copyBufferToImage(buffer, image, vk::ImageLayout::eTransferDstOptimal, 1, &region);
-    endSingleTimeCommands(device, commandBuffer, commandQueue, commandPool);
-}
-
 vk::Format RenderUtils::findSupportedFormat(vk::PhysicalDevice physicalDevice,
                                             const std::vector<vk::Format>& candidates, vk::ImageTiling tiling,
                                             vk::FormatFeatureFlags features)
@@ -457,38 +228,3 @@ vk::Format RenderUtils::findDepthFormat(vk::PhysicalDevice physicalDevice)
         vk::FormatFeatureFlagBits::eDepthStencilAttachment
     );
 }
-
-void RenderUtils::transitionImageLayout
-(
-    vk::CommandBuffer cmd,
-    vk::Image image,
-    vk::ImageLayout oldLayout,
-    vk::ImageLayout newLayout,
-    vk::AccessFlags srcAccessMask,
-    vk::AccessFlags dstAccessMask,
-    vk::PipelineStageFlags srcStage,
-    vk::PipelineStageFlags dstStage,
-    vk::ImageAspectFlags aspectMask
-)
-{
-    const vk::ImageMemoryBarrier barrier
-    {
-        .srcAccessMask = srcAccessMask,
-        .dstAccessMask = dstAccessMask,
-        .oldLayout = oldLayout,
-        .newLayout = newLayout,
-        .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
-        .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
-        .image = image,
-        .subresourceRange =
-        {
-            .aspectMask = aspectMask,
-            .baseMipLevel = 0,
-            .levelCount = 1,
-            .baseArrayLayer = 0,
-            .layerCount = 1,
-        }
-    };
-
-    cmd.pipelineBarrier(srcStage, dstStage, {}, nullptr, nullptr, barrier);
-}
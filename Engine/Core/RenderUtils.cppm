@@ -2,6 +2,7 @@ export module Render.Utils;
 import Core;
 import Glfw;
 import FileSystem;
+export import Render.MemoryAllocator;
 import Render.Vulkan;
 
 export namespace RenderUtils
@@ -17,7 +18,11 @@ export namespace RenderUtils
         vk::KHRDynamicRenderingExtensionName
     });
 
-    UInt32 findMemoryType(vk::PhysicalDevice physicalDevice, UInt32 typeFilter, vk::MemoryPropertyFlags properties);
+    // Nothing is presented without a window
+    constexpr auto HeadlessDeviceExtensions = std::to_array
+    ({
+        vk::KHRDynamicRenderingExtensionName
+    });
 
     vk::CommandBuffer beginSingleTimeCommands(vk::Device device, vk::CommandPool commandPool);
     void endSingleTimeCommands(vk::Device device, vk::CommandBuffer buffer, vk::Queue queue, vk::CommandPool pool);
@@ -25,48 +30,26 @@ export namespace RenderUtils
     struct CreateBufferInfo
     {
         vk::Device device{};
-        vk::PhysicalDevice physicalDevice{};
+        GpuAllocator* allocator{};
         vk::DeviceSize size{};
         vk::BufferUsageFlags usage{};
         vk::MemoryPropertyFlags properties{};
+        AllocationStrategy strategy{AllocationStrategy::Buddy};
         std::initializer_list<UInt32> queueFamilyIndices;
     };
 
-    [[nodiscard]] std::tuple<vk::Buffer, vk::DeviceMemory> createBuffer(const CreateBufferInfo& info);
-
-    struct CreateDataBufferInfo
-    {
-        vk::Device device{};
-        vk::PhysicalDevice physicalDevice{};
-        vk::SurfaceKHR surface{};
-        vk::BufferUsageFlagBits usageType{};
-        vk::Queue transferQueue{};
-        vk::CommandPool transferCommandPool{};
-    };
+    [[nodiscard]] std::tuple<vk::Buffer, GpuAllocation> createBuffer(const CreateBufferInfo& info);
 
     template <typename T>
     concept BufferableData = requires { typename T::value_type; }
         && requires(const T& t) { { t.data() } -> std::convertible_to<const void*>; }
         && requires(const T& t) { { t.size() } -> std::integral; };
 
+    // The buffer's memory must be host visible
     template <BufferableData T>
-    std::tuple<vk::Buffer, vk::DeviceMemory> createDataBuffer(const T& range, const CreateDataBufferInfo& info);
-    std::tuple<vk::Buffer, vk::DeviceMemory> createDataBuffer(const void* data, vk::DeviceSize size, const CreateDataBufferInfo& info);
-
-    template <BufferableData T>
-    void updateBuffer(const T& range, vk::Device device, vk::DeviceMemory bufferMemory);
-    
-    void copyBuffer(vk::Device device, vk::CommandPool commandPool, vk::Queue queue, vk::DeviceSize size, vk::Buffer srcBuffer, vk::Buffer dstBuffer);
-
-    [[nodiscard]] UInt32 findMemoryType(vk::PhysicalDevice physicalDevice, UInt32 typeFilter, vk::MemoryPropertyFlags properties);
-
-    template <BufferableData T>
-    [[nodiscard]] std::tuple<vk::Buffer, vk::DeviceMemory> createDataBuffer(const T& range, const CreateDataBufferInfo& info)
-    {
-        return createDataBuffer(range.data(), sizeof(typename std::remove_reference_t<decltype(range)>::value_type) * range.size(), info);
-    }
+    void updateBuffer(const T& range, const GpuAllocation& allocation);
 
-    bool checkDeviceExtensionSupport(vk::PhysicalDevice device);
+    bool checkDeviceExtensionSupport(vk::PhysicalDevice device, std::span<const char* const> extensions);
 
     [[nodiscard]] vk::DebugUtilsMessengerCreateInfoEXT newDebugUtilsMessengerCreateInfo();
 
@@ -88,31 +71,12 @@ export namespace RenderUtils
     vk::PresentModeKHR chooseSwapPresentMode(const std::vector<vk::PresentModeKHR>& availablePresentModes);
     vk::Extent2D chooseSwapExtent(const vk::SurfaceCapabilitiesKHR& capabilities, GLFWwindow* window);
 
-    std::vector<char> readFile(const std::filesystem::path& path);
-    vk::ShaderModule createShaderModule(const std::vector<char>& code, vk::Device device);
-
-    void transitionImageLayout(vk::Device device, vk::Queue commandQueue, vk::CommandPool commandPool, vk::Image image, vk::Format format, vk::ImageLayout oldLayout,
-                               vk::ImageLayout newLayout);
-
-    void copyBufferToImage(vk::Device device, vk::Queue commandQueue, vk::CommandPool commandPool, vk::Buffer buffer, vk::Image image, vk::Extent2D extent);
+    vk::ShaderModule createShaderModule(std::span<const UInt32> code, vk::Device device);
 
     vk::Format findSupportedFormat(vk::PhysicalDevice physicalDevice, const std::vector<vk::Format>& candidates, vk::ImageTiling tiling, vk::FormatFeatureFlags features);
 
     vk::Format findDepthFormat(vk::PhysicalDevice physicalDevice);
 
-    void transitionImageLayout
-    (
-        vk::CommandBuffer cmd,
-        vk::Image image,
-        vk::ImageLayout oldLayout,
-        vk::ImageLayout newLayout,
-        vk::AccessFlags srcAccessMask,
-        vk::AccessFlags dstAccessMask,
-        vk::PipelineStageFlags srcStage,
-        vk::PipelineStageFlags dstStage,
-        vk::ImageAspectFlags aspectMask = vk::ImageAspectFlagBits::eColor
-    );
-    
     constexpr bool hasStencilComponent(vk::Format format)
     {
         return format == vk::Format::eD32SfloatS8Uint || format == vk::Format::eD24UnormS8Uint;
@@ -126,11 +90,9 @@ export namespace RenderUtils
 }
 
 template <RenderUtils::BufferableData T>
-void RenderUtils::updateBuffer(const T& range, vk::Device device, vk::DeviceMemory bufferMemory)
+void RenderUtils::updateBuffer(const T& range, const GpuAllocation& allocation)
 {
-    void* data;
     const std::size_t bufferSize = sizeof(typename std::remove_reference_t<decltype(range)>::value_type) * range.size();
-    if (device.mapMemory(bufferMemory, 0, bufferSize, {}, &data) == vk::Result::eSuccess)
-        std::memcpy(data, range.data(), bufferSize);        
-    device.unmapMemory(bufferMemory);
+    if (check(allocation.mapped && bufferSize <= allocation.size, "[RenderUtils::updateBuffer] Buffer isn't host visible or is too small!"))
+        std::memcpy(allocation.mapped, range.data(), bufferSize);
 }
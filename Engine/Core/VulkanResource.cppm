@@ -1,6 +1,10 @@
 export module Render.VulkanResource;
 export import Core;
 export import Render.Vulkan;
+import Job;
+import Render.DeletionQueue;
+import Render.DescriptorCache;
+import Render.MemoryAllocator;
 
 export struct RenderPipelineSet
 {
@@ -14,7 +18,6 @@ export struct PresentationImage
 {
     vk::Image image{};
     vk::ImageView view{};
-    vk::ImageLayout* layout{};
     vk::Extent2D extent{};
     vk::Format format{};
 };
@@ -24,8 +27,8 @@ export struct RenderPassContext
     vk::CommandBuffer commandBuffer{};
     const RenderPipelineSet& pipelines;
     Int32 frameIndex{};
-    Int32 imageIndex{};
     PresentationImage destination;
+    JobSystem* jobs{};
 };
 
 export struct VulkanContext
@@ -36,6 +39,9 @@ export struct VulkanContext
     vk::CommandPool commandPool{};
     vk::Queue graphicsQueue{};
     vk::SurfaceKHR surface{};
+    GpuAllocator* allocator{};
+    DeletionQueue* deletionQueue{};
+    DescriptorCache* descriptorCache{};
 };
 
 export class VulkanResource
@@ -0,0 +1,59 @@
+module RadixSort;
+
+void RadixSorter::sort(std::span<UInt64> keys, std::span<UInt32> values)
+{
+    check(keys.size() == values.size(), "[RadixSorter] Every key needs a value!", ErrorType::FatalError);
+
+    const std::size_t count = keys.size();
+    if (count < 2)
+        return;
+
+    static constexpr std::size_t passCount = sizeof(UInt64);
+    static constexpr std::size_t bucketCount = 256;
+
+    // All histograms are built in a single read of the keys
+    std::array<std::array<UInt32, bucketCount>, passCount> histograms{};
+    for (const UInt64 key : keys)
+    {
+        for (std::size_t pass = 0; pass < passCount; ++pass)
+            histograms[pass][(key >> (pass * 8)) & 0xFF]++;
+    }
+
+    m_keyScratch.resize(count);
+    m_valueScratch.resize(count);
+
+    std::span<UInt64> sourceKeys = keys;
+    std::span<UInt32> sourceValues = values;
+    std::span<UInt64> destinationKeys = m_keyScratch;
+    std::span<UInt32> destinationValues = m_valueScratch;
+
+    for (std::size_t pass = 0; pass < passCount; ++pass)
+    {
+        std::array<UInt32, bucketCount>& histogram = histograms[pass];
+        const std::size_t shift = pass * 8;
+
+        if (histogram[(sourceKeys[0] >> shift) & 0xFF] == count)
+            continue;
+
+        // Turn the counts into the first output index of each bucket
+        UInt32 offset = 0;
+        for (UInt32& bucket : histogram)
+            offset += std::exchange(bucket, offset);
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const UInt32 index = histogram[(sourceKeys[i] >> shift) & 0xFF]++;
+            destinationKeys[index] = sourceKeys[i];
+            destinationValues[index] = sourceValues[i];
+        }
+
+        std::swap(sourceKeys, destinationKeys);
+        std::swap(sourceValues, destinationValues);
+    }
+
+    if (sourceKeys.data() != keys.data())
+    {
+        std::ranges::copy(sourceKeys, keys.begin());
+        std::ranges::copy(sourceValues, values.begin());
+    }
+}
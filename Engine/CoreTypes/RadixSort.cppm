@@ -0,0 +1,15 @@
+export module RadixSort;
+import Core;
+
+// Stable LSD radix sort of 64-bit keys, carrying a 32-bit value along with each key. Sorts one byte per pass and skips
+// the passes where every key has the same byte, so keys that only use their upper bits cost as many passes as they
+// have varying bytes. The scratch buffers are resized as needed and can be reused between calls to avoid allocating.
+export class RadixSorter
+{
+public:
+    void sort(std::span<UInt64> keys, std::span<UInt32> values);
+
+private:
+    std::vector<UInt64> m_keyScratch;
+    std::vector<UInt32> m_valueScratch;
+};
@@ -0,0 +1,94 @@
+export module SparseSet;
+import Core;
+
+// Maps entities to values kept packed in a dense array. Lookups index a sparse array by entity value and erasing moves
+// the last value into the hole, so every operation is O(1) and iterating only touches live values. Erasing changes the
+// order of the remaining values.
+export template<typename T>
+class SparseSet
+{
+public:
+    [[nodiscard]] bool contains(Entity entity) const { return getIndex(entity) != nullIndex; }
+
+    [[nodiscard]] T* find(Entity entity)
+    {
+        const UInt32 index = getIndex(entity);
+        return index != nullIndex ? &m_values[index] : nullptr;
+    }
+
+    [[nodiscard]] const T* find(Entity entity) const
+    {
+        const UInt32 index = getIndex(entity);
+        return index != nullIndex ? &m_values[index] : nullptr;
+    }
+
+    // Replaces the value if the entity already has one.
+    T& insert(Entity entity, T value)
+    {
+        if (T* existing = find(entity))
+            return *existing = std::move(value);
+
+        if (entity.value >= m_sparse.size())
+            m_sparse.resize(entity.value + 1, nullIndex);
+
+        m_sparse[entity.value] = static_cast<UInt32>(m_values.size());
+        m_entities.push_back(entity);
+        return m_values.emplace_back(std::move(value));
+    }
+
+    // Moves the entity's value out of the set, if it has one.
+    std::optional<T> extract(Entity entity)
+    {
+        const UInt32 index = getIndex(entity);
+        if (index == nullIndex)
+            return std::nullopt;
+
+        std::optional<T> value{std::move(m_values[index])};
+
+        if (index != m_values.size() - 1)
+        {
+            m_values[index] = std::move(m_values.back());
+            m_entities[index] = m_entities.back();
+            m_sparse[m_entities[index].value] = index;
+        }
+
+        m_values.pop_back();
+        m_entities.pop_back();
+        m_sparse[entity.value] = nullIndex;
+
+        return value;
+    }
+
+    bool erase(Entity entity) { return extract(entity).has_value(); }
+
+    void clear()
+    {
+        m_values.clear();
+        m_entities.clear();
+        m_sparse.clear();
+    }
+
+    [[nodiscard]] std::size_t size() const { return m_values.size(); }
+    [[nodiscard]] bool empty() const { return m_values.empty(); }
+
+    [[nodiscard]] std::span<T> values() { return m_values; }
+    [[nodiscard]] std::span<const T> values() const { return m_values; }
+    [[nodiscard]] std::span<const Entity> entities() const { return m_entities; }
+
+    auto begin() { return m_values.begin(); }
+    auto end() { return m_values.end(); }
+    auto begin() const { return m_values.begin(); }
+    auto end() const { return m_values.end(); }
+
+private:
+    static constexpr UInt32 nullIndex = std::numeric_limits<UInt32>::max();
+
+    [[nodiscard]] UInt32 getIndex(Entity entity) const
+    {
+        return entity && entity.value < m_sparse.size() ? m_sparse[entity.value] : nullIndex;
+    }
+
+    std::vector<T> m_values;
+    std::vector<Entity> m_entities; // Parallel to m_values
+    std::vector<UInt32> m_sparse;   // Indexed by entity value
+};
@@ -0,0 +1,76 @@
+module SpscByteRing;
+
+SpscByteRing::SpscByteRing(std::size_t blockSize)
+    : m_blockSize{align(blockSize)}
+{
+    static_assert(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__, "Block storage must be aligned for any record");
+
+    Block& block = createBlock();
+    block.next = &block;
+
+    m_writeBlock = &block;
+    m_readBlock.store(&block, std::memory_order_relaxed);
+}
+
+std::byte* SpscByteRing::allocate(std::size_t size, UInt32 tag)
+{
+    const std::size_t recordSize = align(sizeof(RecordHeader) + size);
+    check(recordSize <= m_blockSize, "Record doesn't fit in a ring block", ErrorType::FatalError);
+
+    if (m_writeOffset + recordSize > m_blockSize)
+        advanceWriteBlock();
+
+    std::byte* record = m_writeBlock->data.get() + m_writeOffset;
+    new (record) RecordHeader{.size = static_cast<UInt32>(recordSize), .tag = tag};
+    m_writeOffset += recordSize;
+
+    return record + sizeof(RecordHeader);
+}
+
+void SpscByteRing::publish()
+{
+    // Blocks left behind since the last publish are complete: their final size goes out before the sealed flag
+    for (Block* block : m_unsealedBlocks)
+    {
+        block->published.store(block->size, std::memory_order_release);
+        block->sealed.store(true, std::memory_order_release);
+    }
+    m_unsealedBlocks.clear();
+
+    m_writeBlock->published.store(m_writeOffset, std::memory_order_release);
+}
+
+SpscByteRing::Block& SpscByteRing::createBlock()
+{
+    auto block = std::make_unique<Block>();
+    block->data = std::make_unique_for_overwrite<std::byte[]>(m_blockSize);
+    return *m_blocks.emplace_back(std::move(block));
+}
+
+// The consumer only follows next out of a block once it is sealed, which happens at the following publish, so relinking
+// and resetting here is never observed half done.
+void SpscByteRing::advanceWriteBlock()
+{
+    Block* current = m_writeBlock;
+    Block* next = current->next;
+
+    // The next block is free unless the consumer is still in it
+    if (next == m_readBlock.load(std::memory_order_acquire))
+    {
+        Block& inserted = createBlock();
+        inserted.next = next;
+        current->next = &inserted;
+        next = &inserted;
+    }
+    else
+    {
+        next->published.store(0, std::memory_order_relaxed);
+        next->sealed.store(false, std::memory_order_relaxed);
+    }
+
+    current->size = m_writeOffset;
+    m_unsealedBlocks.push_back(current);
+
+    m_writeBlock = next;
+    m_writeOffset = 0;
+}
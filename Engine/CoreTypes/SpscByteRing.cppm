@@ -0,0 +1,89 @@
+export module SpscByteRing;
+import Core;
+
+// Single-producer/single-consumer ring of variable-sized records, each tagged with a small user value.
+// The producer allocates records in place and makes them visible to the consumer in batches with publish(); the consumer
+// walks published records linearly. Storage is a circular chain of fixed-size blocks: when the block after the producer
+// is still being read, a new one is linked in instead of waiting, so the producer never blocks and memory grows to the
+// largest backlog seen, after which nothing is allocated.
+export class SpscByteRing
+{
+public:
+    static constexpr std::size_t alignment = 16;
+    static constexpr std::size_t defaultBlockSize = 256 * 1024;
+
+    explicit SpscByteRing(std::size_t blockSize = defaultBlockSize);
+    SpscByteRing(const SpscByteRing&) = delete;
+    SpscByteRing& operator=(const SpscByteRing&) = delete;
+
+    // Producer: returns storage for a record of size bytes, aligned to alignment. It stays valid until consumed.
+    [[nodiscard]] std::byte* allocate(std::size_t size, UInt32 tag);
+
+    // Producer: makes every record allocated so far visible to the consumer.
+    void publish();
+
+    // Consumer: calls fn(tag, data) for every published record, in order. Records are released once fn returns.
+    template<typename Fn>
+    void consume(Fn&& fn);
+
+private:
+    struct alignas(alignment) RecordHeader
+    {
+        UInt32 size{}; // Including the header
+        UInt32 tag{};
+    };
+
+    struct Block
+    {
+        std::unique_ptr<std::byte[]> data;
+        Block* next{};
+        std::size_t size{}; // Producer only, the end of the records once the producer moved on
+        std::atomic<std::size_t> published{}; // End of the records the consumer may read
+        std::atomic<bool> sealed{};           // Set once the producer has moved past the block and published
+    };
+
+    static constexpr std::size_t align(std::size_t size) { return (size + alignment - 1) & ~(alignment - 1); }
+
+    Block& createBlock();
+    void advanceWriteBlock();
+
+    std::size_t m_blockSize{};
+    std::vector<std::unique_ptr<Block>> m_blocks; // Owned by the producer, the consumer only follows Block::next
+
+    // Producer state
+    Block* m_writeBlock{};
+    std::size_t m_writeOffset{};
+    std::vector<Block*> m_unsealedBlocks; // Filled since the last publish
+
+    // Consumer state
+    std::atomic<Block*> m_readBlock{};
+    std::size_t m_readOffset{};
+};
+
+template<typename Fn>
+void SpscByteRing::consume(Fn&& fn)
+{
+    Block* block = m_readBlock.load(std::memory_order_relaxed);
+
+    while (true)
+    {
+        // Reading sealed first guarantees published is final when it is set
+        const bool sealed = block->sealed.load(std::memory_order_acquire);
+        const std::size_t end = block->published.load(std::memory_order_acquire);
+
+        while (m_readOffset < end)
+        {
+            std::byte* record = block->data.get() + m_readOffset;
+            const RecordHeader header = *std::launder(reinterpret_cast<RecordHeader*>(record));
+            fn(header.tag, record + sizeof(RecordHeader));
+            m_readOffset += header.size;
+        }
+
+        if (!sealed)
+            return;
+
+        block = block->next;
+        m_readOffset = 0;
+        m_readBlock.store(block, std::memory_order_release); // Hands the previous block back to the producer
+    }
+}
@@ -3,6 +3,7 @@ export import World;
 import AssetManager;
 import Core;
 import Engine.WorldManager;
+import Job;
 import Render.CommandProcessor;
 import Render.Viewport;
 import Thread;
@@ -13,6 +14,7 @@ export struct SystemContext
     ViewportManager& viewports;
     AssetManager& assets;
     RenderCommandQueue& renderCommands;
+    JobSystem& jobs;
 };
 
 export struct SystemCallbacks
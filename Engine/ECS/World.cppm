@@ -164,6 +164,12 @@ public:
     template<typename Tag>
     void mark(Entity entity) { m_dirtyTracker.markDirty<Tag>(entity); }
 
+    template<typename T>
+    T& editResource();
+
+    template<typename T> [[nodiscard]]
+    const T* readResource() const;
+
     auto archetypes() { return m_archetypes | std::views::values; }
     auto archetypes() const { return m_archetypes | std::views::values; }
     void printArchetypeStatus();
@@ -189,6 +195,8 @@ private:
 
     DirtyTrackerManager m_dirtyTracker;
 
+    std::unordered_map<TypeId, std::shared_ptr<void>> m_resources;
+
     EventBus m_eventBus;
 };
 
@@ -313,6 +321,23 @@ EventBus::Subscription World::subscribe(Func&& callback)
     return m_eventBus.subscribe(std::forward<Func>(callback));
 }
 
+template<typename T>
+T& World::editResource()
+{
+    assertThread();
+    std::shared_ptr<void>& resource = m_resources[getTypeId<T>()];
+    if (!resource)
+        resource = std::make_shared<T>();
+    return *static_cast<T*>(resource.get());
+}
+
+template<typename T>
+const T* World::readResource() const
+{
+    auto it = m_resources.find(getTypeId<T>());
+    return it != m_resources.end() ? static_cast<const T*>(it->second.get()) : nullptr;
+}
+
 template <ValidComponentData T>
 const T& World::getComponent(Entity entity) const
 {
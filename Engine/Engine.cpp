@@ -4,26 +4,32 @@ import AssetManager;
 import Engine.Config;
 import Engine.FrameTimer;
 import Input;
+import Job;
 import Platform;
+import Render.DebugDraw;
 import Render.RenderManager;
 import Thread;
 
 namespace
 {
     bool initialized = false;
+    bool headless = false;
+    Size2D headlessSize;
     bool shutdownRequested = false;
     std::atomic engineShuttingDown = false;
     std::thread renderThread;
     WindowHandle window;
     ThreadOwned threadChecker;
     FrameTimer frameTimer;
+    float simulationDeltaTime{};
     Engine::Config config;
     UInt64 currentFrame{};
     RenderManager renderManager;
     WorldManager worldManager;
     SceneManager sceneManager{worldManager};
     AssetManager assetManager;
-    SystemManager systemManager{{.worlds = worldManager, .viewports = renderManager.viewports(), .assets = assetManager, .renderCommands = renderManager.getCommandQueue()}};
+    JobSystem jobSystem;
+    SystemManager systemManager{{.worlds = worldManager, .viewports = renderManager.viewports(), .assets = assetManager, .renderCommands = renderManager.getCommandQueue(), .jobs = jobSystem}};
 }
 
 namespace Engine
@@ -33,7 +39,7 @@ namespace Engine
 
 void Engine::runRenderThread()
 {
-    renderManager.init(window);
+    renderManager.init(window, jobSystem);
 
     while (!engineShuttingDown.load())
     {
@@ -65,13 +71,48 @@ void Engine::init()
     AssetManager::registerLoader<MeshData>(std::make_unique<MeshAssetLoader>());
     AssetManager::registerLoader<TextureData>(std::make_unique<TextureAssetLoader>());
 
+    // Leave a core each for the main and render threads
+    jobSystem.start(std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 2));
+
     systemManager.init();
     initialized = true;
 }
 
+void Engine::initHeadless(Size2D size)
+{
+    threadChecker.assertThread();
+
+    config = loadConfig();
+
+    EngineComponents::init();
+
+    AssetManager::registerLoader<MeshData>(std::make_unique<MeshAssetLoader>());
+    AssetManager::registerLoader<TextureData>(std::make_unique<TextureAssetLoader>());
+
+    // Rendering happens on the main thread, leave a core for it
+    jobSystem.start(std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1));
+
+    systemManager.init();
+    headless = true;
+    headlessSize = size;
+    initialized = true;
+}
+
+bool Engine::isHeadless()
+{
+    return headless;
+}
+
 void Engine::start()
 {
     threadChecker.assertThread();
+
+    if (headless)
+    {
+        renderManager.initHeadless(headlessSize, jobSystem);
+        return;
+    }
+
     renderThread = std::thread{runRenderThread};
 }
 
@@ -79,18 +120,33 @@ bool Engine::update()
 {
     threadChecker.assertThread();
 
-    const float deltaTime = frameTimer.tick(config.simulationHz);
+    // Headless runs as fast as it renders, stepping the simulation by a fixed amount
+    const float frameTime = frameTimer.tick(headless ? 0.f : config.simulationHz);
+    const float deltaTime = headless ? 1.f / config.simulationHz : frameTime;
+    simulationDeltaTime = deltaTime;
 
-    if (shutdownRequested || Platform::Window::isWindowClosing(window))
+    if (shutdownRequested || (!headless && Platform::Window::isWindowClosing(window)))
     {
         shutdown();
         return false;
     }
 
     systemManager.update(deltaTime);
+    DebugDraw::flush(renderManager.getCommandQueue());
+    renderManager.getCommandQueue().publish();
 
-    Input::postUpdate(window);
-    Platform::update();
+    if (headless)
+    {
+        // Renders what was just published, so every frame shows the simulation step before it. Until start brings up
+        // the renderer, only the simulation runs.
+        if (renderManager.hasBeenInitialized())
+            renderManager.update();
+    }
+    else
+    {
+        Input::postUpdate(window);
+        Platform::update();
+    }
 
     worldManager.nextFrame();
     ++currentFrame;
@@ -100,7 +156,7 @@ bool Engine::update()
 
 float Engine::getSimulationDeltaTime()
 {
-    return frameTimer.deltaTime();
+    return simulationDeltaTime;
 }
 
 float Engine::getRenderDeltaTime()
@@ -108,6 +164,26 @@ float Engine::getRenderDeltaTime()
     return renderManager.getDeltaTime();
 }
 
+UInt32 Engine::getRenderDescriptorWrites()
+{
+    return renderManager.getDescriptorWrites();
+}
+
+const RenderGraphStats& Engine::getRenderGraphStats()
+{
+    return renderManager.getGraphStats();
+}
+
+GpuMemoryStats Engine::getRenderMemoryStats()
+{
+    return renderManager.getMemoryAllocator().getStats();
+}
+
+std::vector<GpuHeapStats> Engine::getRenderHeapStats()
+{
+    return renderManager.getMemoryAllocator().getHeapStats();
+}
+
 void Engine::shutdown()
 {
     threadChecker.assertThread();
@@ -127,8 +203,18 @@ void Engine::shutdown()
         std::cout << "[Application] Render thread joined!\n";
     }
 
-    Platform::Window::destroyWindow(window);
-    Platform::shutdown();
+    if (headless && renderManager.hasBeenInitialized())
+        renderManager.shutdown();
+
+    // The render thread culls on the workers until it exits
+    jobSystem.stop();
+
+    if (!headless)
+    {
+        Platform::Window::destroyWindow(window);
+        Platform::shutdown();
+    }
+
     std::cout << "[Application] Shutdown complete!\n";
 }
 
@@ -162,6 +248,11 @@ void Engine::addSystem(SystemCallbacks callbacks)
     systemManager.add(std::move(callbacks));
 }
 
+JobSystem& Engine::jobs()
+{
+    return jobSystem;
+}
+
 SceneManager& Engine::scenes()
 {
     return sceneManager;
@@ -219,4 +310,15 @@ float Engine::getViewportAspectRatio(ViewportId id)
 RenderCommandQueue& Engine::getRenderCommandQueue()
 {
     return renderManager.getCommandQueue();
+}
+
+void Engine::captureFrame(std::filesystem::path path)
+{
+    check(headless, "[Engine] Frames can only be captured headless!");
+    renderManager.captureFrame(std::move(path));
+}
+
+UInt32 Engine::getCapturedFrameCount()
+{
+    return renderManager.getCapturedFrameCount();
 }
\ No newline at end of file
@@ -11,11 +11,14 @@ import Engine.SystemManager;
 import Engine.Viewport;
 import Engine.WorldManager;
 import Geometry;
+import Job;
 import Log;
 import Math;
 import Physics;
 import Render.CommandProcessor;
 import Render.EditorCallbacks;
+import Render.Graph;
+import Render.MemoryAllocator;
 import Render.Viewport;
 import SceneManager;
 import Window;
@@ -32,14 +35,29 @@ export namespace Engine
 
     ENGINE_API void init();
 
+    // Without a window: frames are rendered into an offscreen image of the given size, on the calling thread as part of
+    // update, and the simulation steps at a fixed rate, so runs are repeatable. Nothing is rendered before start.
+    ENGINE_API void initHeadless(Size2D size);
+
+    ENGINE_API bool isHeadless();
+
     ENGINE_API void start();
 
     ENGINE_API bool update();
 
+    // Time the systems were last stepped by, fixed when headless
     ENGINE_API float getSimulationDeltaTime();
 
     ENGINE_API float getRenderDeltaTime();
 
+    ENGINE_API UInt32 getRenderDescriptorWrites();
+
+    ENGINE_API const RenderGraphStats& getRenderGraphStats();
+
+    ENGINE_API GpuMemoryStats getRenderMemoryStats();
+
+    ENGINE_API std::vector<GpuHeapStats> getRenderHeapStats();
+
     ENGINE_API void shutdown();
 
     WindowHandle getWindow();
@@ -58,6 +76,8 @@ export namespace Engine
 
     ENGINE_API void addSystem(SystemCallbacks callbacks);
 
+    ENGINE_API JobSystem& jobs();
+
     //------------------------------------------------------------------------------------------------------------------------
     // Scene
     //------------------------------------------------------------------------------------------------------------------------
@@ -90,6 +110,12 @@ export namespace Engine
 
     ENGINE_API RenderCommandQueue& getRenderCommandQueue();
 
+    // Writes the next frame rendered to a PNG file. Headless only.
+    ENGINE_API void captureFrame(std::filesystem::path path);
+
+    // Captures written so far. The update that writes one also encodes its PNG, a few frames after it was requested.
+    ENGINE_API UInt32 getCapturedFrameCount();
+
     //------------------------------------------------------------------------------------------------------------------------
     // DEBUG -TEMPORARY
     //------------------------------------------------------------------------------------------------------------------------
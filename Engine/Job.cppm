@@ -6,8 +6,16 @@ export class JobSystem
 public:
 	using Job = std::function<void()>;
 
-	JobSystem(int numThreads) : m_stopFlag(false)
+	JobSystem() = default;
+	explicit JobSystem(int numThreads) { start(numThreads); }
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	~JobSystem() { stop(); }
+
+	void start(int numThreads)
 	{
+		m_stopFlag = false;
 		for (int i = 0; i < numThreads; ++i)
 		{
 			m_workers.emplace_back([this]
@@ -29,7 +37,7 @@ public:
 		}
 	}
 
-	~JobSystem()
+	void stop()
 	{
 		{
 			std::unique_lock<std::mutex> lock{ m_queueMutex };
@@ -40,6 +48,7 @@ public:
 		{
 			worker.join();
 		}
+		m_workers.clear();
 	}
 
 	void enqueueJob(Job job)
@@ -51,6 +60,50 @@ public:
 		m_condition.notify_one();
 	}
 
+	std::size_t getWorkerCount() const { return m_workers.size(); }
+
+	// Splits [0, count) into chunks of grainSize and calls fn(begin, end) for each of them, on the workers and on the
+	// calling thread, returning once every chunk is done. Chunks are handed out dynamically, so uneven work balances
+	// itself out.
+	template<typename Fn>
+	void parallelFor(std::size_t count, std::size_t grainSize, Fn&& fn)
+	{
+		const std::size_t chunkCount = (count + grainSize - 1) / grainSize;
+
+		if (chunkCount <= 1 || m_workers.empty())
+		{
+			if (count > 0)
+				fn(std::size_t{0}, count);
+			return;
+		}
+
+		std::atomic<std::size_t> nextChunk{0};
+
+		auto work = [&]
+		{
+			for (std::size_t chunk = nextChunk++; chunk < chunkCount; chunk = nextChunk++)
+			{
+				const std::size_t begin = chunk * grainSize;
+				fn(begin, std::min(begin + grainSize, count));
+			}
+		};
+
+		const std::size_t helperCount = std::min(m_workers.size(), chunkCount - 1);
+		std::latch done{static_cast<std::ptrdiff_t>(helperCount)};
+
+		for (std::size_t i = 0; i < helperCount; ++i)
+		{
+			enqueueJob([&]
+			{
+				work();
+				done.count_down();
+			});
+		}
+
+		work();
+		done.wait();
+	}
+
 private:
 	std::vector<std::thread> m_workers{};
 	std::queue<Job> m_jobs{};
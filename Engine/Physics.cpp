@@ -1,38 +1,44 @@
 module Physics;
 import Components.BoundingBox;
 import Components.Camera;
-import Components.Name;
 import Components.Transform;
 import Core;
+import Physics.AabbTree;
 
 namespace Physics
 {
+    Hit lineTraceLinear(const World& world, const Ray& ray, TraceChannelFlags channel);
     bool rayIntersectsAABB(const Ray& ray, const Vec3& aabbMin, const Vec3& aabbMax, float& tClosest);
     void checkNormalized(const Vec3& vector);
 }
 
 Entity Physics::lineTrace(const World& world, const Ray& ray, TraceChannelFlags channel)
 {
-    float closestHit = std::numeric_limits<float>::max();
-    Entity hitEntity;
+    if (const AabbTree* tree = world.readResource<AabbTree>())
+        return tree->rayCast(ray, channel).entity;
 
-    for (auto&& [entity, aabb] : world.query<BoundingBoxComponent>())
+    return lineTraceLinear(world, ray, channel).entity;
+}
+
+void Physics::lineTraceBatch(const World& world, std::span<const Ray> rays, TraceChannelFlags channel, std::span<Hit> hits)
+{
+    check(rays.size() == hits.size(), "[Physics::lineTraceBatch] Expected one hit per ray!", ErrorType::FatalError);
+
+    const AabbTree* tree = world.readResource<AabbTree>();
+    if (!tree)
     {
-        if (!aabb.channel.test(channel))
-            continue;
-        
-        float tClosest;
-        if (rayIntersectsAABB(ray, aabb.minWorld, aabb.maxWorld, tClosest))
-        {
-            if (tClosest < closestHit)
-            {
-                closestHit = tClosest;
-                hitEntity = entity;
-            }
-        }
+        for (std::size_t i = 0; i < rays.size(); ++i)
+            hits[i] = lineTraceLinear(world, rays[i], channel);
+        return;
+    }
+
+    static constexpr std::size_t width = AabbUtils::RayPacket::width;
+
+    for (std::size_t offset = 0; offset < rays.size(); offset += width)
+    {
+        const std::size_t count = std::min(width, rays.size() - offset);
+        tree->rayCast(AabbUtils::RayPacket{rays.subspan(offset, count)}, channel, hits.subspan(offset, count));
     }
-    log(closestHit < std::numeric_limits<float>::max() ? std::format("[Physics::lineTrace]: Hit '{}'", NameUtils::getName(world, hitEntity)) : "Miss");
-    return hitEntity;
 }
 
 Ray Physics::rayFromViewportUV(const Camera& camera, Vec2 uv)
@@ -71,6 +77,29 @@ std::optional<Vec3> Physics::intersectRayPlane(const Ray& ray, const Plane& plan
     return ray.origin + ray.direction * t;
 }
 
+// Worlds that aren't tracked by the bounding box system yet
+Hit Physics::lineTraceLinear(const World& world, const Ray& ray, TraceChannelFlags channel)
+{
+    Hit hit;
+
+    for (auto&& [entity, aabb] : world.query<BoundingBoxComponent>())
+    {
+        if (!aabb.channel.test(channel))
+            continue;
+        
+        float tClosest;
+        if (rayIntersectsAABB(ray, aabb.minWorld, aabb.maxWorld, tClosest))
+        {
+            if (tClosest < hit.distance)
+            {
+                hit.distance = tClosest;
+                hit.entity = entity;
+            }
+        }
+    }
+    return hit;
+}
+
 bool Physics::rayIntersectsAABB(const Ray& ray, const Vec3& aabbMin, const Vec3& aabbMax, float& tClosest)
 {
     float tMin = 0.0f;
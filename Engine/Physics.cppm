@@ -44,11 +44,28 @@ export struct Ray
     Vec3 direction{};
 };
 
+export struct Aabb
+{
+    Vec3 min{};
+    Vec3 max{};
+};
+
+export struct Hit
+{
+    Entity entity{};
+    float distance{std::numeric_limits<float>::max()};
+};
+
 namespace Physics
 {
     export ENGINE_API
     Entity lineTrace(const World& world, const Ray& ray, TraceChannelFlags channel);
 
+    // Traces many rays at once, writing one hit per ray (a default Hit on a miss). Rays are traced in SIMD packets of
+    // consecutive entries, so keeping coherent rays next to each other makes this considerably faster.
+    export ENGINE_API
+    void lineTraceBatch(const World& world, std::span<const Ray> rays, TraceChannelFlags channel, std::span<Hit> hits);
+
     export ENGINE_API
     Ray rayFromViewportUV(const Camera& camera, Vec2 uv);
 
@@ -0,0 +1,707 @@
+module Physics.AabbTree;
+
+namespace
+{
+    // Stretched along the displacement to anticipate further motion in the same direction
+    Aabb makeFatBounds(const Aabb& bounds, const Vec3& displacement)
+    {
+        Aabb fatBounds{bounds.min - Vec3{AabbTree::fatMargin}, bounds.max + Vec3{AabbTree::fatMargin}};
+        fatBounds.min += Math::min(displacement, Vec3{0.f});
+        fatBounds.max += Math::max(displacement, Vec3{0.f});
+        return fatBounds;
+    }
+}
+
+AabbUtils::RaySlab::RaySlab(const Ray& ray)
+    : origin{ray.origin}
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        parallel[i] = std::abs(ray.direction[i]) <= std::numeric_limits<float>::epsilon();
+        inverseDirection[i] = parallel[i] ? 0.f : 1.f / ray.direction[i];
+    }
+}
+
+float AabbUtils::intersect(const Aabb& box, const RaySlab& ray)
+{
+    static constexpr float miss = std::numeric_limits<float>::infinity();
+
+    float tMin = 0.0f;
+    float tMax = std::numeric_limits<float>::max();
+
+    for (int i = 0; i < 3; ++i)
+    {
+        if (ray.parallel[i])
+        {
+            if (ray.origin[i] < box.min[i] || ray.origin[i] > box.max[i])
+                return miss;
+            continue;
+        }
+
+        float t1 = (box.min[i] - ray.origin[i]) * ray.inverseDirection[i];
+        float t2 = (box.max[i] - ray.origin[i]) * ray.inverseDirection[i];
+
+        if (t1 > t2) std::swap(t1, t2);
+
+        tMin = std::max(tMin, t1);
+        tMax = std::min(tMax, t2);
+
+        if (tMax < tMin)
+            return miss;
+    }
+
+    return tMin;
+}
+
+AabbUtils::RayPacket::RayPacket(std::span<const Ray> rays)
+    : size{rays.size()}
+{
+    check(!rays.empty() && rays.size() <= width, "[RayPacket] Invalid number of rays!", ErrorType::FatalError);
+
+    // Unused lanes keep a zero origin and direction; callers never read their results.
+    std::array<std::array<float, width>, 3> origins{};
+    std::array<std::array<float, width>, 3> inverseDirections{};
+    std::array<std::array<float, width>, 3> parallels{};
+
+    for (std::size_t lane = 0; lane < rays.size(); ++lane)
+    {
+        // Same as RaySlab, so both paths agree on which rays count as parallel
+        const RaySlab slab{rays[lane]};
+
+        for (int i = 0; i < 3; ++i)
+        {
+            origins[i][lane] = slab.origin[i];
+            inverseDirections[i][lane] = slab.inverseDirection[i];
+            parallels[i][lane] = std::bit_cast<float>(slab.parallel[i] ? ~0u : 0u);
+        }
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        origin[i] = Float4::load(origins[i].data());
+        inverseDirection[i] = Float4::load(inverseDirections[i].data());
+        parallel[i] = Float4::load(parallels[i].data());
+    }
+}
+
+Float4 AabbUtils::intersect(const Aabb& box, const RayPacket& packet)
+{
+    const Float4 zero = Float4::broadcast(0.f);
+    const Float4 miss = Float4::broadcast(std::numeric_limits<float>::infinity());
+    const Float4 far = Float4::broadcast(std::numeric_limits<float>::max());
+
+    Float4 tMin = zero;
+    Float4 tMax = far;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const Float4 boxMin = Float4::broadcast(box.min[i]);
+        const Float4 boxMax = Float4::broadcast(box.max[i]);
+
+        const Float4 t1 = Simd::mul(Simd::sub(boxMin, packet.origin[i]), packet.inverseDirection[i]);
+        const Float4 t2 = Simd::mul(Simd::sub(boxMax, packet.origin[i]), packet.inverseDirection[i]);
+
+        // Parallel lanes have a zero inverse direction. They leave the interval alone while their origin is inside the
+        // slab and miss otherwise.
+        const Float4 insideSlab = Simd::maskAnd(Simd::lessEqual(boxMin, packet.origin[i]), Simd::lessEqual(packet.origin[i], boxMax));
+        const Float4 slabMin = Simd::select(packet.parallel[i], Simd::select(insideSlab, zero, miss), Simd::min(t1, t2));
+        const Float4 slabMax = Simd::select(packet.parallel[i], far, Simd::max(t1, t2));
+
+        tMin = Simd::max(tMin, slabMin);
+        tMax = Simd::min(tMax, slabMax);
+    }
+
+    return Simd::select(Simd::lessEqual(tMin, tMax), tMin, miss);
+}
+
+bool AabbTree::update(Entity entity, const Aabb& bounds, TraceChannel channel)
+{
+    const TraceChannelFlagsType channels = channel.toNumber();
+
+    if (Int32 proxy = getProxy(entity); proxy != nullNode)
+    {
+        Node& node = m_nodes[proxy];
+        const Aabb previous = node.bounds;
+        node.bounds = bounds;
+
+        if (node.channels != channels)
+        {
+            node.channels = channels;
+            refitUpwards(node.parent);
+        }
+
+        const Vec3 displacement = (AabbUtils::center(bounds) - AabbUtils::center(previous)) * displacementMultiplier;
+        const Aabb fatBounds = makeFatBounds(bounds, displacement);
+
+        // Also reinserted once the fat box is far larger than the one it would get now, after the leaf shrank or
+        // slowed down, so a margin left by one fast move doesn't keep inflating the tree
+        if (AabbUtils::contains(node.fatBounds, bounds)
+            && AabbUtils::volume(node.fatBounds) <= AabbUtils::volume(fatBounds) * maxFatVolumeRatio)
+            return false;
+
+        removeLeaf(proxy);
+        m_nodes[proxy].fatBounds = fatBounds;
+
+        insertLeaf(proxy);
+        ++m_reinsertsSinceCheck;
+        return true;
+    }
+
+    const Int32 leaf = allocateNode();
+    Node& node = m_nodes[leaf];
+    node.bounds = bounds;
+    node.fatBounds = makeFatBounds(bounds, Vec3{0.f});
+    node.height = 0;
+    node.channels = channels;
+    node.entity = entity;
+
+    if (entity.value >= m_proxies.size())
+        m_proxies.resize(entity.value + 1, nullNode);
+    m_proxies[entity.value] = leaf;
+
+    insertLeaf(leaf);
+    ++m_leafCount;
+    ++m_reinsertsSinceCheck;
+    return true;
+}
+
+void AabbTree::remove(Entity entity)
+{
+    const Int32 proxy = getProxy(entity);
+    if (proxy == nullNode)
+        return;
+
+    removeLeaf(proxy);
+    freeNode(proxy);
+    m_proxies[entity.value] = nullNode;
+    --m_leafCount;
+}
+
+void AabbTree::clear()
+{
+    m_nodes.clear();
+    m_proxies.clear();
+    m_root = nullNode;
+    m_freeList = nullNode;
+    m_leafCount = 0;
+    m_reinsertsSinceCheck = 0;
+    m_baselineCost = 0.f;
+}
+
+bool AabbTree::contains(Entity entity) const
+{
+    return getProxy(entity) != nullNode;
+}
+
+Hit AabbTree::rayCast(const Ray& ray, TraceChannelFlags channel, float maxDistance) const
+{
+    Hit hit{.distance = maxDistance};
+
+    if (m_root == nullNode)
+        return hit;
+
+    const auto mask = static_cast<TraceChannelFlagsType>(channel);
+    const AabbUtils::RaySlab slab{ray};
+
+    struct StackEntry
+    {
+        Int32 node;
+        float distance;
+    };
+
+    std::array<StackEntry, maxStackDepth> stack;
+    std::size_t stackSize = 0;
+
+    auto push = [&](Int32 index, float distance)
+    {
+        check(stackSize < maxStackDepth, "[AabbTree] Ray cast stack overflow!", ErrorType::FatalError);
+        stack[stackSize++] = {index, distance};
+    };
+
+    auto enter = [&](Int32 index)
+    {
+        const Node& node = m_nodes[index];
+        if ((node.channels & mask) != mask)
+            return std::numeric_limits<float>::infinity();
+        return AabbUtils::intersect(node.fatBounds, slab);
+    };
+
+    if (const float t = enter(m_root); t < hit.distance)
+        push(m_root, t);
+
+    while (stackSize > 0)
+    {
+        const auto [index, distance] = stack[--stackSize];
+
+        // A closer hit may have been found since this node was pushed.
+        if (distance >= hit.distance)
+            continue;
+
+        const Node& node = m_nodes[index];
+
+        if (node.isLeaf())
+        {
+            if (const float t = AabbUtils::intersect(node.bounds, slab); t < hit.distance)
+                hit = {.entity = node.entity, .distance = t};
+            continue;
+        }
+
+        float t1 = enter(node.child1);
+        float t2 = enter(node.child2);
+        Int32 near = node.child1;
+        Int32 far = node.child2;
+
+        if (t2 < t1)
+        {
+            std::swap(t1, t2);
+            std::swap(near, far);
+        }
+
+        // Push the far child first so the near one is visited next and tightens hit.distance early.
+        if (t2 < hit.distance)
+            push(far, t2);
+        if (t1 < hit.distance)
+            push(near, t1);
+    }
+
+    return hit;
+}
+
+void AabbTree::rayCast(const AabbUtils::RayPacket& packet, TraceChannelFlags channel, std::span<Hit> hits) const
+{
+    static constexpr std::size_t width = AabbUtils::RayPacket::width;
+
+    check(hits.size() >= packet.size, "[AabbTree] Not enough room for the packet hits!", ErrorType::FatalError);
+
+    // Unused lanes start with a negative distance so nothing can ever beat it.
+    std::array<float, width> distances;
+    for (std::size_t lane = 0; lane < width; ++lane)
+        distances[lane] = lane < packet.size ? std::numeric_limits<float>::max() : -1.f;
+
+    Float4 best = Float4::load(distances.data());
+    std::array<Entity, width> entities{};
+
+    if (m_root != nullNode)
+    {
+        const auto mask = static_cast<TraceChannelFlagsType>(channel);
+        const Float4 miss = Float4::broadcast(std::numeric_limits<float>::infinity());
+
+        struct StackEntry
+        {
+            Int32 node;
+            Float4 distance;
+        };
+
+        std::array<StackEntry, maxStackDepth> stack;
+        std::size_t stackSize = 0;
+
+        auto push = [&](Int32 index, Float4 distance)
+        {
+            check(stackSize < maxStackDepth, "[AabbTree] Ray cast stack overflow!", ErrorType::FatalError);
+            stack[stackSize++] = {index, distance};
+        };
+
+        auto enter = [&](Int32 index)
+        {
+            const Node& node = m_nodes[index];
+            if ((node.channels & mask) != mask)
+                return miss;
+            return AabbUtils::intersect(node.fatBounds, packet);
+        };
+
+        if (const Float4 t = enter(m_root); Simd::moveMask(Simd::less(t, best)) != 0)
+            push(m_root, t);
+
+        while (stackSize > 0)
+        {
+            const auto [index, distance] = stack[--stackSize];
+
+            // Skip if every ray found something closer since this node was pushed.
+            if (Simd::moveMask(Simd::less(distance, best)) == 0)
+                continue;
+
+            const Node& node = m_nodes[index];
+
+            if (node.isLeaf())
+            {
+                const Float4 t = AabbUtils::intersect(node.bounds, packet);
+                const Float4 closer = Simd::less(t, best);
+
+                if (UInt32 lanes = Simd::moveMask(closer); lanes != 0)
+                {
+                    best = Simd::select(closer, t, best);
+                    for (; lanes != 0; lanes &= lanes - 1)
+                        entities[std::countr_zero(lanes)] = node.entity;
+                }
+                continue;
+            }
+
+            Float4 t1 = enter(node.child1);
+            Float4 t2 = enter(node.child2);
+            Float4 mask1 = Simd::less(t1, best);
+            Float4 mask2 = Simd::less(t2, best);
+            Int32 near = node.child1;
+            Int32 far = node.child2;
+
+            // Order by the closest entry among the rays that actually hit each child.
+            if (Simd::reduceMin(Simd::select(mask2, t2, miss)) < Simd::reduceMin(Simd::select(mask1, t1, miss)))
+            {
+                std::swap(t1, t2);
+                std::swap(mask1, mask2);
+                std::swap(near, far);
+            }
+
+            if (Simd::moveMask(mask2) != 0)
+                push(far, t2);
+            if (Simd::moveMask(mask1) != 0)
+                push(near, t1);
+        }
+    }
+
+    best.store(distances.data());
+    for (std::size_t lane = 0; lane < packet.size; ++lane)
+        hits[lane] = entities[lane] ? Hit{.entity = entities[lane], .distance = distances[lane]} : Hit{};
+}
+
+void AabbTree::rebuild()
+{
+    if (m_root == nullNode)
+        return;
+
+    std::vector<Int32> leaves;
+    leaves.reserve(m_leafCount);
+
+    for (Int32 i = 0; i < static_cast<Int32>(m_nodes.size()); ++i)
+    {
+        Node& node = m_nodes[i];
+        if (node.height < 0)
+            continue;
+
+        if (node.isLeaf())
+        {
+            node.parent = nullNode;
+            leaves.push_back(i);
+        }
+        else
+        {
+            freeNode(i);
+        }
+    }
+
+    m_root = buildTopDown(leaves);
+    m_nodes[m_root].parent = nullNode;
+    m_baselineCost = computeCost();
+    m_reinsertsSinceCheck = 0;
+}
+
+bool AabbTree::rebuildIfDegraded()
+{
+    static constexpr std::size_t minReinserts = 64;
+
+    if (m_reinsertsSinceCheck < std::max(minReinserts, m_leafCount / 4))
+        return false;
+
+    m_reinsertsSinceCheck = 0;
+
+    const float cost = computeCost();
+    if (m_baselineCost <= 0.f)
+    {
+        m_baselineCost = cost;
+        return false;
+    }
+
+    if (cost <= m_baselineCost * degradationThreshold)
+        return false;
+
+    rebuild();
+    return true;
+}
+
+Int32 AabbTree::getHeight() const
+{
+    return m_root != nullNode ? m_nodes[m_root].height : 0;
+}
+
+Int32 AabbTree::allocateNode()
+{
+    if (m_freeList == nullNode)
+    {
+        m_nodes.emplace_back();
+        return static_cast<Int32>(m_nodes.size() - 1);
+    }
+
+    const Int32 index = m_freeList;
+    m_freeList = m_nodes[index].parent;
+    m_nodes[index] = Node{};
+    return index;
+}
+
+void AabbTree::freeNode(Int32 index)
+{
+    Node& node = m_nodes[index];
+    node = Node{};
+    node.parent = m_freeList;
+    m_freeList = index;
+}
+
+void AabbTree::insertLeaf(Int32 leaf)
+{
+    if (m_root == nullNode)
+    {
+        m_root = leaf;
+        m_nodes[leaf].parent = nullNode;
+        return;
+    }
+
+    // Descend towards the sibling that minimises the surface area heuristic cost.
+    const Aabb leafBounds = m_nodes[leaf].fatBounds;
+    Int32 index = m_root;
+
+    while (!m_nodes[index].isLeaf())
+    {
+        const Node& node = m_nodes[index];
+
+        const float area = AabbUtils::area(node.fatBounds);
+        const float combinedArea = AabbUtils::area(AabbUtils::merge(node.fatBounds, leafBounds));
+
+        // Cost of creating a new parent for this node and the new leaf
+        const float cost = 2.f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree
+        const float inheritanceCost = 2.f * (combinedArea - area);
+
+        auto descendCost = [&](Int32 child)
+        {
+            const Node& childNode = m_nodes[child];
+            const float mergedArea = AabbUtils::area(AabbUtils::merge(leafBounds, childNode.fatBounds));
+            return (childNode.isLeaf() ? mergedArea : mergedArea - AabbUtils::area(childNode.fatBounds)) + inheritanceCost;
+        };
+
+        const float cost1 = descendCost(node.child1);
+        const float cost2 = descendCost(node.child2);
+
+        if (cost < cost1 && cost < cost2)
+            break;
+
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    const Int32 sibling = index;
+    const Int32 oldParent = m_nodes[sibling].parent;
+    const Int32 newParent = allocateNode();
+
+    {
+        Node& parent = m_nodes[newParent];
+        parent.parent = oldParent;
+        parent.child1 = sibling;
+        parent.child2 = leaf;
+    }
+
+    if (oldParent != nullNode)
+    {
+        Node& grandParent = m_nodes[oldParent];
+        if (grandParent.child1 == sibling)
+            grandParent.child1 = newParent;
+        else
+            grandParent.child2 = newParent;
+    }
+    else
+    {
+        m_root = newParent;
+    }
+
+    m_nodes[sibling].parent = newParent;
+    m_nodes[leaf].parent = newParent;
+
+    refitUpwards(newParent);
+}
+
+void AabbTree::removeLeaf(Int32 leaf)
+{
+    if (leaf == m_root)
+    {
+        m_root = nullNode;
+        return;
+    }
+
+    const Int32 parent = m_nodes[leaf].parent;
+    const Int32 grandParent = m_nodes[parent].parent;
+    const Int32 sibling = m_nodes[parent].child1 == leaf ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+    if (grandParent != nullNode)
+    {
+        Node& grandParentNode = m_nodes[grandParent];
+        if (grandParentNode.child1 == parent)
+            grandParentNode.child1 = sibling;
+        else
+            grandParentNode.child2 = sibling;
+
+        m_nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        refitUpwards(grandParent);
+    }
+    else
+    {
+        m_root = sibling;
+        m_nodes[sibling].parent = nullNode;
+        freeNode(parent);
+    }
+
+    m_nodes[leaf].parent = nullNode;
+}
+
+void AabbTree::refitUpwards(Int32 index)
+{
+    while (index != nullNode)
+    {
+        index = balance(index);
+        refit(index);
+        index = m_nodes[index].parent;
+    }
+}
+
+void AabbTree::refit(Int32 index)
+{
+    Node& node = m_nodes[index];
+    const Node& child1 = m_nodes[node.child1];
+    const Node& child2 = m_nodes[node.child2];
+
+    node.fatBounds = AabbUtils::merge(child1.fatBounds, child2.fatBounds);
+    node.height = 1 + std::max(child1.height, child2.height);
+    node.channels = child1.channels | child2.channels;
+}
+
+// Rotates the subtree rooted at index if its children heights differ by more than one.
+// Returns the index of the node that now sits where index used to be.
+Int32 AabbTree::balance(Int32 indexA)
+{
+    Node& a = m_nodes[indexA];
+    if (a.isLeaf() || a.height < 2)
+        return indexA;
+
+    const Int32 indexB = a.child1;
+    const Int32 indexC = a.child2;
+    Node& b = m_nodes[indexB];
+    Node& c = m_nodes[indexC];
+
+    const Int32 heightDifference = c.height - b.height;
+
+    // Promote C or B, whichever is taller, swapping its shorter grandchild down to A.
+    auto rotate = [&](Int32 indexUp, Int32 indexDown, bool upIsChild2)
+    {
+        Node& up = m_nodes[indexUp];
+        Node& down = m_nodes[indexDown];
+
+        const Int32 indexF = up.child1;
+        const Int32 indexG = up.child2;
+        Node& f = m_nodes[indexF];
+        Node& g = m_nodes[indexG];
+
+        up.child1 = indexA;
+        up.parent = a.parent;
+        a.parent = indexUp;
+
+        if (up.parent != nullNode)
+        {
+            Node& parent = m_nodes[up.parent];
+            if (parent.child1 == indexA)
+                parent.child1 = indexUp;
+            else
+                parent.child2 = indexUp;
+        }
+        else
+        {
+            m_root = indexUp;
+        }
+
+        const bool keepF = f.height > g.height;
+        const Int32 indexKeep = keepF ? indexF : indexG;
+        const Int32 indexMove = keepF ? indexG : indexF;
+
+        up.child2 = indexKeep;
+        if (upIsChild2)
+            a.child2 = indexMove;
+        else
+            a.child1 = indexMove;
+        m_nodes[indexMove].parent = indexA;
+
+        const Node& keep = m_nodes[indexKeep];
+        const Node& move = m_nodes[indexMove];
+
+        a.fatBounds = AabbUtils::merge(down.fatBounds, move.fatBounds);
+        a.height = 1 + std::max(down.height, move.height);
+        a.channels = down.channels | move.channels;
+
+        up.fatBounds = AabbUtils::merge(a.fatBounds, keep.fatBounds);
+        up.height = 1 + std::max(a.height, keep.height);
+        up.channels = a.channels | keep.channels;
+
+        return indexUp;
+    };
+
+    if (heightDifference > 1)
+        return rotate(indexC, indexB, true);
+
+    if (heightDifference < -1)
+        return rotate(indexB, indexC, false);
+
+    return indexA;
+}
+
+Int32 AabbTree::buildTopDown(std::span<Int32> leaves)
+{
+    if (leaves.size() == 1)
+        return leaves.front();
+
+    Aabb centroidBounds{Vec3{std::numeric_limits<float>::max()}, Vec3{std::numeric_limits<float>::lowest()}};
+    for (const Int32 leaf : leaves)
+    {
+        const Vec3 center = AabbUtils::center(m_nodes[leaf].fatBounds);
+        centroidBounds.min = Math::min(centroidBounds.min, center);
+        centroidBounds.max = Math::max(centroidBounds.max, center);
+    }
+
+    const Vec3 extent = centroidBounds.max - centroidBounds.min;
+    const int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+
+    const auto middle = leaves.begin() + static_cast<std::ptrdiff_t>(leaves.size() / 2);
+    std::ranges::nth_element(leaves, middle, {}, [&](Int32 leaf) { return AabbUtils::center(m_nodes[leaf].fatBounds)[axis]; });
+
+    const std::size_t half = leaves.size() / 2;
+    const Int32 child1 = buildTopDown(leaves.first(half));
+    const Int32 child2 = buildTopDown(leaves.subspan(half));
+
+    const Int32 parent = allocateNode();
+    m_nodes[parent].child1 = child1;
+    m_nodes[parent].child2 = child2;
+    m_nodes[child1].parent = parent;
+    m_nodes[child2].parent = parent;
+    refit(parent);
+
+    return parent;
+}
+
+float AabbTree::computeCost() const
+{
+    if (m_root == nullNode)
+        return 0.f;
+
+    const float rootArea = AabbUtils::area(m_nodes[m_root].fatBounds);
+    if (rootArea <= 0.f)
+        return 0.f;
+
+    float totalArea = 0.f;
+    for (const Node& node : m_nodes)
+    {
+        if (node.height > 0)
+            totalArea += AabbUtils::area(node.fatBounds);
+    }
+
+    return totalArea / rootArea;
+}
+
+Int32 AabbTree::getProxy(Entity entity) const
+{
+    return entity && entity.value < m_proxies.size() ? m_proxies[entity.value] : nullNode;
+}
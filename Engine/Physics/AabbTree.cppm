@@ -0,0 +1,182 @@
+export module Physics.AabbTree;
+import Core;
+import Math;
+import Physics;
+import Simd;
+
+export namespace AabbUtils
+{
+    [[nodiscard]] Aabb merge(const Aabb& a, const Aabb& b)
+    {
+        return {Math::min(a.min, b.min), Math::max(a.max, b.max)};
+    }
+
+    [[nodiscard]] bool contains(const Aabb& outer, const Aabb& inner)
+    {
+        return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z
+            && inner.max.x <= outer.max.x && inner.max.y <= outer.max.y && inner.max.z <= outer.max.z;
+    }
+
+    [[nodiscard]] bool overlaps(const Aabb& a, const Aabb& b)
+    {
+        return a.min.x <= b.max.x && b.min.x <= a.max.x
+            && a.min.y <= b.max.y && b.min.y <= a.max.y
+            && a.min.z <= b.max.z && b.min.z <= a.max.z;
+    }
+
+    // Half the surface area, which is all the insertion cost heuristic needs.
+    [[nodiscard]] float area(const Aabb& box)
+    {
+        const Vec3 d = box.max - box.min;
+        return d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+
+    [[nodiscard]] float volume(const Aabb& box)
+    {
+        const Vec3 d = box.max - box.min;
+        return d.x * d.y * d.z;
+    }
+
+    [[nodiscard]] Vec3 center(const Aabb& box)
+    {
+        return (box.min + box.max) * 0.5f;
+    }
+
+    // Precomputed ray data shared by every box test of a traversal.
+    struct RaySlab
+    {
+        explicit RaySlab(const Ray& ray);
+
+        Vec3 origin;
+        Vec3 inverseDirection;
+        std::array<bool, 3> parallel{};
+    };
+
+    // Distance to the entry point of the box (0 if the origin is inside), or infinity on a miss.
+    [[nodiscard]] float intersect(const Aabb& box, const RaySlab& ray);
+
+    // Up to Float4::width rays in structure-of-arrays layout, one per lane
+    struct RayPacket
+    {
+        static constexpr std::size_t width = Float4::width;
+
+        explicit RayPacket(std::span<const Ray> rays);
+
+        std::array<Float4, 3> origin;
+        std::array<Float4, 3> inverseDirection; // Zero on parallel lanes
+        std::array<Float4, 3> parallel;         // Lane masks, per axis
+        std::size_t size{};
+    };
+
+    // Per-lane version of the slab test above
+    [[nodiscard]] Float4 intersect(const Aabb& box, const RayPacket& packet);
+}
+
+// Dynamic bounding volume hierarchy over world-space AABBs.
+// Leaves store a fattened copy of the tight bounds so small movements don't touch the tree, and every node keeps the
+// union of the trace channels below it so queries can skip whole subtrees.
+export class AabbTree
+{
+public:
+    static constexpr float fatMargin = 0.1f;
+    static constexpr float displacementMultiplier = 2.f;
+    static constexpr float maxFatVolumeRatio = 2.f; // Beyond this, a fat box that still holds its leaf is shrunk
+
+    // Inserts the entity if it isn't in the tree yet. Returns true if the tree structure changed.
+    bool update(Entity entity, const Aabb& bounds, TraceChannel channel);
+    void remove(Entity entity);
+    void clear();
+
+    [[nodiscard]] bool contains(Entity entity) const;
+
+    // Closest hit along the ray, only considering leaves whose channel includes all the requested flags.
+    [[nodiscard]] Hit rayCast(const Ray& ray, TraceChannelFlags channel, float maxDistance = std::numeric_limits<float>::max()) const;
+
+    // Traces every ray of the packet in a single traversal, writing one hit per ray. A subtree is only skipped when
+    // all of the rays miss it, so this pays off for coherent rays (neighbouring pixels, similar origins).
+    void rayCast(const AabbUtils::RayPacket& packet, TraceChannelFlags channel, std::span<Hit> hits) const;
+
+    // Calls fn(Entity) for every leaf whose tight bounds overlap the given box.
+    template<typename Fn>
+    void query(const Aabb& bounds, TraceChannelFlags channel, Fn&& fn) const;
+
+    // Full top-down rebuild. Restores query quality after many incremental reinsertions.
+    void rebuild();
+
+    // Cheap check run once per frame: after enough reinsertions, compares the tree cost with the one measured after
+    // the last rebuild and rebuilds if it degraded too much.
+    bool rebuildIfDegraded();
+
+    [[nodiscard]] std::size_t size() const { return m_leafCount; }
+    [[nodiscard]] Int32 getHeight() const;
+
+private:
+    static constexpr Int32 nullNode = -1;
+    static constexpr std::size_t maxStackDepth = 256;
+    static constexpr float degradationThreshold = 1.5f;
+
+    struct Node
+    {
+        Aabb fatBounds{};
+        Aabb bounds{};
+        Int32 parent{nullNode}; // Next free node while in the free list
+        Int32 child1{nullNode};
+        Int32 child2{nullNode};
+        Int32 height{-1};
+        TraceChannelFlagsType channels{};
+        Entity entity{};
+
+        [[nodiscard]] bool isLeaf() const { return child1 == nullNode; }
+    };
+
+    Int32 allocateNode();
+    void freeNode(Int32 index);
+    void insertLeaf(Int32 leaf);
+    void removeLeaf(Int32 leaf);
+    void refitUpwards(Int32 index);
+    void refit(Int32 index);
+    Int32 balance(Int32 index);
+    Int32 buildTopDown(std::span<Int32> leaves);
+    [[nodiscard]] float computeCost() const;
+    [[nodiscard]] Int32 getProxy(Entity entity) const;
+
+    std::vector<Node> m_nodes;
+    std::vector<Int32> m_proxies; // Indexed by entity value
+    Int32 m_root{nullNode};
+    Int32 m_freeList{nullNode};
+    std::size_t m_leafCount{};
+    std::size_t m_reinsertsSinceCheck{};
+    float m_baselineCost{};
+};
+
+template<typename Fn>
+void AabbTree::query(const Aabb& bounds, TraceChannelFlags channel, Fn&& fn) const
+{
+    if (m_root == nullNode)
+        return;
+
+    const auto mask = static_cast<TraceChannelFlagsType>(channel);
+
+    std::array<Int32, maxStackDepth> stack;
+    std::size_t stackSize = 0;
+    stack[stackSize++] = m_root;
+
+    while (stackSize > 0)
+    {
+        const Node& node = m_nodes[stack[--stackSize]];
+
+        if ((node.channels & mask) != mask || !AabbUtils::overlaps(node.fatBounds, bounds))
+            continue;
+
+        if (node.isLeaf())
+        {
+            if (AabbUtils::overlaps(node.bounds, bounds))
+                fn(node.entity);
+            continue;
+        }
+
+        check(stackSize + 2 <= maxStackDepth, "[AabbTree] Query stack overflow!", ErrorType::FatalError);
+        stack[stackSize++] = node.child1;
+        stack[stackSize++] = node.child2;
+    }
+}
@@ -0,0 +1,383 @@
+module Physics.Broadphase;
+
+void Broadphase::update(Entity entity, const Aabb& bounds, TraceChannel channel)
+{
+    UInt32 proxy = getProxy(entity);
+
+    if (proxy == nullProxy)
+    {
+        proxy = allocateProxy();
+
+        Proxy& newProxy = m_proxies[proxy];
+        newProxy.bounds = bounds;
+        newProxy.channels = channel.toNumber();
+        newProxy.entity = entity;
+
+        if (entity.value >= m_entityProxies.size())
+            m_entityProxies.resize(entity.value + 1, nullProxy);
+        m_entityProxies[entity.value] = proxy;
+
+        m_pendingInserts.push_back(proxy);
+        return;
+    }
+
+    Proxy& existing = m_proxies[proxy];
+    existing.bounds = bounds;
+    existing.channels = channel.toNumber();
+
+    if (existing.inserted)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            m_axes[axis][existing.min[axis]].value = bounds.min[axis];
+            m_axes[axis][existing.max[axis]].value = bounds.max[axis];
+        }
+        m_moved = true;
+    }
+}
+
+void Broadphase::remove(Entity entity)
+{
+    const UInt32 proxy = getProxy(entity);
+    if (proxy == nullProxy)
+        return;
+
+    m_entityProxies[entity.value] = nullProxy;
+
+    if (m_proxies[proxy].inserted)
+    {
+        m_proxies[proxy].removed = true;
+        m_pendingRemoves.push_back(proxy);
+    }
+    else
+    {
+        std::erase(m_pendingInserts, proxy);
+        freeProxy(proxy);
+    }
+}
+
+void Broadphase::clear()
+{
+    for (std::vector<Endpoint>& endpoints : m_axes)
+        endpoints.clear();
+
+    m_proxies.clear();
+    m_entityProxies.clear();
+    m_pendingInserts.clear();
+    m_pendingRemoves.clear();
+    m_freeList = nullProxy;
+    m_moved = false;
+    m_pairs.clear();
+    m_pairIndices.clear();
+    clearEvents();
+}
+
+void Broadphase::flush()
+{
+    const bool removed = !m_pendingRemoves.empty();
+    if (removed)
+        applyRemovals();
+
+    if (m_pendingInserts.size() > incrementalInsertLimit)
+    {
+        rebuild();
+    }
+    else if (m_moved || removed || !m_pendingInserts.empty())
+    {
+        // New endpoints start at the end of the axes and get sorted down like any other moved endpoint.
+        for (const UInt32 proxy : m_pendingInserts)
+            appendEndpoints(proxy);
+
+        for (int axis = 0; axis < 3; ++axis)
+            sortAxis(axis);
+    }
+
+    m_pendingInserts.clear();
+    m_moved = false;
+
+    coalesceEvents();
+}
+
+void Broadphase::clearEvents()
+{
+    m_beginEvents.clear();
+    m_endEvents.clear();
+}
+
+bool Broadphase::contains(Entity entity) const
+{
+    return getProxy(entity) != nullProxy;
+}
+
+bool Broadphase::isOverlapping(Entity a, Entity b) const
+{
+    const UInt32 proxyA = getProxy(a);
+    const UInt32 proxyB = getProxy(b);
+    return proxyA != nullProxy && proxyB != nullProxy && m_pairIndices.contains(makePairKey(proxyA, proxyB));
+}
+
+UInt32 Broadphase::allocateProxy()
+{
+    if (m_freeList == nullProxy)
+    {
+        m_proxies.emplace_back();
+        return static_cast<UInt32>(m_proxies.size() - 1);
+    }
+
+    const UInt32 proxy = m_freeList;
+    m_freeList = m_proxies[proxy].nextFree;
+    m_proxies[proxy] = Proxy{};
+    return proxy;
+}
+
+void Broadphase::freeProxy(UInt32 proxy)
+{
+    m_proxies[proxy] = Proxy{.nextFree = m_freeList};
+    m_freeList = proxy;
+}
+
+// Ends the pairs of the removed boxes and drops their endpoints. Erasing keeps the remaining endpoints sorted.
+void Broadphase::applyRemovals()
+{
+    for (std::size_t i = m_pairs.size(); i-- > 0;)
+    {
+        const Pair pair = m_pairs[i];
+        if (m_proxies[pair.first].removed || m_proxies[pair.second].removed)
+            removePair(pair.first, pair.second);
+    }
+
+    for (std::vector<Endpoint>& endpoints : m_axes)
+        std::erase_if(endpoints, [this](const Endpoint& endpoint) { return m_proxies[endpoint.getProxy()].removed; });
+
+    for (const UInt32 proxy : m_pendingRemoves)
+        freeProxy(proxy);
+    m_pendingRemoves.clear();
+}
+
+void Broadphase::appendEndpoints(UInt32 proxy)
+{
+    Proxy& newProxy = m_proxies[proxy];
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        m_axes[axis].push_back({newProxy.bounds.min[axis], proxy << 1});
+        m_axes[axis].push_back({newProxy.bounds.max[axis], proxy << 1 | 1});
+    }
+
+    newProxy.inserted = true;
+}
+
+// Insertion sort, which is close to linear on the nearly sorted endpoints of the previous frame. Every swap resolves
+// exactly one change of order, so every min/max crossing between two boxes is seen once and their pair re-tested
+// against the final bounds.
+void Broadphase::sortAxis(int axis)
+{
+    std::vector<Endpoint>& endpoints = m_axes[axis];
+
+    for (std::size_t i = 1; i < endpoints.size(); ++i)
+    {
+        const Endpoint moving = endpoints[i];
+        std::size_t j = i;
+
+        while (j > 0 && less(moving, endpoints[j - 1]))
+        {
+            const Endpoint& other = endpoints[j - 1];
+            if (moving.isMax() != other.isMax() && moving.getProxy() != other.getProxy())
+                updatePair(moving.getProxy(), other.getProxy());
+
+            endpoints[j] = other;
+            --j;
+        }
+
+        endpoints[j] = moving;
+    }
+
+    updateEndpointIndices(axis);
+}
+
+void Broadphase::updateEndpointIndices(int axis)
+{
+    const std::vector<Endpoint>& endpoints = m_axes[axis];
+
+    for (UInt32 i = 0; i < endpoints.size(); ++i)
+    {
+        Proxy& proxy = m_proxies[endpoints[i].getProxy()];
+        (endpoints[i].isMax() ? proxy.max : proxy.min)[axis] = i;
+    }
+}
+
+// Sorts every axis from scratch and finds the overlapping pairs with a single sweep, then diffs them against the
+// previous pairs to emit events. Cheaper than sorting many new boxes in one by one.
+void Broadphase::rebuild()
+{
+    for (const UInt32 proxy : m_pendingInserts)
+        appendEndpoints(proxy);
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        std::ranges::sort(m_axes[axis], less);
+        updateEndpointIndices(axis);
+    }
+
+    std::vector<Pair> pairs;
+    std::unordered_map<UInt64, UInt32> pairIndices;
+    std::vector<UInt32> active;
+
+    for (Proxy& proxy : m_proxies)
+        proxy.pairCount = 0;
+
+    for (const Endpoint& endpoint : m_axes[0])
+    {
+        const UInt32 proxy = endpoint.getProxy();
+
+        if (endpoint.isMax())
+        {
+            const auto it = std::ranges::find(active, proxy);
+            *it = active.back();
+            active.pop_back();
+            continue;
+        }
+
+        for (const UInt32 other : active)
+        {
+            if (overlaps(proxy, other))
+            {
+                pairIndices.emplace(makePairKey(proxy, other), static_cast<UInt32>(pairs.size()));
+                pairs.push_back({proxy, other});
+                ++m_proxies[proxy].pairCount;
+                ++m_proxies[other].pairCount;
+            }
+        }
+        active.push_back(proxy);
+    }
+
+    for (const Pair& pair : m_pairs)
+    {
+        if (!pairIndices.contains(makePairKey(pair.first, pair.second)))
+            m_endEvents.push_back(makeEvent(pair.first, pair.second));
+    }
+
+    for (const Pair& pair : pairs)
+    {
+        if (!m_pairIndices.contains(makePairKey(pair.first, pair.second)))
+            m_beginEvents.push_back(makeEvent(pair.first, pair.second));
+    }
+
+    m_pairs = std::move(pairs);
+    m_pairIndices = std::move(pairIndices);
+}
+
+// A pair can start and stop overlapping several times within a frame; listeners only care about the net change.
+void Broadphase::coalesceEvents()
+{
+    if (m_beginEvents.empty() || m_endEvents.empty())
+        return;
+
+    auto getKey = [](const OverlapEvent& event) { return makePairKey(event.pair.first.value, event.pair.second.value); };
+
+    std::unordered_map<UInt64, Int32> balance;
+    for (const OverlapEvent& event : m_beginEvents)
+        ++balance[getKey(event)];
+    for (const OverlapEvent& event : m_endEvents)
+        --balance[getKey(event)];
+
+    auto keepNet = [&](std::vector<OverlapEvent>& events, Int32 sign)
+    {
+        std::erase_if(events, [&](const OverlapEvent& event)
+        {
+            Int32& count = balance[getKey(event)];
+            if (count * sign <= 0)
+                return true;
+            count -= sign;
+            return false;
+        });
+    };
+
+    keepNet(m_beginEvents, 1);
+    keepNet(m_endEvents, -1);
+}
+
+bool Broadphase::overlaps(UInt32 a, UInt32 b) const
+{
+    const Aabb& boundsA = m_proxies[a].bounds;
+    const Aabb& boundsB = m_proxies[b].bounds;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (boundsA.max[axis] < boundsB.min[axis] || boundsB.max[axis] < boundsA.min[axis])
+            return false;
+    }
+    return true;
+}
+
+void Broadphase::updatePair(UInt32 a, UInt32 b)
+{
+    if (overlaps(a, b))
+        addPair(a, b);
+    else if (m_proxies[a].pairCount > 0 && m_proxies[b].pairCount > 0) // Skips the lookup for most crossings
+        removePair(a, b);
+}
+
+void Broadphase::addPair(UInt32 a, UInt32 b)
+{
+    const auto [it, inserted] = m_pairIndices.try_emplace(makePairKey(a, b), static_cast<UInt32>(m_pairs.size()));
+    if (!inserted)
+        return;
+
+    m_pairs.push_back({a, b});
+    ++m_proxies[a].pairCount;
+    ++m_proxies[b].pairCount;
+    m_beginEvents.push_back(makeEvent(a, b));
+}
+
+void Broadphase::removePair(UInt32 a, UInt32 b)
+{
+    const auto it = m_pairIndices.find(makePairKey(a, b));
+    if (it == m_pairIndices.end())
+        return;
+
+    const UInt32 index = it->second;
+    m_pairIndices.erase(it);
+
+    if (index != m_pairs.size() - 1)
+    {
+        const Pair& last = m_pairs.back();
+        m_pairs[index] = last;
+        m_pairIndices[makePairKey(last.first, last.second)] = index;
+    }
+    m_pairs.pop_back();
+    --m_proxies[a].pairCount;
+    --m_proxies[b].pairCount;
+
+    m_endEvents.push_back(makeEvent(a, b));
+}
+
+Broadphase::OverlapEvent Broadphase::makeEvent(UInt32 a, UInt32 b) const
+{
+    const Proxy& first = m_proxies[a];
+    const Proxy& second = m_proxies[b];
+    return {{first.entity, second.entity}, first.channels, second.channels};
+}
+
+UInt32 Broadphase::getProxy(Entity entity) const
+{
+    return entity && entity.value < m_entityProxies.size() ? m_entityProxies[entity.value] : nullProxy;
+}
+
+// Ties put min endpoints first, so boxes that only touch count as overlapping, matching overlaps().
+bool Broadphase::less(const Endpoint& a, const Endpoint& b)
+{
+    return a.value < b.value || (a.value == b.value && !a.isMax() && b.isMax());
+}
+
+UInt64 Broadphase::makePairKey(UInt32 a, UInt32 b)
+{
+    const auto [low, high] = std::minmax(a, b);
+    return static_cast<UInt64>(low) << 32 | high;
+}
+
+bool Broadphase::test(TraceChannelFlagsType channels, TraceChannelFlags channel)
+{
+    const auto mask = static_cast<TraceChannelFlagsType>(channel);
+    return (channels & mask) == mask;
+}
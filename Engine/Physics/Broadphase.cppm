@@ -0,0 +1,151 @@
+export module Physics.Broadphase;
+import Core;
+import Physics;
+
+export struct OverlapPair
+{
+    Entity first{};
+    Entity second{};
+};
+
+// Sweep-and-prune broadphase over world-space AABBs.
+// Keeps the min/max endpoints of every box sorted along each axis. Boxes move little from one frame to the next, so
+// re-sorting is a cheap insertion sort, and a pair can only start or stop overlapping where a min endpoint crosses a
+// max endpoint: only those pairs are re-tested, instead of recomputing the pair set.
+export class Broadphase
+{
+public:
+    // Changes are buffered and applied together on the next flush().
+    void update(Entity entity, const Aabb& bounds, TraceChannel channel);
+    void remove(Entity entity);
+    void clear();
+
+    // Applies the buffered changes and updates the pair set. Large batches of insertions (e.g. a level load) trigger a
+    // full sort and sweep instead of the insertion sort.
+    void flush();
+
+    // Drops the begin/end events gathered so far. Called once per frame before the updates.
+    void clearEvents();
+
+    [[nodiscard]] bool contains(Entity entity) const;
+    [[nodiscard]] bool isOverlapping(Entity a, Entity b) const;
+    [[nodiscard]] std::size_t getPairCount() const { return m_pairs.size(); }
+
+    // Pairs whose boxes currently overlap and whose channels both include the requested flags.
+    template<typename Fn>
+    void forEachPair(TraceChannelFlags channel, Fn&& fn) const;
+
+    // Pairs that started or stopped overlapping since the last clearEvents(), reduced to their net change by flush().
+    // Channels are the ones the boxes had when the event happened, so end events are still reported for destroyed
+    // entities.
+    template<typename Fn>
+    void forEachBeginOverlap(TraceChannelFlags channel, Fn&& fn) const;
+
+    template<typename Fn>
+    void forEachEndOverlap(TraceChannelFlags channel, Fn&& fn) const;
+
+private:
+    static constexpr UInt32 nullProxy = std::numeric_limits<UInt32>::max();
+    static constexpr std::size_t incrementalInsertLimit = 256;
+
+    struct Endpoint
+    {
+        float value;
+        UInt32 data; // Proxy index << 1 | isMax
+
+        [[nodiscard]] UInt32 getProxy() const { return data >> 1; }
+        [[nodiscard]] bool isMax() const { return data & 1; }
+    };
+
+    struct Proxy
+    {
+        Aabb bounds{};
+        std::array<UInt32, 3> min{}; // Endpoint index on each axis
+        std::array<UInt32, 3> max{};
+        TraceChannelFlagsType channels{};
+        Entity entity{};
+        UInt32 nextFree{nullProxy};
+        UInt32 pairCount{};
+        bool inserted{};
+        bool removed{};
+    };
+
+    struct Pair
+    {
+        UInt32 first;
+        UInt32 second;
+    };
+
+    struct OverlapEvent
+    {
+        OverlapPair pair;
+        TraceChannelFlagsType firstChannels;
+        TraceChannelFlagsType secondChannels;
+    };
+
+    UInt32 allocateProxy();
+    void freeProxy(UInt32 proxy);
+    void applyRemovals();
+    void appendEndpoints(UInt32 proxy);
+    void sortAxis(int axis);
+    void updateEndpointIndices(int axis);
+    void rebuild();
+    void coalesceEvents();
+
+    [[nodiscard]] bool overlaps(UInt32 a, UInt32 b) const;
+    void updatePair(UInt32 a, UInt32 b);
+    void addPair(UInt32 a, UInt32 b);
+    void removePair(UInt32 a, UInt32 b);
+    [[nodiscard]] OverlapEvent makeEvent(UInt32 a, UInt32 b) const;
+    [[nodiscard]] UInt32 getProxy(Entity entity) const;
+
+    [[nodiscard]] static bool less(const Endpoint& a, const Endpoint& b);
+    [[nodiscard]] static UInt64 makePairKey(UInt32 a, UInt32 b);
+    [[nodiscard]] static bool test(TraceChannelFlagsType channels, TraceChannelFlags channel);
+
+    std::array<std::vector<Endpoint>, 3> m_axes;
+    std::vector<Proxy> m_proxies;
+    std::vector<UInt32> m_entityProxies; // Indexed by entity value
+    std::vector<UInt32> m_pendingInserts;
+    std::vector<UInt32> m_pendingRemoves;
+    UInt32 m_freeList{nullProxy};
+    bool m_moved{};
+
+    std::vector<Pair> m_pairs;
+    std::unordered_map<UInt64, UInt32> m_pairIndices; // Pair key -> index in m_pairs
+
+    std::vector<OverlapEvent> m_beginEvents;
+    std::vector<OverlapEvent> m_endEvents;
+};
+
+template<typename Fn>
+void Broadphase::forEachPair(TraceChannelFlags channel, Fn&& fn) const
+{
+    for (const Pair& pair : m_pairs)
+    {
+        const Proxy& first = m_proxies[pair.first];
+        const Proxy& second = m_proxies[pair.second];
+        if (test(first.channels, channel) && test(second.channels, channel))
+            fn(OverlapPair{first.entity, second.entity});
+    }
+}
+
+template<typename Fn>
+void Broadphase::forEachBeginOverlap(TraceChannelFlags channel, Fn&& fn) const
+{
+    for (const OverlapEvent& event : m_beginEvents)
+    {
+        if (test(event.firstChannels, channel) && test(event.secondChannels, channel))
+            fn(event.pair);
+    }
+}
+
+template<typename Fn>
+void Broadphase::forEachEndOverlap(TraceChannelFlags channel, Fn&& fn) const
+{
+    for (const OverlapEvent& event : m_endEvents)
+    {
+        if (test(event.firstChannels, channel) && test(event.secondChannels, channel))
+            fn(event.pair);
+    }
+}
@@ -0,0 +1,504 @@
+module Physics.SpatialHashGrid;
+
+namespace
+{
+    float distanceSquared(const Vec3& a, const Vec3& b)
+    {
+        const Vec3 d = a - b;
+        return Math::dot(d, d);
+    }
+
+    bool isCloser(const SpatialNeighbor& a, const SpatialNeighbor& b)
+    {
+        return a.distanceSquared < b.distanceSquared;
+    }
+}
+
+void SpatialHashGrid::setCellSize(float cellSize)
+{
+    check(cellSize > 0.f, "[SpatialHashGrid] Cell size must be positive!", ErrorType::FatalError);
+
+    if (cellSize == m_cellSize)
+        return;
+
+    m_cellSize = cellSize;
+    m_inverseCellSize = 1.f / cellSize;
+
+    std::ranges::fill(m_cells, Cell{});
+    m_occupiedCells = 0;
+    m_boundsDirty = false;
+
+    for (UInt32 i = 0; i < m_items.size(); ++i)
+    {
+        m_items[i].cell = getCellCoords(m_items[i].position);
+        link(i);
+    }
+}
+
+void SpatialHashGrid::update(Entity entity, const Vec3& position)
+{
+    const CellCoords cell = getCellCoords(position);
+
+    if (entity.value < m_entityItems.size() && m_entityItems[entity.value] != nullIndex)
+    {
+        const UInt32 index = m_entityItems[entity.value];
+        Item& item = m_items[index];
+        item.position = position;
+
+        if (item.cell != cell)
+        {
+            unlink(index);
+            item.cell = cell;
+            link(index);
+        }
+        return;
+    }
+
+    if (entity.value >= m_entityItems.size())
+        m_entityItems.resize(entity.value + 1, nullIndex);
+
+    const auto index = static_cast<UInt32>(m_items.size());
+    m_items.push_back({.position = position, .cell = cell, .entity = entity});
+    m_entityItems[entity.value] = index;
+    link(index);
+}
+
+void SpatialHashGrid::remove(Entity entity)
+{
+    if (!contains(entity))
+        return;
+
+    const UInt32 index = m_entityItems[entity.value];
+    m_entityItems[entity.value] = nullIndex;
+    unlink(index);
+
+    // Swap-remove, then patch the links pointing at the moved item
+    const auto last = static_cast<UInt32>(m_items.size() - 1);
+    if (index != last)
+    {
+        Item& moved = m_items[index];
+        moved = m_items[last];
+
+        if (moved.previous != nullIndex)
+            m_items[moved.previous].next = index;
+        else
+            m_cells[findSlot(moved.cell)].head = index;
+
+        if (moved.next != nullIndex)
+            m_items[moved.next].previous = index;
+
+        m_entityItems[moved.entity.value] = index;
+    }
+    m_items.pop_back();
+}
+
+void SpatialHashGrid::clear()
+{
+    m_cells.clear();
+    m_occupiedCells = 0;
+    m_boundsDirty = false;
+    m_items.clear();
+    m_entityItems.clear();
+}
+
+bool SpatialHashGrid::contains(Entity entity) const
+{
+    return entity && entity.value < m_entityItems.size() && m_entityItems[entity.value] != nullIndex;
+}
+
+std::span<Entity> SpatialHashGrid::querySphere(const Vec3& center, float radius, std::span<Entity> out) const
+{
+    std::size_t count = 0;
+    if (out.empty())
+        return {};
+
+    const float radiusSquared = radius * radius;
+
+    forEachItemInCells(getCellCoords(center - Vec3{radius}), getCellCoords(center + Vec3{radius}), [&](const Item& item)
+    {
+        if (distanceSquared(item.position, center) <= radiusSquared)
+            out[count++] = item.entity;
+        return count < out.size();
+    });
+
+    return out.first(count);
+}
+
+std::span<Entity> SpatialHashGrid::queryBox(const Aabb& bounds, std::span<Entity> out) const
+{
+    std::size_t count = 0;
+    if (out.empty())
+        return {};
+
+    forEachItemInCells(getCellCoords(bounds.min), getCellCoords(bounds.max), [&](const Item& item)
+    {
+        const Vec3& p = item.position;
+        if (p.x >= bounds.min.x && p.y >= bounds.min.y && p.z >= bounds.min.z
+            && p.x <= bounds.max.x && p.y <= bounds.max.y && p.z <= bounds.max.z)
+        {
+            out[count++] = item.entity;
+        }
+        return count < out.size();
+    });
+
+    return out.first(count);
+}
+
+// Visits growing shells of cells around the point, keeping the best candidates in a max-heap built in the output span,
+// and stops once no cell further out can hold anything closer than the current worst candidate. Once a shell would
+// have more cells than are occupied, the remaining occupied cells are gone through directly instead, so a point far
+// away from every entity never probes the empty space in between.
+std::span<SpatialNeighbor> SpatialHashGrid::queryNearest(const Vec3& point, std::span<SpatialNeighbor> out, float maxRadius) const
+{
+    std::size_t count = 0;
+    if (out.empty() || m_items.empty())
+        return {};
+
+    const float maxRadiusSquared = maxRadius * maxRadius;
+    const CellCoords center = getCellCoords(point);
+    updateOccupiedBounds();
+
+    // Chebyshev distance in cells, which is the shell a cell lies on
+    auto getRing = [&](const CellCoords& coords)
+    {
+        Int64 ring = 0;
+        for (int axis = 0; axis < 3; ++axis)
+            ring = std::max(ring, std::abs(static_cast<Int64>(coords[axis]) - center[axis]));
+        return ring;
+    };
+
+    // No occupied cell lies beyond this ring
+    Int64 maxRing = 0;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        maxRing = std::max(maxRing, static_cast<Int64>(center[axis]) - m_minOccupied[axis]);
+        maxRing = std::max(maxRing, static_cast<Int64>(m_maxOccupied[axis]) - center[axis]);
+    }
+
+    if (maxRadius < std::numeric_limits<float>::max())
+        maxRing = std::min(maxRing, static_cast<Int64>(std::ceil(maxRadius * m_inverseCellSize)) + 1);
+
+    // The point can sit anywhere in its own cell, so a ring is at least ring - 1 cells away
+    auto isOutOfReach = [&](Int64 ring)
+    {
+        if (ring <= 1)
+            return false;
+
+        const float minDistance = static_cast<float>(ring - 1) * m_cellSize;
+        const float minDistanceSquared = minDistance * minDistance;
+        return minDistanceSquared > maxRadiusSquared || (count == out.size() && minDistanceSquared >= out.front().distanceSquared);
+    };
+
+    auto visitCell = [&](const Cell& cell)
+    {
+        for (UInt32 i = cell.head; i != nullIndex; i = m_items[i].next)
+        {
+            const Item& item = m_items[i];
+            const float d = distanceSquared(item.position, point);
+            if (d > maxRadiusSquared)
+                continue;
+
+            if (count < out.size())
+            {
+                out[count++] = {item.entity, d};
+                std::push_heap(out.begin(), out.begin() + count, isCloser);
+            }
+            else if (d < out.front().distanceSquared)
+            {
+                std::pop_heap(out.begin(), out.end(), isCloser);
+                out.back() = {item.entity, d};
+                std::push_heap(out.begin(), out.end(), isCloser);
+            }
+        }
+    };
+
+    for (Int64 ring = 0; ring <= maxRing; ++ring)
+    {
+        if (isOutOfReach(ring))
+            break;
+
+        const UInt64 side = static_cast<UInt64>(2 * ring + 1);
+        const UInt64 shellCells = ring == 0 ? 1 : side * side * side - (side - 2) * (side - 2) * (side - 2);
+
+        if (shellCells > m_occupiedCells)
+        {
+            for (const Cell& cell : m_cells)
+            {
+                if (cell.head == nullIndex)
+                    continue;
+
+                const Int64 cellRing = getRing(cell.coords);
+                if (cellRing >= ring && cellRing <= maxRing && !isOutOfReach(cellRing))
+                    visitCell(cell);
+            }
+            break;
+        }
+
+        const auto r = static_cast<Int32>(ring);
+        for (Int32 x = -r; x <= r; ++x)
+        {
+            for (Int32 y = -r; y <= r; ++y)
+            {
+                // Inner columns of the shell only have their two end cells on it
+                const bool onShell = std::abs(x) == r || std::abs(y) == r;
+                const Int32 step = onShell || r == 0 ? 1 : 2 * r;
+
+                for (Int32 z = -r; z <= r; z += step)
+                {
+                    if (const Cell* cell = findCell({center[0] + x, center[1] + y, center[2] + z}))
+                        visitCell(*cell);
+                }
+            }
+        }
+    }
+
+    std::sort_heap(out.begin(), out.begin() + count, isCloser);
+    return out.first(count);
+}
+
+SpatialHashGrid::CellCoords SpatialHashGrid::getCellCoords(const Vec3& position) const
+{
+    // Clamped before the cast, which is undefined for values an Int32 can't hold. NaN goes to the lowest cell.
+    auto toCell = [&](float coordinate)
+    {
+        const float cell = std::floor(coordinate * m_inverseCellSize);
+        if (!(cell > static_cast<float>(-maxCellCoord)))
+            return -maxCellCoord;
+        if (cell > static_cast<float>(maxCellCoord))
+            return maxCellCoord;
+        return static_cast<Int32>(cell);
+    };
+
+    return {toCell(position.x), toCell(position.y), toCell(position.z)};
+}
+
+std::size_t SpatialHashGrid::getHomeSlot(const CellCoords& coords) const
+{
+    const UInt64 hash = static_cast<UInt64>(static_cast<UInt32>(coords[0])) * 0x9E3779B97F4A7C15ull
+        ^ static_cast<UInt64>(static_cast<UInt32>(coords[1])) * 0xC2B2AE3D27D4EB4Full
+        ^ static_cast<UInt64>(static_cast<UInt32>(coords[2])) * 0x165667B19E3779F9ull;
+    return static_cast<std::size_t>(hash ^ hash >> 32) & (m_cells.size() - 1);
+}
+
+// Slot holding the cell, or the empty slot where it would go. The table is never more than half full.
+std::size_t SpatialHashGrid::findSlot(const CellCoords& coords) const
+{
+    const std::size_t mask = m_cells.size() - 1;
+    std::size_t slot = getHomeSlot(coords);
+
+    while (m_cells[slot].head != nullIndex && m_cells[slot].coords != coords)
+        slot = (slot + 1) & mask;
+
+    return slot;
+}
+
+const SpatialHashGrid::Cell* SpatialHashGrid::findCell(const CellCoords& coords) const
+{
+    if (m_occupiedCells == 0)
+        return nullptr;
+
+    const Cell& cell = m_cells[findSlot(coords)];
+    return cell.head != nullIndex ? &cell : nullptr;
+}
+
+void SpatialHashGrid::link(UInt32 index)
+{
+    Item& item = m_items[index];
+
+    if ((m_occupiedCells + 1) * 2 > m_cells.size())
+        rehash(std::max(minTableSize, m_cells.size() * 2));
+
+    Cell& cell = m_cells[findSlot(item.cell)];
+
+    if (cell.head == nullIndex)
+    {
+        cell.coords = item.cell;
+        cell.count = 0;
+
+        if (m_occupiedCells == 0)
+        {
+            m_minOccupied = item.cell;
+            m_maxOccupied = item.cell;
+            m_boundsDirty = false;
+        }
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            m_minOccupied[axis] = std::min(m_minOccupied[axis], item.cell[axis]);
+            m_maxOccupied[axis] = std::max(m_maxOccupied[axis], item.cell[axis]);
+        }
+        ++m_occupiedCells;
+    }
+    else
+    {
+        m_items[cell.head].previous = index;
+    }
+
+    item.next = cell.head;
+    item.previous = nullIndex;
+    cell.head = index;
+    ++cell.count;
+}
+
+void SpatialHashGrid::unlink(UInt32 index)
+{
+    const Item& item = m_items[index];
+    const std::size_t slot = findSlot(item.cell);
+    Cell& cell = m_cells[slot];
+
+    if (item.previous != nullIndex)
+        m_items[item.previous].next = item.next;
+    else
+        cell.head = item.next;
+
+    if (item.next != nullIndex)
+        m_items[item.next].previous = item.previous;
+
+    if (--cell.count == 0)
+    {
+        const CellCoords coords = cell.coords;
+        eraseSlot(slot);
+        --m_occupiedCells;
+
+        // The bounds only shrink when the cell was on one of their faces
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (coords[axis] == m_minOccupied[axis] || coords[axis] == m_maxOccupied[axis])
+            {
+                m_boundsDirty.store(true, std::memory_order_relaxed);
+                break;
+            }
+        }
+    }
+}
+
+// Queries may run on several threads at once, the first one to find the bounds dirty recomputes them
+void SpatialHashGrid::updateOccupiedBounds() const
+{
+    if (!m_boundsDirty.load(std::memory_order_acquire))
+        return;
+
+    std::lock_guard lock{m_boundsMutex};
+    if (!m_boundsDirty.load(std::memory_order_relaxed))
+        return;
+
+    bool first = true;
+
+    for (const Cell& cell : m_cells)
+    {
+        if (cell.head == nullIndex)
+            continue;
+
+        if (first)
+        {
+            m_minOccupied = cell.coords;
+            m_maxOccupied = cell.coords;
+            first = false;
+            continue;
+        }
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            m_minOccupied[axis] = std::min(m_minOccupied[axis], cell.coords[axis]);
+            m_maxOccupied[axis] = std::max(m_maxOccupied[axis], cell.coords[axis]);
+        }
+    }
+
+    m_boundsDirty.store(false, std::memory_order_release);
+}
+
+// Backward-shift deletion: pulls later cells of the probe sequence back so no tombstones are needed.
+void SpatialHashGrid::eraseSlot(std::size_t slot)
+{
+    const std::size_t mask = m_cells.size() - 1;
+    std::size_t next = slot;
+
+    while (true)
+    {
+        next = (next + 1) & mask;
+        if (m_cells[next].head == nullIndex)
+            break;
+
+        // Only move the cell back if its home slot isn't in (slot, next]
+        const std::size_t home = getHomeSlot(m_cells[next].coords);
+        const bool homeInRange = slot <= next ? slot < home && home <= next : slot < home || home <= next;
+        if (!homeInRange)
+        {
+            m_cells[slot] = m_cells[next];
+            slot = next;
+        }
+    }
+
+    m_cells[slot] = Cell{};
+}
+
+void SpatialHashGrid::rehash(std::size_t tableSize)
+{
+    std::vector<Cell> cells = std::exchange(m_cells, std::vector<Cell>(tableSize));
+
+    for (const Cell& cell : cells)
+    {
+        if (cell.head != nullIndex)
+            m_cells[findSlot(cell.coords)] = cell;
+    }
+}
+
+template<typename Fn>
+void SpatialHashGrid::forEachItemInCells(const CellCoords& minCell, const CellCoords& maxCell, Fn&& fn) const
+{
+    if (m_occupiedCells == 0)
+        return;
+
+    updateOccupiedBounds();
+
+    CellCoords from;
+    CellCoords to;
+    UInt64 cellCount = 1;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        from[axis] = std::max(minCell[axis], m_minOccupied[axis]);
+        to[axis] = std::min(maxCell[axis], m_maxOccupied[axis]);
+        if (from[axis] > to[axis])
+            return;
+        cellCount *= static_cast<UInt64>(to[axis] - from[axis] + 1);
+    }
+
+    auto visit = [&](const Cell& cell)
+    {
+        for (UInt32 i = cell.head; i != nullIndex; i = m_items[i].next)
+        {
+            if (!fn(m_items[i]))
+                return false;
+        }
+        return true;
+    };
+
+    if (cellCount > m_occupiedCells)
+    {
+        for (const Cell& cell : m_cells)
+        {
+            if (cell.head == nullIndex)
+                continue;
+
+            const CellCoords& c = cell.coords;
+            if (c[0] < from[0] || c[1] < from[1] || c[2] < from[2] || c[0] > to[0] || c[1] > to[1] || c[2] > to[2])
+                continue;
+
+            if (!visit(cell))
+                return;
+        }
+        return;
+    }
+
+    for (Int32 x = from[0]; x <= to[0]; ++x)
+    {
+        for (Int32 y = from[1]; y <= to[1]; ++y)
+        {
+            for (Int32 z = from[2]; z <= to[2]; ++z)
+            {
+                if (const Cell* cell = findCell({x, y, z}); cell && !visit(*cell))
+                    return;
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+export module Physics.SpatialHashGrid;
+import Core;
+import Math;
+import Physics;
+
+export struct SpatialNeighbor
+{
+    Entity entity{};
+    float distanceSquared{};
+};
+
+// Uniform grid bucketing entities by a single point, their world AABB center.
+// Occupied cells live in an open-addressed (linear probing) table keyed by cell coordinates, and the entities of a cell
+// form an intrusive list through a dense item array, so moving an entity between cells never allocates. Queries write
+// into caller-provided spans and return the part that was filled.
+export class SpatialHashGrid
+{
+public:
+    static constexpr float defaultCellSize = 4.f;
+
+    // Re-buckets every entity if the size changes. Cells should be around the typical query radius.
+    void setCellSize(float cellSize);
+    [[nodiscard]] float getCellSize() const { return m_cellSize; }
+
+    void update(Entity entity, const Vec3& position);
+    void remove(Entity entity);
+    void clear();
+
+    [[nodiscard]] bool contains(Entity entity) const;
+    [[nodiscard]] std::size_t size() const { return m_items.size(); }
+
+    // Entities within radius of center. Stops early once out is full.
+    std::span<Entity> querySphere(const Vec3& center, float radius, std::span<Entity> out) const;
+
+    // Entities whose position lies inside the box. Stops early once out is full.
+    std::span<Entity> queryBox(const Aabb& bounds, std::span<Entity> out) const;
+
+    // The out.size() entities closest to point and within maxRadius, sorted by distance.
+    std::span<SpatialNeighbor> queryNearest(const Vec3& point, std::span<SpatialNeighbor> out, float maxRadius = std::numeric_limits<float>::max()) const;
+
+private:
+    static constexpr UInt32 nullIndex = std::numeric_limits<UInt32>::max();
+    static constexpr std::size_t minTableSize = 64;
+    static constexpr Int32 maxCellCoord = 1 << 29; // Far positions are clamped, so spans of cells still fit in an Int32
+
+    using CellCoords = std::array<Int32, 3>;
+
+    struct Cell
+    {
+        CellCoords coords{};
+        UInt32 head{nullIndex}; // nullIndex marks an empty slot
+        UInt32 count{};
+    };
+
+    struct Item
+    {
+        Vec3 position{};
+        CellCoords cell{};
+        Entity entity{};
+        UInt32 next{nullIndex};
+        UInt32 previous{nullIndex};
+    };
+
+    [[nodiscard]] CellCoords getCellCoords(const Vec3& position) const;
+    [[nodiscard]] std::size_t getHomeSlot(const CellCoords& coords) const;
+    [[nodiscard]] std::size_t findSlot(const CellCoords& coords) const;
+    [[nodiscard]] const Cell* findCell(const CellCoords& coords) const;
+
+    void link(UInt32 item);
+    void unlink(UInt32 item);
+    void eraseSlot(std::size_t slot);
+    void updateOccupiedBounds() const;
+    void rehash(std::size_t tableSize);
+
+    // Calls fn(const Item&) for every item in the cells overlapping [minCell, maxCell], going through the occupied
+    // cells instead when that is the smaller set. Stops as soon as fn returns false.
+    template<typename Fn>
+    void forEachItemInCells(const CellCoords& minCell, const CellCoords& maxCell, Fn&& fn) const;
+
+    float m_cellSize{defaultCellSize};
+    float m_inverseCellSize{1.f / defaultCellSize};
+
+    std::vector<Cell> m_cells;
+    std::size_t m_occupiedCells{};
+
+    std::vector<Item> m_items;
+    std::vector<UInt32> m_entityItems; // Indexed by entity value
+
+    // Around the occupied cells, so far away queries are clipped to them. Emptying a cell on their faces only marks
+    // them dirty, they still hold every occupied cell and the next query shrinks them again.
+    mutable CellCoords m_minOccupied{};
+    mutable CellCoords m_maxOccupied{};
+    mutable std::atomic<bool> m_boundsDirty{};
+    mutable std::mutex m_boundsMutex;
+};
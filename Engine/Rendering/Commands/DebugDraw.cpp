@@ -0,0 +1,147 @@
+module Render.DebugDraw;
+import Render.Commands;
+
+namespace
+{
+    struct Batch
+    {
+        std::vector<LineVertex> vertices;
+        bool sentLines{}; // Whether the last flush sent any, so they get cleared when nothing was drawn since
+    };
+
+    constexpr UInt32 circleSegments = 32;
+
+    std::mutex mutex;
+    std::unordered_map<WorldHandle, Batch> batches;
+
+    // Corner i takes the max of each axis whose bit is set in i, so the edges join corners one bit apart
+    void appendCorners(std::vector<LineVertex>& vertices, const std::array<Vec3, 8>& corners, const Vec4& color)
+    {
+        for (UInt32 corner = 0; corner < 8; ++corner)
+        {
+            for (const UInt32 axis : {1u, 2u, 4u})
+            {
+                if (corner & axis)
+                    continue;
+
+                vertices.push_back({corners[corner], color});
+                vertices.push_back({corners[corner | axis], color});
+            }
+        }
+    }
+
+    void append(WorldHandle world, std::span<const LineVertex> vertices)
+    {
+        std::lock_guard lock{mutex};
+        std::vector<LineVertex>& batch = batches[world].vertices;
+        batch.insert(batch.end(), vertices.begin(), vertices.end());
+    }
+}
+
+void DebugDraw::line(WorldHandle world, const Vec3& from, const Vec3& to, const Vec4& color)
+{
+    const std::array vertices{LineVertex{from, color}, LineVertex{to, color}};
+    append(world, vertices);
+}
+
+void DebugDraw::lines(WorldHandle world, std::span<const LineVertex> vertices)
+{
+    check(vertices.size() % 2 == 0, "[DebugDraw] Lines need an even number of vertices!", ErrorType::Warning);
+    append(world, vertices.first(vertices.size() & ~std::size_t{1}));
+}
+
+void DebugDraw::box(WorldHandle world, const Vec3& center, const Vec3& extents, const Vec4& color)
+{
+    box(world, center - extents, center + extents, Mat4{1}, color);
+}
+
+void DebugDraw::box(WorldHandle world, const Vec3& localMin, const Vec3& localMax, const Mat4& transform, const Vec4& color)
+{
+    std::array<Vec3, 8> corners;
+    for (UInt32 corner = 0; corner < 8; ++corner)
+    {
+        const Vec3 local{corner & 1 ? localMax.x : localMin.x, corner & 2 ? localMax.y : localMin.y, corner & 4 ? localMax.z : localMin.z};
+        corners[corner] = Vec3{transform * Vec4{local, 1.f}};
+    }
+
+    std::vector<LineVertex> vertices;
+    vertices.reserve(24);
+    appendCorners(vertices, corners, color);
+    append(world, vertices);
+}
+
+void DebugDraw::sphere(WorldHandle world, const Vec3& center, float radius, const Vec4& color)
+{
+    static constexpr std::array<std::pair<Vec3, Vec3>, 3> planes
+    {{
+        {{1, 0, 0}, {0, 1, 0}},
+        {{0, 1, 0}, {0, 0, 1}},
+        {{0, 0, 1}, {1, 0, 0}},
+    }};
+
+    std::vector<LineVertex> vertices;
+    vertices.reserve(planes.size() * circleSegments * 2);
+
+    for (const auto& [u, v] : planes)
+    {
+        auto pointAt = [&](UInt32 segment)
+        {
+            const float angle = 2.f * Math::pi<float>() * static_cast<float>(segment) / static_cast<float>(circleSegments);
+            return center + radius * (Math::cos(angle) * u + Math::sin(angle) * v);
+        };
+
+        for (UInt32 segment = 0; segment < circleSegments; ++segment)
+        {
+            vertices.push_back({pointAt(segment), color});
+            vertices.push_back({pointAt(segment + 1), color});
+        }
+    }
+
+    append(world, vertices);
+}
+
+// Unprojects the corners of the NDC cube, whose depth runs from 0 to 1
+void DebugDraw::frustum(WorldHandle world, const Mat4& viewProjection, const Vec4& color)
+{
+    const Mat4 inverse = Math::inverse(viewProjection);
+
+    std::array<Vec3, 8> corners;
+    for (UInt32 corner = 0; corner < 8; ++corner)
+    {
+        const Vec4 point = inverse * Vec4{corner & 1 ? 1.f : -1.f, corner & 2 ? 1.f : -1.f, corner & 4 ? 1.f : 0.f, 1.f};
+        corners[corner] = Vec3{point} / point.w;
+    }
+
+    std::vector<LineVertex> vertices;
+    vertices.reserve(24);
+    appendCorners(vertices, corners, color);
+    append(world, vertices);
+}
+
+void DebugDraw::removeWorld(WorldHandle world)
+{
+    std::lock_guard lock{mutex};
+    batches.erase(world);
+}
+
+void DebugDraw::flush(RenderCommandQueue& queue)
+{
+    std::lock_guard lock{mutex};
+
+    for (auto it = batches.begin(); it != batches.end();)
+    {
+        auto& [world, batch] = *it;
+        const bool hasLines = !batch.vertices.empty();
+
+        if (hasLines || batch.sentLines)
+            queue.addCommand(RenderCommands::SetDebugLines{.world = world, .vertices = std::move(batch.vertices)});
+
+        batch.vertices = {};
+        batch.sentLines = hasLines;
+
+        if (!hasLines)
+            it = batches.erase(it);
+        else
+            ++it;
+    }
+}
@@ -0,0 +1,43 @@
+module;
+
+#include "EngineExport.h"
+
+export module Render.DebugDraw;
+import Assets.Mesh;
+import Core;
+import Math;
+import Render.CommandProcessor;
+import WorldHandle;
+
+// Immediate-mode debug lines in world space. Shapes are appended from any thread during the frame and sent to the
+// render thread as one batch per world when the frame is published, where each batch is drawn in a single call.
+// Lines only last one frame, so they have to be added again every frame they should stay visible.
+export namespace DebugDraw
+{
+    ENGINE_API
+    void line(WorldHandle world, const Vec3& from, const Vec3& to, const Vec4& color = Vec4{1});
+
+    ENGINE_API
+    void lines(WorldHandle world, std::span<const LineVertex> vertices); // Pairs of vertices
+
+    ENGINE_API
+    void box(WorldHandle world, const Vec3& center, const Vec3& extents, const Vec4& color = Vec4{1});
+
+    ENGINE_API
+    void box(WorldHandle world, const Vec3& localMin, const Vec3& localMax, const Mat4& transform, const Vec4& color = Vec4{1});
+
+    // Three circles, one around each axis
+    ENGINE_API
+    void sphere(WorldHandle world, const Vec3& center, float radius, const Vec4& color = Vec4{1});
+
+    // The volume a camera sees, given its view projection matrix
+    ENGINE_API
+    void frustum(WorldHandle world, const Mat4& viewProjection, const Vec4& color = Vec4{1});
+
+    // Drops the world's batch, so nothing is sent for it once the render thread has removed it
+    ENGINE_API
+    void removeWorld(WorldHandle world);
+
+    // Sends every world's batch. Worlds that drew last frame but not this one get an empty batch, clearing their lines.
+    void flush(RenderCommandQueue& queue);
+}
@@ -1,15 +1,65 @@
 module Render.CommandProcessor;
 
+namespace
+{
+    using CommandFunction = void(*)(RenderCommandProcessor&, std::byte*);
+
+    template<typename T>
+    T& getCommand(std::byte* storage)
+    {
+        return *std::launder(reinterpret_cast<T*>(storage));
+    }
+
+    template<typename T>
+    void processCommand(RenderCommandProcessor& processor, std::byte* storage)
+    {
+        T& command = getCommand<T>(storage);
+        processor.process(std::move(command));
+        command.~T();
+    }
+
+    template<typename T>
+    void destroyCommand(RenderCommandProcessor&, std::byte* storage)
+    {
+        getCommand<T>(storage).~T();
+    }
+
+    template<typename... Commands>
+    constexpr std::array<CommandFunction, sizeof...(Commands)> makeProcessTable(std::type_identity<std::tuple<Commands...>>)
+    {
+        return {&processCommand<Commands>...};
+    }
+
+    template<typename... Commands>
+    constexpr std::array<CommandFunction, sizeof...(Commands)> makeDestroyTable(std::type_identity<std::tuple<Commands...>>)
+    {
+        return {&destroyCommand<Commands>...};
+    }
+
+    constexpr auto processTable = makeProcessTable(std::type_identity<RenderCommandTypes>{});
+}
+
 RenderCommandQueue::RenderCommandQueue(RenderCommandProcessor& processor)
     : m_processor{processor}
 {
 }
 
+RenderCommandQueue::~RenderCommandQueue()
+{
+    // Commands that never reached the render thread still own resources
+    constexpr auto destroyTable = makeDestroyTable(std::type_identity<RenderCommandTypes>{});
+
+    m_commands.publish();
+    m_commands.consume([this](UInt32 tag, std::byte* storage) { destroyTable[tag](m_processor, storage); });
+}
+
+void RenderCommandQueue::publish()
+{
+    m_producerThread.assertThread();
+    m_commands.publish();
+}
+
 void RenderCommandProcessor::processAll()
 {
-    std::unique_ptr<RenderCommandBase> cmd;
-    while (m_queue.m_commands.tryPop(cmd))
-    {
-        cmd->process();
-    }
+    m_queue.m_commands.consume([this](UInt32 tag, std::byte* storage) { processTable[tag](*this, storage); });
 }
@@ -3,35 +3,58 @@ import Core;
 import Log;
 import Render.Commands;
 import Render.RenderWorld;
-import ThreadSafeQueue;
+import SpscByteRing;
+import Thread;
 
 export class RenderCommandProcessor;
 
-class RenderCommandBase
-{
-public:
-    RenderCommandBase() = default;
-    virtual ~RenderCommandBase() = default;
-    RenderCommandBase(const RenderCommandBase&) = default;
-    RenderCommandBase& operator=(const RenderCommandBase&) = default;
-    RenderCommandBase(RenderCommandBase&&) = default;
-    RenderCommandBase& operator=(RenderCommandBase&&) = default;
-
-    virtual void process() = 0;
+// Every command the queue accepts. A command's index in the list is the tag stored with it in the ring.
+using RenderCommandTypes = std::tuple<
+    RenderCommands::AddWorld,
+    RenderCommands::RemoveWorld,
+    RenderCommands::AddObject,
+    RenderCommands::RemoveObject,
+    RenderCommands::AddLineObject,
+    RenderCommands::RemoveLineObject,
+    RenderCommands::SetDebugLines,
+    RenderCommands::SetTransform,
+    RenderCommands::SetTransforms,
+    RenderCommands::SetObjectVisibility,
+    RenderCommands::ClearRenderObjects,
+    RenderCommands::SetCamera>;
+
+template<typename T, typename List>
+struct RenderCommandTag;
+
+template<typename T, typename... Commands>
+struct RenderCommandTag<T, std::tuple<Commands...>>
+{
+    static constexpr std::array matches{std::same_as<T, Commands>...};
+    static constexpr std::size_t value = std::ranges::find(matches, true) - matches.begin();
 };
 
+// Commands are constructed in place in a single-producer/single-consumer ring: the simulation thread adds them and
+// publishes once per frame, and the render thread drains them in order without locking or allocating.
 export class RenderCommandQueue
 {
 public:
+    RenderCommandQueue(const RenderCommandQueue&) = delete;
+    RenderCommandQueue& operator=(const RenderCommandQueue&) = delete;
+    ~RenderCommandQueue();
+
     template<typename T>
     void addCommand(T&& command);
 
+    // Makes the commands added so far visible to the render thread.
+    void publish();
+
 private:
     friend class RenderCommandProcessor;
     explicit RenderCommandQueue(RenderCommandProcessor& processor);
 
     RenderCommandProcessor& m_processor;
-    ThreadSafeQueue<std::unique_ptr<RenderCommandBase>> m_commands;
+    SpscByteRing m_commands;
+    ThreadOwned m_producerThread;
 };
 
 struct RenderCommandProcessorContext
@@ -56,23 +79,17 @@ private:
     RenderCommandProcessorContext m_context;
 };
 
-template <typename T>
-class RenderCommand final : public RenderCommandBase
-{
-public:
-    RenderCommand(RenderCommandProcessor& processor, T&& data) : m_processor{processor}, m_data{std::forward<T>(data)} {}
-
-    void process() override { m_processor.process(std::forward<T>(m_data)); }
-
-private:
-    RenderCommandProcessor& m_processor;
-    T m_data;
-};
-
 template<typename T>
 void RenderCommandQueue::addCommand(T&& command)
 {
-    m_commands.push(std::make_unique<RenderCommand<T>>(m_processor, std::forward<T>(command)));
+    using Command = std::remove_cvref_t<T>;
+    constexpr std::size_t tag = RenderCommandTag<Command, RenderCommandTypes>::value;
+
+    static_assert(tag < std::tuple_size_v<RenderCommandTypes>, "Command is missing from RenderCommandTypes");
+    static_assert(alignof(Command) <= SpscByteRing::alignment);
+
+    std::byte* storage = m_commands.allocate(sizeof(Command), static_cast<UInt32>(tag));
+    new (storage) Command{std::forward<T>(command)};
 }
 
 template<>
@@ -90,7 +107,7 @@ void RenderCommandProcessor::process(RenderCommands::RemoveWorld&& cmd)
 template<>
 void RenderCommandProcessor::process(RenderCommands::AddObject&& cmd)
 {
-    m_context.renderWorldManager.getObjectManager(cmd.world).addRenderObject(cmd.entity, cmd.mesh, cmd.texture, std::move(cmd.worldTransform), cmd.layer, cmd.tint);
+    m_context.renderWorldManager.getObjectManager(cmd.world).addRenderObject(cmd.entity, cmd.mesh, cmd.texture, std::move(cmd.worldTransform), cmd.layer, cmd.tint, cmd.occluder);
 }
 
 template<>
@@ -111,12 +128,24 @@ void RenderCommandProcessor::process(RenderCommands::RemoveLineObject&& cmd)
     m_context.renderWorldManager.getObjectManager(cmd.world).removeLineRenderObject(cmd.entity);
 }
 
+template<>
+void RenderCommandProcessor::process(RenderCommands::SetDebugLines&& cmd)
+{
+    m_context.renderWorldManager.getObjectManager(cmd.world).setDebugLines(std::move(cmd.vertices));
+}
+
 template<>
 void RenderCommandProcessor::process(RenderCommands::SetTransform&& cmd)
 {
     m_context.renderWorldManager.getObjectManager(cmd.world).setObjectTransform(cmd.entity, cmd.worldTransform);
 }
 
+template<>
+void RenderCommandProcessor::process(RenderCommands::SetTransforms&& cmd)
+{
+    m_context.renderWorldManager.getObjectManager(cmd.world).setObjectTransforms(cmd.transforms);
+}
+
 template<>
 void RenderCommandProcessor::process(RenderCommands::SetObjectVisibility&& cmd)
 {
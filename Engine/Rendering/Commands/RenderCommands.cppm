@@ -29,6 +29,7 @@ export namespace RenderCommands
         Mat4 worldTransform{1};
         RenderLayer layer{RenderLayer::World};
         Vec4 tint{1};
+        bool occluder{};
     };
 
     struct RemoveObject
@@ -52,6 +53,13 @@ export namespace RenderCommands
         Entity entity;
     };
 
+    // Immediate-mode lines gathered by DebugDraw during the frame, replacing the previous frame's
+    struct SetDebugLines
+    {
+        WorldHandle world;
+        std::vector<LineVertex> vertices;
+    };
+
     struct SetObjectVisibility
     {
         WorldHandle world;
@@ -66,6 +74,19 @@ export namespace RenderCommands
         Mat4 worldTransform;
     };
 
+    struct ObjectTransform
+    {
+        Entity entity;
+        Mat4 worldTransform;
+    };
+
+    // Every transform of a world that changed this frame, in one contiguous array
+    struct SetTransforms
+    {
+        WorldHandle world;
+        std::vector<ObjectTransform> transforms;
+    };
+
     struct ClearRenderObjects
     {
         WorldHandle world;
@@ -0,0 +1,360 @@
+module Render.Graph;
+import Render.DeletionQueue;
+import Render.TextureLoading;
+
+namespace
+{
+    struct UsageInfo
+    {
+        vk::ImageLayout layout{};
+        vk::PipelineStageFlags stages{};
+        vk::AccessFlags access{};
+        vk::AccessFlags writeAccess{}; // The part of the access that writes
+    };
+
+    constexpr UsageInfo getUsageInfo(ImageUsage usage)
+    {
+        switch (usage)
+        {
+        case ImageUsage::ColorAttachment:
+            return {
+                .layout = vk::ImageLayout::eColorAttachmentOptimal,
+                .stages = vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                .access = vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite,
+                .writeAccess = vk::AccessFlagBits::eColorAttachmentWrite,
+            };
+        case ImageUsage::DepthAttachment:
+            return {
+                .layout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+                .stages = vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+                .access = vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+                .writeAccess = vk::AccessFlagBits::eDepthStencilAttachmentWrite,
+            };
+        case ImageUsage::TransferSrc:
+            return {
+                .layout = vk::ImageLayout::eTransferSrcOptimal,
+                .stages = vk::PipelineStageFlagBits::eTransfer,
+                .access = vk::AccessFlagBits::eTransferRead,
+            };
+        case ImageUsage::TransferDst:
+            return {
+                .layout = vk::ImageLayout::eTransferDstOptimal,
+                .stages = vk::PipelineStageFlagBits::eTransfer,
+                .access = vk::AccessFlagBits::eTransferWrite,
+                .writeAccess = vk::AccessFlagBits::eTransferWrite,
+            };
+        case ImageUsage::Present:
+            return {
+                .layout = vk::ImageLayout::ePresentSrcKHR,
+                .stages = vk::PipelineStageFlagBits::eBottomOfPipe,
+            };
+        }
+
+        std::unreachable();
+    }
+
+    bool lifetimesOverlap(UInt32 firstA, UInt32 lastA, UInt32 firstB, UInt32 lastB)
+    {
+        return firstA <= lastB && firstB <= lastA;
+    }
+
+    vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+void RenderGraph::shutdown()
+{
+    releaseTransients();
+    reset();
+}
+
+void RenderGraph::reset()
+{
+    m_images.clear();
+    m_passes.clear();
+    m_transients.clear();
+}
+
+RenderGraphImage RenderGraph::importImage(vk::Image image, vk::ImageView view, vk::ImageAspectFlags aspect, ImageState& state)
+{
+    m_images.push_back({.image = image, .view = view, .aspect = aspect, .imported = &state});
+    return {static_cast<UInt32>(m_images.size() - 1)};
+}
+
+RenderGraphImage RenderGraph::createTransient(const TransientImageInfo& info)
+{
+    m_images.push_back({.aspect = info.aspect, .transient = static_cast<UInt32>(m_transients.size())});
+    m_transients.push_back({.info = info});
+    return {static_cast<UInt32>(m_images.size() - 1)};
+}
+
+void RenderGraph::addPass(std::string name, std::vector<ImageAccess> images, Execute execute)
+{
+    m_passes.push_back({.name = std::move(name), .images = std::move(images), .execute = std::move(execute)});
+}
+
+vk::Image RenderGraph::getImage(RenderGraphImage image) const
+{
+    const ImageEntry& entry = m_images[image.index];
+    return entry.transient ? m_transientImages[*entry.transient].image : entry.image;
+}
+
+vk::ImageView RenderGraph::getView(RenderGraphImage image) const
+{
+    const ImageEntry& entry = m_images[image.index];
+    return entry.transient ? m_transientImages[*entry.transient].view : entry.view;
+}
+
+void RenderGraph::execute(vk::CommandBuffer commandBuffer)
+{
+    allocateTransients();
+
+    for (ImageEntry& entry : m_images)
+    {
+        if (entry.imported)
+            entry.state = *entry.imported;
+    }
+
+    m_stats.passes.resize(m_passes.size());
+    m_stats.barriers = 0;
+    m_stats.barrierBatches = 0;
+
+    for (std::size_t i = 0; i < m_passes.size(); ++i)
+    {
+        const Pass& pass = m_passes[i];
+        RenderGraphPassStats& passStats = m_stats.passes[i];
+        passStats.name = pass.name;
+
+        recordBarriers(commandBuffer, pass, passStats);
+
+        if (pass.execute)
+            pass.execute(commandBuffer, *this);
+    }
+
+    for (const ImageEntry& entry : m_images)
+    {
+        if (entry.imported)
+            *entry.imported = entry.state;
+    }
+}
+
+void RenderGraph::recordBarriers(vk::CommandBuffer commandBuffer, const Pass& pass, RenderGraphPassStats& stats)
+{
+    m_barriers.clear();
+    vk::PipelineStageFlags srcStages{};
+    vk::PipelineStageFlags dstStages{};
+
+    for (const auto [image, imageUsage] : pass.images)
+    {
+        ImageEntry& entry = m_images[image.index];
+        ImageState& state = entry.state;
+        const UsageInfo usage = getUsageInfo(imageUsage);
+
+        // Transient memory may have held any other transient image, starting out undefined after waiting for them all
+        if (entry.transient && !entry.used)
+            state = {.stages = m_transientStages, .writeAccess = m_transientWrites};
+
+        entry.used = true;
+
+        if (entry.transient)
+        {
+            m_transientStages |= usage.stages;
+            m_transientWrites |= usage.writeAccess;
+        }
+
+        const bool changesLayout = state.layout != usage.layout;
+        const bool writes = static_cast<bool>(usage.writeAccess);
+        const bool readsUnseenWrite = state.writeAccess && (state.visibleTo & usage.stages) != usage.stages;
+
+        // Reads after reads, and reads of a write that's already visible to them, need nothing
+        if (!changesLayout && !writes && !readsUnseenWrite)
+        {
+            state.stages |= usage.stages;
+            continue;
+        }
+
+        m_barriers.push_back(vk::ImageMemoryBarrier
+        {
+            .srcAccessMask = state.writeAccess,
+            .dstAccessMask = usage.access,
+            .oldLayout = state.layout,
+            .newLayout = usage.layout,
+            .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+            .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+            .image = getImage(image),
+            .subresourceRange =
+            {
+                .aspectMask = entry.aspect,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1,
+            }
+        });
+
+        srcStages |= state.stages ? state.stages : vk::PipelineStageFlagBits::eTopOfPipe;
+        dstStages |= usage.stages;
+
+        state = writes
+            ? ImageState{.layout = usage.layout, .stages = usage.stages, .writeAccess = usage.writeAccess}
+            : ImageState{.layout = usage.layout, .stages = usage.stages, .writeAccess = state.writeAccess, .visibleTo = state.visibleTo | usage.stages};
+    }
+
+    stats.barriers = static_cast<UInt32>(m_barriers.size());
+    if (m_barriers.empty())
+        return;
+
+    commandBuffer.pipelineBarrier(srcStages, dstStages, {}, nullptr, nullptr, m_barriers);
+
+    m_stats.barriers += stats.barriers;
+    ++m_stats.barrierBatches;
+}
+
+void RenderGraph::allocateTransients()
+{
+    for (UInt32 passIndex = 0; passIndex < m_passes.size(); ++passIndex)
+    {
+        for (const ImageAccess& access : m_passes[passIndex].images)
+        {
+            const std::optional<UInt32> transientIndex = m_images[access.image.index].transient;
+            if (!transientIndex)
+                continue;
+
+            Transient& transient = m_transients[*transientIndex];
+            if (std::exchange(m_images[access.image.index].used, true))
+            {
+                transient.lastPass = passIndex;
+            }
+            else
+            {
+                transient.firstPass = passIndex;
+                transient.lastPass = passIndex;
+            }
+        }
+    }
+
+    for (ImageEntry& entry : m_images)
+        entry.used = false;
+
+    if (m_transients == m_allocatedTransients)
+        return;
+
+    releaseTransients();
+
+    if (m_transients.empty())
+        return;
+
+    const vk::Device device = context().device;
+
+    vk::MemoryRequirements heapRequirements{.alignment = 1, .memoryTypeBits = ~0u};
+    std::vector<vk::MemoryRequirements> requirements;
+    requirements.reserve(m_transients.size());
+
+    for (const Transient& transient : m_transients)
+    {
+        const vk::ImageCreateInfo imageInfo
+        {
+            .imageType = vk::ImageType::e2D,
+            .format = transient.info.format,
+            .extent = {.width = transient.info.extent.width, .height = transient.info.extent.height, .depth = 1},
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = vk::SampleCountFlagBits::e1,
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = transient.info.usage,
+            .sharingMode = vk::SharingMode::eExclusive,
+            .initialLayout = vk::ImageLayout::eUndefined,
+        };
+
+        const vk::Image image = device.createImage(imageInfo);
+        if (!image)
+        {
+            fatalError("failed to create transient image!");
+        }
+
+        m_transientImages.push_back({.image = image});
+        requirements.push_back(device.getImageMemoryRequirements(image));
+
+        heapRequirements.alignment = std::max(heapRequirements.alignment, requirements.back().alignment);
+        heapRequirements.memoryTypeBits &= requirements.back().memoryTypeBits;
+    }
+
+    check(heapRequirements.memoryTypeBits != 0, "[RenderGraph] Transient images share no memory type!", ErrorType::FatalError);
+
+    // Largest first, each at the lowest offset clear of every image placed so far that's alive in the same passes
+    std::vector<std::size_t> order(m_transients.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::stable_sort(order, std::greater{}, [&](std::size_t i) { return requirements[i].size; });
+
+    std::vector<std::size_t> placed;
+    placed.reserve(order.size());
+
+    m_stats.unaliasedBytes = 0;
+
+    for (const std::size_t i : order)
+    {
+        const Transient& transient = m_transients[i];
+        TransientImage& image = m_transientImages[i];
+        image.size = requirements[i].size;
+        m_stats.unaliasedBytes += image.size;
+
+        for (bool moved = true; moved;)
+        {
+            moved = false;
+            for (const std::size_t j : placed)
+            {
+                const Transient& other = m_transients[j];
+                const TransientImage& otherImage = m_transientImages[j];
+
+                if (lifetimesOverlap(transient.firstPass, transient.lastPass, other.firstPass, other.lastPass)
+                    && image.offset < otherImage.offset + otherImage.size && otherImage.offset < image.offset + image.size)
+                {
+                    image.offset = alignUp(otherImage.offset + otherImage.size, requirements[i].alignment);
+                    moved = true;
+                }
+            }
+        }
+
+        heapRequirements.size = std::max(heapRequirements.size, image.offset + image.size);
+        placed.push_back(i);
+    }
+
+    m_transientMemory = context().allocator->allocate(heapRequirements, vk::MemoryPropertyFlagBits::eDeviceLocal, ResourceKind::Image);
+    m_stats.transientBytes = heapRequirements.size;
+
+    for (std::size_t i = 0; i < m_transients.size(); ++i)
+    {
+        TransientImage& image = m_transientImages[i];
+        device.bindImageMemory(image.image, m_transientMemory.memory, m_transientMemory.offset + image.offset);
+        image.view = RenderUtils::createImageView(device, image.image, m_transients[i].info.format, m_transients[i].info.aspect);
+    }
+
+    m_allocatedTransients = m_transients;
+}
+
+// Frames in flight may still use the images
+void RenderGraph::releaseTransients()
+{
+    if (!m_transientImages.empty() || m_transientMemory)
+    {
+        context().deletionQueue->push([device = context().device, allocator = context().allocator, images = std::move(m_transientImages), memory = m_transientMemory]() mutable
+        {
+            for (const TransientImage& image : images)
+            {
+                device.destroyImageView(image.view);
+                device.destroyImage(image.image);
+            }
+
+            if (memory)
+                allocator->free(memory);
+        });
+    }
+
+    m_transientImages.clear();
+    m_transientMemory = {};
+    m_allocatedTransients.clear();
+    m_stats.transientBytes = 0;
+    m_stats.unaliasedBytes = 0;
+}
@@ -0,0 +1,151 @@
+export module Render.Graph;
+import Core;
+import Render.MemoryAllocator;
+import Render.VulkanResource;
+
+// How a pass uses an image, which decides its layout and the stages and accesses its barriers wait on
+export enum class ImageUsage : UInt8
+{
+    ColorAttachment,
+    DepthAttachment,
+    TransferSrc,
+    TransferDst,
+    Present,
+};
+
+// What has happened to an image since its last barrier. Imported images carry it from frame to frame, so the first
+// barrier of a frame waits on exactly what the last one did with them.
+export struct ImageState
+{
+    vk::ImageLayout layout{vk::ImageLayout::eUndefined};
+    vk::PipelineStageFlags stages{};    // Accessing the image since the last barrier
+    vk::AccessFlags writeAccess{};      // Of the last write
+    vk::PipelineStageFlags visibleTo{}; // Stages the last write has been made visible to
+};
+
+export struct TransientImageInfo
+{
+    vk::Extent2D extent{};
+    vk::Format format{};
+    vk::ImageUsageFlags usage{};
+    vk::ImageAspectFlags aspect{};
+
+    bool operator==(const TransientImageInfo&) const = default;
+};
+
+export struct RenderGraphImage
+{
+    UInt32 index{};
+};
+
+export struct ImageAccess
+{
+    RenderGraphImage image;
+    ImageUsage usage{};
+};
+
+export struct RenderGraphPassStats
+{
+    std::string name;
+    UInt32 barriers{};
+};
+
+export struct RenderGraphStats
+{
+    std::vector<RenderGraphPassStats> passes;
+    UInt32 barriers{};
+    UInt32 barrierBatches{};         // Pipeline barrier commands, at most one per pass
+    vk::DeviceSize transientBytes{}; // Backing the transient images, shared between the ones never alive together
+    vk::DeviceSize unaliasedBytes{}; // The transient images would take with memory of their own
+};
+
+// Orders the passes of a frame. Every pass declares the images it uses and how, and the graph records the barriers in
+// front of it: only where a layout changes or a write has to finish or become visible first, all of a pass's in one
+// batch, waiting on the stages that actually touched the image. Transient images only live within the frame, and the
+// ones never used by the same passes share their memory.
+// Built and executed on the render thread, once per frame.
+export class RenderGraph : VulkanResource
+{
+public:
+    using Execute = std::function<void(vk::CommandBuffer, const RenderGraph&)>;
+
+    using VulkanResource::VulkanResource;
+
+    void shutdown();
+
+    // Drops the last frame's passes and images. Transient memory is kept for the next frame that needs the same images.
+    void reset();
+
+    // An image owned outside the graph. Its state is read when the graph executes and written back once it's done.
+    [[nodiscard]] RenderGraphImage importImage(vk::Image image, vk::ImageView view, vk::ImageAspectFlags aspect, ImageState& state);
+    [[nodiscard]] RenderGraphImage createTransient(const TransientImageInfo& info);
+
+    // Passes execute in the order they're added. A pass without commands only moves its images into their usage,
+    // such as handing the swapchain image over to presentation.
+    void addPass(std::string name, std::vector<ImageAccess> images, Execute execute = {});
+    void execute(vk::CommandBuffer commandBuffer);
+
+    // Only valid while executing for transient images
+    [[nodiscard]] vk::Image getImage(RenderGraphImage image) const;
+    [[nodiscard]] vk::ImageView getView(RenderGraphImage image) const;
+
+    [[nodiscard]] const RenderGraphStats& getStats() const { return m_stats; } // Of the last execution
+
+private:
+    struct ImageEntry
+    {
+        vk::Image image{};
+        vk::ImageView view{};
+        vk::ImageAspectFlags aspect{};
+        ImageState* imported{};
+        std::optional<UInt32> transient; // Index into m_transients
+        ImageState state;
+        bool used{};
+    };
+
+    struct Pass
+    {
+        std::string name;
+        std::vector<ImageAccess> images;
+        Execute execute;
+    };
+
+    // A transient image and the passes it's alive for, which decide what it may alias
+    struct Transient
+    {
+        TransientImageInfo info;
+        UInt32 firstPass{};
+        UInt32 lastPass{};
+
+        bool operator==(const Transient&) const = default;
+    };
+
+    struct TransientImage
+    {
+        vk::Image image{};
+        vk::ImageView view{};
+        vk::DeviceSize offset{};
+        vk::DeviceSize size{};
+    };
+
+    // Creates the transient images and places them in one allocation, unless last frame's are the same
+    void allocateTransients();
+    void releaseTransients();
+    void recordBarriers(vk::CommandBuffer commandBuffer, const Pass& pass, RenderGraphPassStats& stats);
+
+    std::vector<ImageEntry> m_images;
+    std::vector<Pass> m_passes;
+    std::vector<Transient> m_transients;
+
+    std::vector<Transient> m_allocatedTransients; // What m_transientImages were created for
+    std::vector<TransientImage> m_transientImages;
+    GpuAllocation m_transientMemory{};
+
+    // Everything transient memory was used for so far, which the first barrier of each transient image waits on, as
+    // the image may alias any of it. Carried over to the next frame, which reuses the memory.
+    vk::PipelineStageFlags m_transientStages{};
+    vk::AccessFlags m_transientWrites{};
+
+    std::vector<vk::ImageMemoryBarrier> m_barriers; // Scratch
+    RenderGraphStats m_stats;
+};
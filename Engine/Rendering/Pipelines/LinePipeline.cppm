@@ -4,6 +4,7 @@ module;
 export module Render.Pipeline.Line;
 import Assets.Mesh;
 import Core;
+import Render.Shaders;
 import Render.Utils;
 import Render.Vulkan;
 
@@ -110,10 +111,8 @@ export vk::Pipeline createLinePipeline(vk::Device device, vk::PipelineCache pipe
     };
 
     // Load shaders
-    auto vertShaderCode = RenderUtils::readFile(RenderUtils::getExecutableRoot() / "Shaders/LineShader.vert.spv");
-    auto fragShaderCode = RenderUtils::readFile(RenderUtils::getExecutableRoot() / "Shaders/LineShader.frag.spv");
-    vk::ShaderModule vertShaderModule = RenderUtils::createShaderModule(vertShaderCode, device);
-    vk::ShaderModule fragShaderModule = RenderUtils::createShaderModule(fragShaderCode, device);
+    vk::ShaderModule vertShaderModule = RenderUtils::createShaderModule(Shaders::lineVertex, device);
+    vk::ShaderModule fragShaderModule = RenderUtils::createShaderModule(Shaders::lineFragment, device);
 
     const vk::PipelineShaderStageCreateInfo vertShaderStageInfo
     {
@@ -4,9 +4,20 @@ module;
 export module Render.Pipeline.Mesh;
 import Assets.Mesh;
 import Core;
+import Math;
+import Render.Shaders;
 import Render.Utils;
 import Render.Vulkan;
 
+// Per-instance vertex input of the mesh pipelines, one per object drawn
+export struct MeshInstanceData
+{
+    Mat4 model{};
+    Vec4 tint{1};
+    UInt32 texture{}; // Index into the texture table
+    UInt32 sampler{};
+};
+
 export struct GraphicsPipelineConfig
 {
     vk::CullModeFlags cullMode{vk::CullModeFlagBits::eBack};
@@ -32,11 +43,32 @@ export vk::Pipeline createGraphicsPipeline(vk::Device device, vk::PipelineCache
         .pDynamicStates = dynamicStates.data(),
     };
 
-    static constexpr vk::VertexInputBindingDescription bindingDescription
+    static constexpr std::array bindingDescriptions
     {
-        .binding = 0,
-        .stride = sizeof(Vertex),
-        .inputRate = vk::VertexInputRate::eVertex,
+        vk::VertexInputBindingDescription
+        {
+            .binding = 0,
+            .stride = sizeof(Vertex),
+            .inputRate = vk::VertexInputRate::eVertex,
+        },
+        vk::VertexInputBindingDescription
+        {
+            .binding = 1,
+            .stride = sizeof(MeshInstanceData),
+            .inputRate = vk::VertexInputRate::eInstance,
+        }
+    };
+
+    // The model matrix takes one location per column
+    static constexpr auto modelColumn = [](UInt32 column)
+    {
+        return vk::VertexInputAttributeDescription
+        {
+            .location = 2 + column,
+            .binding = 1,
+            .format = vk::Format::eR32G32B32A32Sfloat,
+            .offset = static_cast<UInt32>(offsetof(MeshInstanceData, model) + sizeof(Vec4) * column),
+        };
     };
 
     static constexpr std::array attributeDescriptions
@@ -54,13 +86,31 @@ export vk::Pipeline createGraphicsPipeline(vk::Device device, vk::PipelineCache
             .binding = 0,
             .format = vk::Format::eR32G32Sfloat,
             .offset = offsetof(Vertex, uv),
+        },
+        modelColumn(0),
+        modelColumn(1),
+        modelColumn(2),
+        modelColumn(3),
+        vk::VertexInputAttributeDescription
+        {
+            .location = 6,
+            .binding = 1,
+            .format = vk::Format::eR32G32B32A32Sfloat,
+            .offset = offsetof(MeshInstanceData, tint),
+        },
+        vk::VertexInputAttributeDescription
+        {
+            .location = 7,
+            .binding = 1,
+            .format = vk::Format::eR32G32Uint,
+            .offset = offsetof(MeshInstanceData, texture),
         }
     };
 
     static constexpr vk::PipelineVertexInputStateCreateInfo vertexInputInfo
     {
-        .vertexBindingDescriptionCount = 1,
-        .pVertexBindingDescriptions = &bindingDescription,
+        .vertexBindingDescriptionCount = static_cast<UInt32>(bindingDescriptions.size()),
+        .pVertexBindingDescriptions = bindingDescriptions.data(),
         .vertexAttributeDescriptionCount = static_cast<UInt32>(attributeDescriptions.size()),
         .pVertexAttributeDescriptions = attributeDescriptions.data(),
     };
@@ -127,11 +177,8 @@ export vk::Pipeline createGraphicsPipeline(vk::Device device, vk::PipelineCache
         .maxDepthBounds = 1.0f, // Optional
     };
 
-    auto vertShaderCode = RenderUtils::readFile(RenderUtils::getExecutableRoot() / "Shaders/Shader.vert.spv");
-    auto fragShaderCode = RenderUtils::readFile(RenderUtils::getExecutableRoot() / "Shaders/Shader.frag.spv");
-
-    vk::ShaderModule vertShaderModule = RenderUtils::createShaderModule(vertShaderCode, device);
-    vk::ShaderModule fragShaderModule = RenderUtils::createShaderModule(fragShaderCode, device);
+    vk::ShaderModule vertShaderModule = RenderUtils::createShaderModule(Shaders::meshVertex, device);
+    vk::ShaderModule fragShaderModule = RenderUtils::createShaderModule(Shaders::meshFragment, device);
 
     const vk::PipelineShaderStageCreateInfo vertShaderStageInfo
     {
@@ -0,0 +1,100 @@
+module Render.PipelineCache;
+
+namespace
+{
+    constexpr UInt32 fileMagic = 0x4350564D; // "MVPC"
+    constexpr UInt32 fileVersion = 1;
+
+    struct FileHeader
+    {
+        UInt32 magic{};
+        UInt32 version{};
+        std::array<UInt8, vk::UuidSize> deviceUUID{};
+        std::array<UInt8, vk::UuidSize> driverUUID{};
+        UInt64 dataSize{};
+    };
+
+    FileHeader makeHeader(vk::PhysicalDevice physicalDevice, UInt64 dataSize)
+    {
+        const auto properties = physicalDevice.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>();
+        const auto& ids = properties.get<vk::PhysicalDeviceIDProperties>();
+
+        FileHeader header{.magic = fileMagic, .version = fileVersion, .dataSize = dataSize};
+        std::ranges::copy(ids.deviceUUID, header.deviceUUID.begin());
+        std::ranges::copy(ids.driverUUID, header.driverUUID.begin());
+        return header;
+    }
+
+    std::vector<std::byte> readCacheData(vk::PhysicalDevice physicalDevice, const std::filesystem::path& path)
+    {
+        std::ifstream file{path, std::ios::binary};
+        if (!file.is_open())
+            return {};
+
+        FileHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+            return {};
+
+        const FileHeader expected = makeHeader(physicalDevice, header.dataSize);
+        if (header.magic != expected.magic || header.version != expected.version
+            || header.deviceUUID != expected.deviceUUID || header.driverUUID != expected.driverUUID)
+        {
+            log("[PipelineCache] Cache was written by another device or driver, starting empty");
+            return {};
+        }
+
+        std::vector<std::byte> data(header.dataSize);
+        if (!file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size())))
+        {
+            report("[PipelineCache] Cache file is truncated, starting empty", ErrorType::Warning);
+            return {};
+        }
+
+        return data;
+    }
+}
+
+vk::PipelineCache PipelineCache::load(vk::Device device, vk::PhysicalDevice physicalDevice, const std::filesystem::path& path)
+{
+    const std::vector<std::byte> data = readCacheData(physicalDevice, path);
+
+    const vk::PipelineCacheCreateInfo createInfo
+    {
+        .initialDataSize = data.size(),
+        .pInitialData = data.data(),
+    };
+
+    vk::PipelineCache cache = device.createPipelineCache(createInfo, nullptr);
+    if (!cache)
+    {
+        fatalError("failed to create pipeline cache!");
+    }
+
+    return cache;
+}
+
+// Written next to the file and renamed over it, so a crash while saving never leaves a broken cache behind
+void PipelineCache::save(vk::Device device, vk::PhysicalDevice physicalDevice, vk::PipelineCache cache, const std::filesystem::path& path)
+{
+    const std::vector<UInt8> data = device.getPipelineCacheData(cache);
+    const FileHeader header = makeHeader(physicalDevice, data.size());
+
+    std::filesystem::path tempPath = path;
+    tempPath += ".tmp";
+
+    {
+        std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+        if (!file)
+        {
+            report(std::format("[PipelineCache] Failed to write '{}'", tempPath.generic_string()), ErrorType::Warning);
+            return;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    check(!error, std::format("[PipelineCache] Failed to replace '{}': {}", path.generic_string(), error.message()), ErrorType::Warning);
+}
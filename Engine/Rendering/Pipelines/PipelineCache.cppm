@@ -0,0 +1,13 @@
+export module Render.PipelineCache;
+import Core;
+import Render.Vulkan;
+
+// Keeps the pipeline cache on disk between runs, so pipelines are only compiled from scratch on the first launch. The
+// file starts with the UUIDs of the device and driver that wrote it, and any other device or driver starts empty.
+export namespace PipelineCache
+{
+    // Creates the cache from the file when it was written by the same device and driver, empty otherwise
+    [[nodiscard]] vk::PipelineCache load(vk::Device device, vk::PhysicalDevice physicalDevice, const std::filesystem::path& path);
+
+    void save(vk::Device device, vk::PhysicalDevice physicalDevice, vk::PipelineCache cache, const std::filesystem::path& path);
+}
@@ -0,0 +1,25 @@
+module Render.DeletionQueue;
+
+void DeletionQueue::beginFrame(UInt32 frameIndex)
+{
+    m_frameIndex = frameIndex;
+    flush(m_frames[m_frameIndex]);
+}
+
+void DeletionQueue::push(Deleter deleter)
+{
+    m_frames[m_frameIndex].push_back(std::move(deleter));
+}
+
+void DeletionQueue::flushAll()
+{
+    for (std::vector<Deleter>& deleters : m_frames)
+        flush(deleters);
+}
+
+void DeletionQueue::flush(std::vector<Deleter>& deleters)
+{
+    for (Deleter& deleter : deleters)
+        deleter();
+    deleters.clear();
+}
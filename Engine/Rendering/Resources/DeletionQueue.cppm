@@ -0,0 +1,27 @@
+export module Render.DeletionQueue;
+import Core;
+import Render.Vulkan;
+
+// Destroys GPU resources once no frame in flight can still be using them. Whatever is retired while a frame slot is
+// current is destroyed the next time that slot begins, after its fence has been waited on: by then the frame that was
+// recorded in it, and every frame submitted before, has finished executing.
+// Only used from the render thread.
+export class DeletionQueue
+{
+public:
+    using Deleter = std::function<void()>;
+
+    // Destroys what was retired the last time the slot was current. Only call once the GPU is done with the frame.
+    void beginFrame(UInt32 frameIndex);
+
+    void push(Deleter deleter);
+
+    // Destroys everything right away. Only call while the device is idle.
+    void flushAll();
+
+private:
+    void flush(std::vector<Deleter>& deleters);
+
+    std::array<std::vector<Deleter>, MaxFramesInFlight> m_frames;
+    UInt32 m_frameIndex{};
+};
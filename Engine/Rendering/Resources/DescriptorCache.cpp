@@ -0,0 +1,68 @@
+module Render.DescriptorCache;
+
+void DescriptorCache::init(vk::Device device)
+{
+    m_device = device;
+}
+
+bool DescriptorCache::writeBuffer(vk::DescriptorSet set, UInt32 binding, vk::DescriptorType type, const vk::DescriptorBufferInfo& info, UInt32 arrayElement)
+{
+    return write({set, binding, arrayElement}, {type, info});
+}
+
+bool DescriptorCache::writeImage(vk::DescriptorSet set, UInt32 binding, vk::DescriptorType type, const vk::DescriptorImageInfo& info, UInt32 arrayElement)
+{
+    return write({set, binding, arrayElement}, {type, info});
+}
+
+void DescriptorCache::forget(vk::DescriptorSet set)
+{
+    std::erase_if(m_contents, [set](const auto& entry) { return entry.first.set == set; });
+}
+
+void DescriptorCache::forget(vk::DescriptorSet set, UInt32 binding, UInt32 arrayElement)
+{
+    m_contents.erase({set, binding, arrayElement});
+}
+
+void DescriptorCache::beginFrame()
+{
+    m_lastFrameWrites = m_frameWrites;
+    m_frameWrites = 0;
+}
+
+std::size_t DescriptorCache::KeyHash::operator()(const Key& key) const
+{
+    const std::size_t slotHash = std::hash<UInt64>{}(UInt64{key.binding} << 32 | key.arrayElement);
+    return std::hash<vk::DescriptorSet>{}(key.set) ^ (slotHash << 1);
+}
+
+bool DescriptorCache::write(const Key& key, Contents&& contents)
+{
+    const auto [it, inserted] = m_contents.try_emplace(key, contents);
+    if (!inserted)
+    {
+        if (it->second == contents)
+            return false;
+
+        it->second = contents;
+    }
+
+    vk::WriteDescriptorSet descriptorWrite
+    {
+        .dstSet = key.set,
+        .dstBinding = key.binding,
+        .dstArrayElement = key.arrayElement,
+        .descriptorCount = 1,
+        .descriptorType = contents.type,
+    };
+
+    if (const auto* bufferInfo = std::get_if<vk::DescriptorBufferInfo>(&it->second.info))
+        descriptorWrite.pBufferInfo = bufferInfo;
+    else
+        descriptorWrite.pImageInfo = &std::get<vk::DescriptorImageInfo>(it->second.info);
+
+    m_device.updateDescriptorSets(1, &descriptorWrite, 0, nullptr);
+    m_frameWrites++;
+    return true;
+}
@@ -0,0 +1,56 @@
+export module Render.DescriptorCache;
+import Core;
+import Render.Vulkan;
+
+// Every descriptor write goes through here. The cache remembers what each descriptor holds and skips writes that
+// wouldn't change it, and counts the writes actually issued so steady state frames can be checked to issue none.
+// Only used from the render thread.
+export class DescriptorCache
+{
+public:
+    void init(vk::Device device);
+
+    // Both return whether a write was issued
+    bool writeBuffer(vk::DescriptorSet set, UInt32 binding, vk::DescriptorType type, const vk::DescriptorBufferInfo& info, UInt32 arrayElement = 0);
+    bool writeImage(vk::DescriptorSet set, UInt32 binding, vk::DescriptorType type, const vk::DescriptorImageInfo& info, UInt32 arrayElement = 0);
+
+    // Call before freeing a set, as its handle may be reused by the next one allocated
+    void forget(vk::DescriptorSet set);
+
+    // Call before destroying what a descriptor refers to, as a new resource may reuse its handle
+    void forget(vk::DescriptorSet set, UInt32 binding, UInt32 arrayElement);
+
+    // Starts counting the writes of a new frame
+    void beginFrame();
+    [[nodiscard]] UInt32 getLastFrameWrites() const { return m_lastFrameWrites; }
+
+private:
+    struct Key
+    {
+        vk::DescriptorSet set{};
+        UInt32 binding{};
+        UInt32 arrayElement{};
+
+        bool operator==(const Key&) const = default;
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const;
+    };
+
+    struct Contents
+    {
+        vk::DescriptorType type{};
+        std::variant<vk::DescriptorBufferInfo, vk::DescriptorImageInfo> info;
+
+        bool operator==(const Contents&) const = default;
+    };
+
+    bool write(const Key& key, Contents&& contents);
+
+    std::unordered_map<Key, Contents, KeyHash> m_contents;
+    vk::Device m_device{};
+    UInt32 m_frameWrites{};
+    UInt32 m_lastFrameWrites{};
+};
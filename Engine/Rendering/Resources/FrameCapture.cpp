@@ -0,0 +1,127 @@
+module;
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "stb_image_write.h"
+
+module Render.FrameCapture;
+import Render.Utils;
+
+void FrameCapture::shutdown()
+{
+    for (UInt32 frameIndex = 0; frameIndex < MaxFramesInFlight; ++frameIndex)
+    {
+        beginFrame(frameIndex);
+        destroy(m_frames[frameIndex]);
+    }
+}
+
+void FrameCapture::request(std::filesystem::path path)
+{
+    std::lock_guard lock{m_mutex};
+    m_requested = std::move(path);
+}
+
+bool FrameCapture::isRequested() const
+{
+    std::lock_guard lock{m_mutex};
+    return m_requested.has_value();
+}
+
+void FrameCapture::record(vk::CommandBuffer commandBuffer, UInt32 frameIndex, vk::Image image, vk::Extent2D extent)
+{
+    std::optional<std::filesystem::path> path;
+    {
+        std::lock_guard lock{m_mutex};
+        path = std::exchange(m_requested, std::nullopt);
+    }
+
+    if (!path)
+        return;
+
+    Readback& readback = m_frames[frameIndex];
+    const vk::DeviceSize size = static_cast<vk::DeviceSize>(extent.width) * extent.height * 4;
+
+    if (readback.capacity < size)
+    {
+        destroy(readback);
+
+        std::tie(readback.buffer, readback.allocation) = RenderUtils::createBuffer
+        ({
+            .device = context().device,
+            .allocator = context().allocator,
+            .size = size,
+            .usage = vk::BufferUsageFlagBits::eTransferDst,
+            .properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+        });
+        readback.capacity = size;
+    }
+
+    readback.extent = extent;
+    readback.path = std::move(*path);
+
+    const vk::BufferImageCopy region
+    {
+        .bufferOffset = 0,
+        .bufferRowLength = 0,
+        .bufferImageHeight = 0,
+        .imageSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor, .layerCount = 1},
+        .imageOffset = {0, 0, 0},
+        .imageExtent = {extent.width, extent.height, 1},
+    };
+
+    commandBuffer.copyImageToBuffer(image, vk::ImageLayout::eTransferSrcOptimal, readback.buffer, region);
+
+    // Makes the copy visible to the host once the fence has signalled
+    const vk::BufferMemoryBarrier barrier
+    {
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask = vk::AccessFlagBits::eHostRead,
+        .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+        .buffer = readback.buffer,
+        .offset = 0,
+        .size = size,
+    };
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eHost, {}, nullptr, barrier, nullptr);
+}
+
+void FrameCapture::beginFrame(UInt32 frameIndex)
+{
+    Readback& readback = m_frames[frameIndex];
+    if (readback.path.empty())
+        return;
+
+    const std::filesystem::path path = std::exchange(readback.path, {});
+
+    if (path.has_parent_path())
+    {
+        std::error_code error;
+        std::filesystem::create_directories(path.parent_path(), error);
+    }
+
+    const int width = static_cast<int>(readback.extent.width);
+    const int height = static_cast<int>(readback.extent.height);
+
+    // PNG wants RGBA
+    std::vector<UInt8> pixels(static_cast<std::size_t>(width) * height * 4);
+    std::memcpy(pixels.data(), readback.allocation.mapped, pixels.size());
+    for (std::size_t i = 0; i < pixels.size(); i += 4)
+        std::swap(pixels[i], pixels[i + 2]);
+
+    if (!stbi_write_png(path.string().c_str(), width, height, 4, pixels.data(), width * 4))
+        report(std::format("[FrameCapture] Failed to write '{}'", path.generic_string()), ErrorType::Warning);
+
+    ++m_writtenCount;
+}
+
+void FrameCapture::destroy(Readback& readback)
+{
+    if (readback.buffer)
+        context().device.destroyBuffer(readback.buffer);
+
+    if (readback.allocation)
+        context().allocator->free(readback.allocation);
+
+    readback = {};
+}
@@ -0,0 +1,48 @@
+export module Render.FrameCapture;
+import Core;
+import Render.MemoryAllocator;
+import Render.VulkanResource;
+
+// Reads rendered frames back to the host and writes them to PNG files. A requested capture is copied into the frame's
+// readback buffer while the frame is recorded, and written once the frame's fence has signalled, so capturing never
+// waits on the GPU.
+// Only used from the render thread, apart from request.
+export class FrameCapture : VulkanResource
+{
+public:
+    using VulkanResource::VulkanResource;
+
+    // Writes the captures still waiting. Only call once the GPU is done with every frame.
+    void shutdown();
+
+    // Captures the next frame recorded to the file
+    void request(std::filesystem::path path);
+    [[nodiscard]] bool isRequested() const;
+
+    // Copies a BGRA8 image, the format every pipeline renders to, into the frame's readback buffer if a capture was
+    // requested. The image has to be in transfer source layout.
+    void record(vk::CommandBuffer commandBuffer, UInt32 frameIndex, vk::Image image, vk::Extent2D extent);
+
+    // Writes the capture recorded in the frame slot. Only call once the GPU is done with the frame.
+    void beginFrame(UInt32 frameIndex);
+
+    // Captures written so far, each one encoded on the thread that began its frame
+    [[nodiscard]] UInt32 getWrittenCount() const { return m_writtenCount; }
+
+private:
+    struct Readback
+    {
+        vk::Buffer buffer{};
+        GpuAllocation allocation{};
+        vk::DeviceSize capacity{};
+        vk::Extent2D extent{};
+        std::filesystem::path path; // Empty unless a capture is waiting to be written
+    };
+
+    void destroy(Readback& readback);
+
+    mutable std::mutex m_mutex;
+    std::optional<std::filesystem::path> m_requested;
+    std::array<Readback, MaxFramesInFlight> m_frames{};
+    UInt32 m_writtenCount{};
+};
@@ -0,0 +1,321 @@
+module Render.MemoryAllocator;
+
+MemoryBlock::MemoryBlock(vk::DeviceMemory memory, vk::DeviceSize size, std::byte* mapped, AllocationStrategy strategy, vk::DeviceSize minBuddySize)
+    : m_memory{memory},
+      m_size{size},
+      m_mapped{mapped},
+      m_strategy{strategy},
+      m_minBuddySize{minBuddySize}
+{
+    if (m_strategy == AllocationStrategy::Buddy)
+    {
+        check(std::has_single_bit(m_size) && m_size >= m_minBuddySize, "[MemoryBlock] Buddy blocks must be a power of two in size!", ErrorType::FatalError);
+        m_freeRanges.resize(getOrder(m_size) + 1);
+        m_freeRanges.back().push_back(0);
+    }
+}
+
+UInt32 MemoryBlock::getOrder(vk::DeviceSize size) const
+{
+    return static_cast<UInt32>(std::countr_zero(size / m_minBuddySize));
+}
+
+std::optional<vk::DeviceSize> MemoryBlock::allocate(vk::DeviceSize size, vk::DeviceSize alignment, vk::DeviceSize& allocatedSize)
+{
+    if (m_strategy == AllocationStrategy::Linear)
+    {
+        const vk::DeviceSize offset = (m_head + alignment - 1) / alignment * alignment;
+        if (offset + size > m_size)
+            return std::nullopt;
+
+        m_head = offset + size;
+        m_used += size;
+        m_allocationCount++;
+        allocatedSize = size;
+        return offset;
+    }
+
+    // Ranges are aligned to their own size, so rounding up to the alignment satisfies it too
+    const vk::DeviceSize rangeSize = std::bit_ceil(std::max({size, alignment, m_minBuddySize}));
+    if (rangeSize > m_size)
+        return std::nullopt;
+
+    const UInt32 order = getOrder(rangeSize);
+    UInt32 available = order;
+    while (available < m_freeRanges.size() && m_freeRanges[available].empty())
+        available++;
+
+    if (available == m_freeRanges.size())
+        return std::nullopt;
+
+    const vk::DeviceSize offset = m_freeRanges[available].back();
+    m_freeRanges[available].pop_back();
+
+    // Split the range in halves until it fits, keeping the upper halves free
+    while (available > order)
+    {
+        available--;
+        m_freeRanges[available].push_back(offset + (m_minBuddySize << available));
+    }
+
+    m_used += rangeSize;
+    m_allocationCount++;
+    allocatedSize = rangeSize;
+    return offset;
+}
+
+void MemoryBlock::free(vk::DeviceSize offset, vk::DeviceSize size)
+{
+    m_used -= size;
+    m_allocationCount--;
+
+    if (m_strategy == AllocationStrategy::Linear)
+    {
+        if (m_allocationCount == 0)
+            m_head = 0;
+        return;
+    }
+
+    // Merge with the buddy for as long as it's free too
+    UInt32 order = getOrder(size);
+    while (order + 1 < m_freeRanges.size())
+    {
+        std::vector<vk::DeviceSize>& ranges = m_freeRanges[order];
+        const vk::DeviceSize buddy = offset ^ (m_minBuddySize << order);
+
+        auto it = std::ranges::find(ranges, buddy);
+        if (it == ranges.end())
+            break;
+
+        *it = ranges.back();
+        ranges.pop_back();
+        offset = std::min(offset, buddy);
+        order++;
+    }
+
+    m_freeRanges[order].push_back(offset);
+}
+
+vk::DeviceSize MemoryBlock::getLargestFreeRange() const
+{
+    if (m_strategy == AllocationStrategy::Linear)
+        return m_size - m_head;
+
+    for (std::size_t order = m_freeRanges.size(); order-- > 0;)
+    {
+        if (!m_freeRanges[order].empty())
+            return m_minBuddySize << order;
+    }
+    return 0;
+}
+
+void GpuAllocator::init(vk::Device device, vk::PhysicalDevice physicalDevice, vk::DeviceSize blockSize)
+{
+    check(std::has_single_bit(blockSize), "[GpuAllocator] Block size must be a power of two!", ErrorType::FatalError);
+
+    m_device = device;
+    m_memoryProperties = physicalDevice.getMemoryProperties();
+    m_blockSize = blockSize;
+}
+
+void GpuAllocator::shutdown()
+{
+    std::lock_guard lock{m_mutex};
+
+    UInt32 liveAllocations = m_dedicatedCount;
+    for (Pool& pool : m_pools)
+    {
+        for (const std::unique_ptr<MemoryBlock>& block : pool.blocks)
+        {
+            liveAllocations += block->getAllocationCount();
+            freeDeviceMemory(block->getMemory(), block->getSize(), pool.key.memoryType);
+        }
+    }
+    m_pools.clear();
+
+    check(liveAllocations == 0, std::format("[GpuAllocator] {} allocations were still alive at shutdown!", liveAllocations), ErrorType::Warning);
+}
+
+GpuAllocation GpuAllocator::allocate(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties, ResourceKind kind, AllocationStrategy strategy)
+{
+    std::lock_guard lock{m_mutex};
+
+    const UInt32 memoryType = findMemoryType(requirements.memoryTypeBits, properties);
+
+    // Large resources would waste most of a block, so they get their own memory
+    if (requirements.size > m_blockSize / 2)
+    {
+        GpuAllocation allocation{.size = requirements.size, .memoryType = memoryType};
+        allocation.memory = allocateDeviceMemory(requirements.size, memoryType, allocation.mapped);
+        m_dedicatedCount++;
+        m_dedicatedBytes += requirements.size;
+        return allocation;
+    }
+
+    Pool& pool = getPool({.memoryType = memoryType, .kind = kind, .strategy = strategy});
+
+    auto tryAllocate = [&](MemoryBlock& block) -> GpuAllocation
+    {
+        vk::DeviceSize size{};
+        const std::optional<vk::DeviceSize> offset = block.allocate(requirements.size, requirements.alignment, size);
+        if (!offset)
+            return {};
+
+        return
+        {
+            .memory = block.getMemory(),
+            .offset = *offset,
+            .size = size,
+            .mapped = block.getMapped() ? block.getMapped() + *offset : nullptr,
+            .block = &block,
+            .memoryType = memoryType,
+        };
+    };
+
+    for (const std::unique_ptr<MemoryBlock>& block : pool.blocks)
+    {
+        if (GpuAllocation allocation = tryAllocate(*block))
+            return allocation;
+    }
+
+    std::byte* mapped{};
+    const vk::DeviceMemory memory = allocateDeviceMemory(m_blockSize, memoryType, mapped);
+    MemoryBlock& block = *pool.blocks.emplace_back(std::make_unique<MemoryBlock>(memory, m_blockSize, mapped, strategy, minBuddySize));
+
+    GpuAllocation allocation = tryAllocate(block);
+    check(static_cast<bool>(allocation), "[GpuAllocator] Failed to allocate from a new block!", ErrorType::FatalError);
+    return allocation;
+}
+
+void GpuAllocator::free(GpuAllocation& allocation)
+{
+    if (!allocation)
+        return;
+
+    std::lock_guard lock{m_mutex};
+
+    if (allocation.block)
+    {
+        allocation.block->free(allocation.offset, allocation.size);
+    }
+    else
+    {
+        freeDeviceMemory(allocation.memory, allocation.size, allocation.memoryType);
+        m_dedicatedCount--;
+        m_dedicatedBytes -= allocation.size;
+    }
+
+    allocation = {};
+}
+
+void GpuAllocator::releaseEmptyBlocks()
+{
+    std::lock_guard lock{m_mutex};
+
+    for (Pool& pool : m_pools)
+    {
+        std::erase_if(pool.blocks, [&](const std::unique_ptr<MemoryBlock>& block)
+        {
+            if (!block->empty())
+                return false;
+
+            freeDeviceMemory(block->getMemory(), block->getSize(), pool.key.memoryType);
+            return true;
+        });
+    }
+}
+
+GpuMemoryStats GpuAllocator::getStats() const
+{
+    std::lock_guard lock{m_mutex};
+
+    GpuMemoryStats stats{.dedicatedCount = m_dedicatedCount, .dedicatedBytes = m_dedicatedBytes};
+    for (const Pool& pool : m_pools)
+    {
+        for (const std::unique_ptr<MemoryBlock>& block : pool.blocks)
+        {
+            stats.blockCount++;
+            stats.allocationCount += block->getAllocationCount();
+            stats.blockBytes += block->getSize();
+            stats.usedBytes += block->getUsedSize();
+            stats.largestFreeRange = std::max(stats.largestFreeRange, block->getLargestFreeRange());
+        }
+    }
+    return stats;
+}
+
+std::vector<GpuHeapStats> GpuAllocator::getHeapStats() const
+{
+    std::lock_guard lock{m_mutex};
+
+    std::vector<GpuHeapStats> heaps;
+    heaps.reserve(m_memoryProperties.memoryHeapCount);
+    for (UInt32 i = 0; i < m_memoryProperties.memoryHeapCount; ++i)
+    {
+        const vk::MemoryHeap& heap = m_memoryProperties.memoryHeaps[i];
+        heaps.push_back
+        ({
+            .budget = heap.size,
+            .usage = m_heapUsage[i],
+            .deviceLocal = static_cast<bool>(heap.flags & vk::MemoryHeapFlagBits::eDeviceLocal),
+        });
+    }
+    return heaps;
+}
+
+UInt32 GpuAllocator::findMemoryType(UInt32 typeFilter, vk::MemoryPropertyFlags properties) const
+{
+    for (UInt32 i = 0; i < m_memoryProperties.memoryTypeCount; ++i)
+    {
+        if ((typeFilter & (1 << i))
+            && (m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+        {
+            return i;
+        }
+    }
+
+    fatalError("failed to find suitable memory type!");
+    return 0;
+}
+
+GpuAllocator::Pool& GpuAllocator::getPool(const PoolKey& key)
+{
+    if (auto it = std::ranges::find(m_pools, key, &Pool::key); it != m_pools.end())
+        return *it;
+
+    return m_pools.emplace_back(key);
+}
+
+vk::DeviceMemory GpuAllocator::allocateDeviceMemory(vk::DeviceSize size, UInt32 memoryType, std::byte*& mapped)
+{
+    const vk::MemoryAllocateInfo allocInfo
+    {
+        .allocationSize = size,
+        .memoryTypeIndex = memoryType,
+    };
+
+    const vk::DeviceMemory memory = m_device.allocateMemory(allocInfo, nullptr);
+    if (!memory)
+    {
+        fatalError("failed to allocate device memory!");
+    }
+
+    // Host visible blocks stay mapped for their whole lifetime, allocations just offset into the mapping
+    mapped = nullptr;
+    if (m_memoryProperties.memoryTypes[memoryType].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible)
+        mapped = static_cast<std::byte*>(m_device.mapMemory(memory, 0, vk::WholeSize));
+
+    getHeapUsage(memoryType) += size;
+    return memory;
+}
+
+void GpuAllocator::freeDeviceMemory(vk::DeviceMemory memory, vk::DeviceSize size, UInt32 memoryType)
+{
+    m_device.freeMemory(memory); // Implicitly unmaps
+    getHeapUsage(memoryType) -= size;
+}
+
+vk::DeviceSize& GpuAllocator::getHeapUsage(UInt32 memoryType)
+{
+    return m_heapUsage[m_memoryProperties.memoryTypes[memoryType].heapIndex];
+}
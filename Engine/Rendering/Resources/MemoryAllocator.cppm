@@ -0,0 +1,151 @@
+export module Render.MemoryAllocator;
+import Core;
+import Render.Vulkan;
+
+export enum class AllocationStrategy : UInt8
+{
+    Buddy,  // Long-lived resources: power of two ranges that merge back with their buddy when freed
+    Linear, // Transient resources such as staging buffers: bumps an offset, the block resets once all are freed
+};
+
+// Buffers and optimally tiled images never share a block, so bufferImageGranularity never has to be honoured
+export enum class ResourceKind : UInt8
+{
+    Buffer,
+    Image,
+};
+
+class MemoryBlock;
+
+export struct GpuAllocation
+{
+    vk::DeviceMemory memory{};
+    vk::DeviceSize offset{};
+    vk::DeviceSize size{};
+    std::byte* mapped{}; // Null unless the memory is host visible
+    MemoryBlock* block{}; // Null for dedicated allocations
+    UInt32 memoryType{};
+
+    explicit operator bool() const { return static_cast<bool>(memory); }
+};
+
+export struct GpuMemoryStats
+{
+    UInt32 blockCount{};         // Device memory objects shared through sub-allocation
+    UInt32 dedicatedCount{};     // Resources too large to share a block
+    UInt32 allocationCount{};    // Live sub-allocations
+    vk::DeviceSize blockBytes{};
+    vk::DeviceSize usedBytes{};  // Including the padding of each sub-allocation
+    vk::DeviceSize dedicatedBytes{};
+    vk::DeviceSize largestFreeRange{};
+
+    [[nodiscard]] UInt32 deviceAllocationCount() const { return blockCount + dedicatedCount; }
+
+    // 0 when the free memory of the blocks is one contiguous range, approaching 1 as it splits into small ranges
+    [[nodiscard]] float fragmentation() const
+    {
+        const vk::DeviceSize freeBytes = blockBytes - usedBytes;
+        return freeBytes ? 1.f - static_cast<float>(largestFreeRange) / static_cast<float>(freeBytes) : 0.f;
+    }
+};
+
+export struct GpuHeapStats
+{
+    vk::DeviceSize budget{}; // Size of the heap
+    vk::DeviceSize usage{};  // Allocated from the heap through the allocator
+    bool deviceLocal{};
+};
+
+class MemoryBlock
+{
+public:
+    MemoryBlock(vk::DeviceMemory memory, vk::DeviceSize size, std::byte* mapped, AllocationStrategy strategy, vk::DeviceSize minBuddySize);
+
+    [[nodiscard]] std::optional<vk::DeviceSize> allocate(vk::DeviceSize size, vk::DeviceSize alignment, vk::DeviceSize& allocatedSize);
+    void free(vk::DeviceSize offset, vk::DeviceSize size);
+
+    [[nodiscard]] vk::DeviceMemory getMemory() const { return m_memory; }
+    [[nodiscard]] std::byte* getMapped() const { return m_mapped; }
+    [[nodiscard]] vk::DeviceSize getSize() const { return m_size; }
+    [[nodiscard]] vk::DeviceSize getUsedSize() const { return m_used; }
+    [[nodiscard]] UInt32 getAllocationCount() const { return m_allocationCount; }
+    [[nodiscard]] vk::DeviceSize getLargestFreeRange() const;
+    [[nodiscard]] bool empty() const { return m_allocationCount == 0; }
+
+private:
+    [[nodiscard]] UInt32 getOrder(vk::DeviceSize size) const;
+
+    vk::DeviceMemory m_memory{};
+    vk::DeviceSize m_size{};
+    std::byte* m_mapped{};
+    AllocationStrategy m_strategy{};
+    vk::DeviceSize m_used{};
+    UInt32 m_allocationCount{};
+
+    // Buddy: offsets of the free ranges of each size, from m_minBuddySize up to the whole block
+    vk::DeviceSize m_minBuddySize{};
+    std::vector<std::vector<vk::DeviceSize>> m_freeRanges;
+
+    // Linear
+    vk::DeviceSize m_head{};
+};
+
+// Sub-allocates buffers and images from large device memory blocks, pooled by memory type, resource kind and strategy.
+// Keeps the number of vkAllocateMemory calls far below maxMemoryAllocationCount and makes resource creation cheap.
+// Thread safe.
+export class GpuAllocator
+{
+public:
+    static constexpr vk::DeviceSize defaultBlockSize = 64 * 1024 * 1024;
+    static constexpr vk::DeviceSize minBuddySize = 256;
+
+    void init(vk::Device device, vk::PhysicalDevice physicalDevice, vk::DeviceSize blockSize = defaultBlockSize);
+    void shutdown();
+
+    [[nodiscard]] GpuAllocation allocate
+    (
+        const vk::MemoryRequirements& requirements,
+        vk::MemoryPropertyFlags properties,
+        ResourceKind kind,
+        AllocationStrategy strategy = AllocationStrategy::Buddy
+    );
+    void free(GpuAllocation& allocation);
+
+    // Defragmentation hook: returns blocks nothing lives in anymore to the driver. Call after unloading large batches
+    // of resources. Moving live allocations would need their owners to recreate and rebind them, so it isn't done here.
+    void releaseEmptyBlocks();
+
+    [[nodiscard]] GpuMemoryStats getStats() const;
+    [[nodiscard]] std::vector<GpuHeapStats> getHeapStats() const;
+
+private:
+    struct PoolKey
+    {
+        UInt32 memoryType{};
+        ResourceKind kind{};
+        AllocationStrategy strategy{};
+
+        bool operator==(const PoolKey&) const = default;
+    };
+
+    struct Pool
+    {
+        PoolKey key;
+        std::vector<std::unique_ptr<MemoryBlock>> blocks;
+    };
+
+    [[nodiscard]] UInt32 findMemoryType(UInt32 typeFilter, vk::MemoryPropertyFlags properties) const;
+    [[nodiscard]] Pool& getPool(const PoolKey& key);
+    [[nodiscard]] vk::DeviceMemory allocateDeviceMemory(vk::DeviceSize size, UInt32 memoryType, std::byte*& mapped);
+    void freeDeviceMemory(vk::DeviceMemory memory, vk::DeviceSize size, UInt32 memoryType);
+    [[nodiscard]] vk::DeviceSize& getHeapUsage(UInt32 memoryType);
+
+    mutable std::mutex m_mutex;
+    vk::Device m_device{};
+    vk::PhysicalDeviceMemoryProperties m_memoryProperties{};
+    vk::DeviceSize m_blockSize{defaultBlockSize};
+    std::vector<Pool> m_pools;
+    std::array<vk::DeviceSize, vk::MaxMemoryHeaps> m_heapUsage{};
+    UInt32 m_dedicatedCount{};
+    vk::DeviceSize m_dedicatedBytes{};
+};
@@ -4,10 +4,10 @@ import Render.Utils;
 import Log;
 
 // Create a Vulkan image
-std::tuple<vk::Image, vk::DeviceMemory> RenderUtils::createImage
+std::tuple<vk::Image, GpuAllocation> RenderUtils::createImage
 (
     vk::Device device,
-    vk::PhysicalDevice physicalDevice,
+    GpuAllocator& allocator,
     vk::MemoryPropertyFlags properties,
     vk::Extent2D extent,
     vk::Format format,
@@ -36,21 +36,14 @@ std::tuple<vk::Image, vk::DeviceMemory> RenderUtils::createImage
     }
 
     const vk::MemoryRequirements memRequirements = device.getImageMemoryRequirements(image);
-    const vk::MemoryAllocateInfo allocInfo
-    {
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = findMemoryType(physicalDevice, memRequirements.memoryTypeBits, properties)
-    };
 
-    vk::DeviceMemory memory = device.allocateMemory(allocInfo);
-    if (!memory)
-    {
-        fatalError("failed to allocate image memory!");
-    }
+    // Linearly tiled images are laid out like buffers and can share their blocks
+    const ResourceKind kind = tiling == vk::ImageTiling::eOptimal ? ResourceKind::Image : ResourceKind::Buffer;
+    GpuAllocation allocation = allocator.allocate(memRequirements, properties, kind);
 
-    device.bindImageMemory(image, memory, 0);
+    device.bindImageMemory(image, allocation.memory, allocation.offset);
 
-    return std::make_pair(image, memory);
+    return std::make_pair(image, allocation);
 }
 
 vk::ImageView RenderUtils::createImageView
@@ -78,73 +71,20 @@ vk::ImageView RenderUtils::createImageView
     return device.createImageView(viewInfo);
 }
 
-std::tuple<vk::Image, vk::DeviceMemory> RenderUtils::createTextureImage
-(
-    const TextureData& data,
-    vk::Device device,
-    vk::PhysicalDevice physicalDevice,
-    vk::Queue commandQueue,
-    vk::CommandPool commandPool
-)
-{
-    const vk::DeviceSize imageSize = data.size.width * data.size.height * 4;
-
-    const CreateBufferInfo bufferInfo
-    {
-        .device = device,
-        .physicalDevice = physicalDevice,
-        .size = imageSize,
-        .usage = vk::BufferUsageFlagBits::eTransferSrc,
-        .properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-    };
-
-    auto&& [stagingBuffer, stagingBufferMemory] = createBuffer(bufferInfo);
-
-    void* memory = device.mapMemory(stagingBufferMemory, 0, imageSize);
-    std::memcpy(memory, data.pixels.data(), imageSize);
-    device.unmapMemory(stagingBufferMemory);
-
-    const vk::Extent2D imageExtent{narrow_cast<UInt32>(data.size.width), narrow_cast<UInt32>(data.size.height)};
-
-    auto result = createImage
-    (
-        device,
-        physicalDevice,
-        vk::MemoryPropertyFlagBits::eDeviceLocal,
-        imageExtent,
-        data.format,
-        vk::ImageTiling::eOptimal,
-        vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled
-    );
-
-    const auto image = std::get<vk::Image>(result);
-
-    transitionImageLayout(device, commandQueue, commandPool, image, data.format, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-
-    copyBufferToImage(device, commandQueue, commandPool, stagingBuffer, image, imageExtent);
-
-    transitionImageLayout(device, commandQueue, commandPool, image, data.format, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
-
-    device.destroyBuffer(stagingBuffer);
-    device.freeMemory(stagingBufferMemory);
-
-    return result;
-}
-
 vk::ImageView RenderUtils::createTextureImageView(vk::Device device, vk::Image image)
 {
     return createImageView(device, image, vk::Format::eR8G8B8A8Srgb);
 }
 
-vk::Sampler RenderUtils::createTextureSampler(vk::Device device, vk::PhysicalDevice physicalDevice)
+vk::Sampler RenderUtils::createTextureSampler(vk::Device device, vk::PhysicalDevice physicalDevice, vk::Filter filter)
 {
     const vk::PhysicalDeviceProperties properties = physicalDevice.getProperties();
 
     const vk::SamplerCreateInfo samplerInfo
     {
-        .magFilter = vk::Filter::eLinear,
-        .minFilter = vk::Filter::eLinear,
-        .mipmapMode = vk::SamplerMipmapMode::eLinear,
+        .magFilter = filter,
+        .minFilter = filter,
+        .mipmapMode = filter == vk::Filter::eNearest ? vk::SamplerMipmapMode::eNearest : vk::SamplerMipmapMode::eLinear,
         .addressModeU = vk::SamplerAddressMode::eRepeat,
         .addressModeV = vk::SamplerAddressMode::eRepeat,
         .addressModeW = vk::SamplerAddressMode::eRepeat,
@@ -0,0 +1,222 @@
+module Render.TextureTable;
+import Render.DescriptorCache;
+import Render.TextureLoading;
+import Render.Utils;
+
+void TextureTable::init()
+{
+    m_samplers[static_cast<std::size_t>(SamplerType::Linear)] = RenderUtils::createTextureSampler(context().device, context().physicalDevice, vk::Filter::eLinear);
+    m_samplers[static_cast<std::size_t>(SamplerType::Nearest)] = RenderUtils::createTextureSampler(context().device, context().physicalDevice, vk::Filter::eNearest);
+
+    const std::array bindings
+    {
+        vk::DescriptorSetLayoutBinding
+        {
+            .binding = samplerBinding,
+            .descriptorType = vk::DescriptorType::eSampler,
+            .descriptorCount = static_cast<UInt32>(m_samplers.size()),
+            .stageFlags = vk::ShaderStageFlagBits::eFragment,
+            .pImmutableSamplers = m_samplers.data(),
+        },
+        vk::DescriptorSetLayoutBinding
+        {
+            .binding = textureBinding,
+            .descriptorType = vk::DescriptorType::eSampledImage,
+            .descriptorCount = capacity,
+            .stageFlags = vk::ShaderStageFlagBits::eFragment,
+        },
+    };
+
+    static constexpr std::array<vk::DescriptorBindingFlags, 2> bindingFlags
+    {
+        vk::DescriptorBindingFlags{},
+        vk::DescriptorBindingFlagBits::ePartiallyBound | vk::DescriptorBindingFlagBits::eUpdateAfterBind,
+    };
+
+    const vk::DescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo
+    {
+        .bindingCount = static_cast<UInt32>(bindingFlags.size()),
+        .pBindingFlags = bindingFlags.data(),
+    };
+
+    const vk::DescriptorSetLayoutCreateInfo layoutInfo
+    {
+        .pNext = &bindingFlagsInfo,
+        .flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool,
+        .bindingCount = static_cast<UInt32>(bindings.size()),
+        .pBindings = bindings.data(),
+    };
+
+    m_layout = context().device.createDescriptorSetLayout(layoutInfo, nullptr);
+    if (!m_layout)
+    {
+        fatalError("failed to create texture table layout!");
+    }
+
+    const std::array poolSizes
+    {
+        vk::DescriptorPoolSize{vk::DescriptorType::eSampler, static_cast<UInt32>(m_samplers.size())},
+        vk::DescriptorPoolSize{vk::DescriptorType::eSampledImage, capacity},
+    };
+
+    const vk::DescriptorPoolCreateInfo poolInfo
+    {
+        .flags = vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind,
+        .maxSets = 1,
+        .poolSizeCount = static_cast<UInt32>(poolSizes.size()),
+        .pPoolSizes = poolSizes.data(),
+    };
+
+    m_pool = context().device.createDescriptorPool(poolInfo, nullptr);
+    if (!m_pool)
+    {
+        fatalError("failed to create texture table pool!");
+    }
+
+    const vk::DescriptorSetAllocateInfo allocInfo
+    {
+        .descriptorPool = m_pool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &m_layout,
+    };
+
+    if (context().device.allocateDescriptorSets(&allocInfo, &m_set) != vk::Result::eSuccess)
+    {
+        fatalError("failed to allocate texture table!");
+    }
+
+    createDefaultTexture();
+}
+
+void TextureTable::shutdown()
+{
+    context().descriptorCache->forget(m_set);
+    context().device.destroyDescriptorPool(m_pool); // Frees the set
+    context().device.destroyDescriptorSetLayout(m_layout);
+
+    for (vk::Sampler& sampler : m_samplers)
+    {
+        context().device.destroySampler(sampler);
+        sampler = nullptr;
+    }
+
+    context().device.destroyImageView(m_defaultView);
+    context().device.destroyImage(m_defaultImage);
+    context().allocator->free(m_defaultAllocation);
+
+    m_set = nullptr;
+    m_pool = nullptr;
+    m_layout = nullptr;
+    m_defaultView = nullptr;
+    m_defaultImage = nullptr;
+    m_freeSlots.clear();
+    m_nextSlot = 0;
+}
+
+UInt32 TextureTable::add(vk::ImageView view)
+{
+    UInt32 index;
+    if (!m_freeSlots.empty())
+    {
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else if (m_nextSlot < capacity)
+    {
+        index = m_nextSlot++;
+    }
+    else
+    {
+        report(std::format("[TextureTable] All {} texture slots are in use!", capacity));
+        return defaultIndex;
+    }
+
+    const vk::DescriptorImageInfo imageInfo
+    {
+        .imageView = view,
+        .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+    };
+
+    context().descriptorCache->writeImage(m_set, textureBinding, vk::DescriptorType::eSampledImage, imageInfo, index);
+    return index;
+}
+
+void TextureTable::remove(UInt32 index)
+{
+    if (index == defaultIndex)
+        return;
+
+    // The slot is left pointing at the destroyed view, which partial binding allows as long as nothing samples it
+    context().descriptorCache->forget(m_set, textureBinding, index);
+    m_freeSlots.push_back(index);
+}
+
+void TextureTable::createDefaultTexture()
+{
+    static constexpr vk::Format format = vk::Format::eR8G8B8A8Srgb;
+    const vk::Device device = context().device;
+
+    std::tie(m_defaultImage, m_defaultAllocation) = RenderUtils::createImage
+    (
+        device,
+        *context().allocator,
+        vk::MemoryPropertyFlagBits::eDeviceLocal,
+        {1, 1},
+        format,
+        vk::ImageTiling::eOptimal,
+        vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled
+    );
+    m_defaultView = RenderUtils::createImageView(device, m_defaultImage, format);
+
+    static constexpr vk::ImageSubresourceRange range
+    {
+        .aspectMask = vk::ImageAspectFlagBits::eColor,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+
+    auto layoutBarrier = [&](vk::ImageLayout oldLayout, vk::ImageLayout newLayout, vk::AccessFlags srcAccessMask, vk::AccessFlags dstAccessMask)
+    {
+        return vk::ImageMemoryBarrier
+        {
+            .srcAccessMask = srcAccessMask,
+            .dstAccessMask = dstAccessMask,
+            .oldLayout = oldLayout,
+            .newLayout = newLayout,
+            .srcQueueFamilyIndex = vk::QueueFamilyIgnored,
+            .dstQueueFamilyIndex = vk::QueueFamilyIgnored,
+            .image = m_defaultImage,
+            .subresourceRange = range,
+        };
+    };
+
+    // Cleared rather than uploaded, so it needs no staging and is ready before the upload manager first submits
+    const vk::CommandBuffer commandBuffer = RenderUtils::beginSingleTimeCommands(device, context().commandPool);
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr,
+        layoutBarrier(vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, {}, vk::AccessFlagBits::eTransferWrite));
+
+    static constexpr vk::ClearColorValue white{1.f, 1.f, 1.f, 1.f};
+    commandBuffer.clearColorImage(m_defaultImage, vk::ImageLayout::eTransferDstOptimal, white, range);
+
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, nullptr, nullptr,
+        layoutBarrier(vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead));
+
+    RenderUtils::endSingleTimeCommands(device, commandBuffer, context().graphicsQueue, context().commandPool);
+
+    const vk::DescriptorImageInfo imageInfo
+    {
+        .imageView = m_defaultView,
+        .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
+    };
+
+    context().descriptorCache->writeImage(m_set, textureBinding, vk::DescriptorType::eSampledImage, imageInfo, defaultIndex);
+    m_nextSlot = defaultIndex + 1;
+}
+
+void TextureTable::bind(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, UInt32 set) const
+{
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, set, {m_set}, {});
+}
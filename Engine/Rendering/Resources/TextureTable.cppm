@@ -0,0 +1,54 @@
+export module Render.TextureTable;
+import Core;
+import Render.MemoryAllocator;
+import Render.VulkanResource;
+
+export enum class SamplerType : UInt32
+{
+    Linear,
+    Nearest,
+    Count
+};
+
+// One descriptor set holding every texture, bound once per view. Shaders pick the texture and one of the shared
+// samplers by index, so draws never switch descriptor sets and objects with different textures can share a draw.
+// The image array is partially bound and updatable after binding, so textures come and go while frames are in flight.
+// Slot 0 always holds a white texel, which every texture without a slot of its own samples instead, so no index handed
+// out ever points outside the array.
+export class TextureTable : VulkanResource
+{
+public:
+    static constexpr UInt32 capacity = 4096;
+    static constexpr UInt32 defaultIndex = 0;
+    static constexpr UInt32 samplerBinding = 0;
+    static constexpr UInt32 textureBinding = 1;
+
+    using VulkanResource::VulkanResource;
+
+    // Records the default texture on the context's command pool and waits for it
+    void init();
+    void shutdown();
+
+    // Returns defaultIndex when the table is full
+    [[nodiscard]] UInt32 add(vk::ImageView view);
+
+    // Frees the slot for reuse. Only call once no frame in flight samples from it anymore.
+    void remove(UInt32 index);
+
+    void bind(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, UInt32 set) const;
+    [[nodiscard]] vk::DescriptorSetLayout getLayout() const { return m_layout; }
+
+private:
+    void createDefaultTexture();
+
+    std::array<vk::Sampler, static_cast<std::size_t>(SamplerType::Count)> m_samplers{};
+    vk::DescriptorSetLayout m_layout{};
+    vk::DescriptorPool m_pool{};
+    vk::DescriptorSet m_set{};
+    std::vector<UInt32> m_freeSlots;
+    UInt32 m_nextSlot{};
+
+    vk::Image m_defaultImage{};
+    GpuAllocation m_defaultAllocation{};
+    vk::ImageView m_defaultView{};
+};
@@ -0,0 +1,89 @@
+module Render.ThreadCommandPools;
+
+void ThreadCommandPools::init(UInt32 queueFamily)
+{
+    m_queueFamily = queueFamily;
+}
+
+void ThreadCommandPools::shutdown()
+{
+    for (const std::unique_ptr<ThreadPools>& pools : m_threads | std::views::values)
+    {
+        for (const FramePool& frame : *pools)
+            context().device.destroyCommandPool(frame.pool); // Frees the command buffers
+    }
+
+    m_threads.clear();
+}
+
+void ThreadCommandPools::beginFrame(UInt32 frameIndex)
+{
+    m_frameIndex = frameIndex;
+
+    std::lock_guard lock{m_mutex};
+    for (const std::unique_ptr<ThreadPools>& pools : m_threads | std::views::values)
+    {
+        FramePool& frame = (*pools)[frameIndex];
+        if (frame.used == 0)
+            continue;
+
+        context().device.resetCommandPool(frame.pool);
+        frame.used = 0;
+    }
+}
+
+vk::CommandBuffer ThreadCommandPools::beginSecondary(const vk::CommandBufferInheritanceInfo& inheritance)
+{
+    FramePool& frame = getThreadPools()[m_frameIndex];
+
+    if (frame.used == frame.buffers.size())
+    {
+        const vk::CommandBufferAllocateInfo allocInfo
+        {
+            .commandPool = frame.pool,
+            .level = vk::CommandBufferLevel::eSecondary,
+            .commandBufferCount = 1,
+        };
+
+        frame.buffers.push_back(context().device.allocateCommandBuffers(allocInfo).front());
+    }
+
+    const vk::CommandBuffer commandBuffer = frame.buffers[frame.used++];
+
+    const vk::CommandBufferBeginInfo beginInfo
+    {
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+        .pInheritanceInfo = &inheritance,
+    };
+    commandBuffer.begin(beginInfo);
+
+    return commandBuffer;
+}
+
+ThreadCommandPools::ThreadPools& ThreadCommandPools::getThreadPools()
+{
+    std::lock_guard lock{m_mutex};
+
+    std::unique_ptr<ThreadPools>& pools = m_threads[std::this_thread::get_id()];
+    if (pools)
+        return *pools;
+
+    pools = std::make_unique<ThreadPools>();
+
+    const vk::CommandPoolCreateInfo poolInfo
+    {
+        .flags = vk::CommandPoolCreateFlagBits::eTransient,
+        .queueFamilyIndex = m_queueFamily,
+    };
+
+    for (FramePool& frame : *pools)
+    {
+        frame.pool = context().device.createCommandPool(poolInfo, nullptr);
+        if (!frame.pool)
+        {
+            fatalError("failed to create thread command pool!");
+        }
+    }
+
+    return *pools;
+}
@@ -0,0 +1,39 @@
+export module Render.ThreadCommandPools;
+import Core;
+import Render.VulkanResource;
+
+// Secondary command buffers for recording on the job system. A command pool can only be used by one thread at a time,
+// so every thread that records gets its own pool per frame in flight, created the first time it asks for a buffer.
+// A frame's pools are reset together once the GPU is done with it, and their buffers reused for the next.
+export class ThreadCommandPools : VulkanResource
+{
+public:
+    using VulkanResource::VulkanResource;
+
+    void init(UInt32 queueFamily);
+    void shutdown();
+
+    // Resets the frame's pools. Only call once the GPU is done with the frame.
+    void beginFrame(UInt32 frameIndex);
+
+    // Begins a secondary command buffer from the calling thread's pool, continuing the rendering described by the
+    // inheritance info. It has to be executed by the frame's primary command buffer.
+    [[nodiscard]] vk::CommandBuffer beginSecondary(const vk::CommandBufferInheritanceInfo& inheritance);
+
+private:
+    struct FramePool
+    {
+        vk::CommandPool pool{};
+        std::vector<vk::CommandBuffer> buffers;
+        std::size_t used{};
+    };
+
+    using ThreadPools = std::array<FramePool, MaxFramesInFlight>;
+
+    [[nodiscard]] ThreadPools& getThreadPools();
+
+    std::mutex m_mutex;
+    std::unordered_map<std::thread::id, std::unique_ptr<ThreadPools>> m_threads; // Boxed, so threads keep theirs as others are added
+    UInt32 m_queueFamily{};
+    UInt32 m_frameIndex{};
+};
@@ -0,0 +1,62 @@
+module Render.UniformRing;
+import Render.Utils;
+
+void UniformRing::init(vk::DeviceSize frameSize)
+{
+    const vk::PhysicalDeviceLimits limits = context().physicalDevice.getProperties().limits;
+    m_alignment = std::max<vk::DeviceSize>(limits.minUniformBufferOffsetAlignment, 1);
+    m_frameSize = frameSize;
+    m_offset = 0;
+
+    const RenderUtils::CreateBufferInfo bufferInfo
+    {
+        .device = context().device,
+        .allocator = context().allocator,
+        .size = m_frameSize,
+        .usage = vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eVertexBuffer,
+        .properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+    };
+
+    for (FrameBuffer& frame : m_frames)
+    {
+        std::tie(frame.buffer, frame.allocation) = RenderUtils::createBuffer(bufferInfo);
+        check(frame.allocation.mapped, "[UniformRing] Failed to map uniform buffer!", ErrorType::FatalError);
+    }
+}
+
+void UniformRing::shutdown()
+{
+    for (FrameBuffer& frame : m_frames)
+    {
+        if (frame.allocation)
+        {
+            context().device.destroyBuffer(frame.buffer);
+            context().allocator->free(frame.allocation);
+        }
+        frame = {};
+    }
+}
+
+void UniformRing::beginFrame(UInt32 frameIndex)
+{
+    m_frameIndex = frameIndex;
+    m_offset = 0;
+}
+
+UniformAllocation UniformRing::allocate(vk::DeviceSize size)
+{
+    const vk::DeviceSize offset = (m_offset + m_alignment - 1) / m_alignment * m_alignment;
+
+    if (offset + size > m_frameSize)
+    {
+        if (!m_reportedOverflow)
+        {
+            report(std::format("[UniformRing] Frame buffer of {} bytes is full, skipping draws", m_frameSize));
+            m_reportedOverflow = true;
+        }
+        return {};
+    }
+
+    m_offset = offset + size;
+    return {static_cast<UInt32>(offset), m_frames[m_frameIndex].allocation.mapped + offset};
+}
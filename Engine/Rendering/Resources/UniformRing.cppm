@@ -0,0 +1,47 @@
+export module Render.UniformRing;
+import Core;
+import Render.MemoryAllocator;
+import Render.VulkanResource;
+
+export struct UniformAllocation
+{
+    UInt32 offset{};
+    void* data{}; // Null when the frame's buffer is full
+};
+
+// One persistently mapped uniform buffer per frame in flight. Per-draw data is sub-allocated linearly during the frame
+// and addressed with dynamic descriptor offsets, so render objects own no buffers or descriptor sets of their own and
+// the number of objects drawn is only limited by the size of the buffer. The buffers double as instance vertex buffers.
+export class UniformRing : VulkanResource
+{
+public:
+    static constexpr vk::DeviceSize defaultFrameSize = 16 * 1024 * 1024;
+
+    using VulkanResource::VulkanResource;
+
+    void init(vk::DeviceSize frameSize = defaultFrameSize);
+    void shutdown();
+
+    // Starts writing into the frame's buffer from the beginning. Only call once the GPU is done with the frame.
+    void beginFrame(UInt32 frameIndex);
+
+    [[nodiscard]] UniformAllocation allocate(vk::DeviceSize size);
+
+    [[nodiscard]] vk::Buffer getBuffer(std::size_t frameIndex) const { return m_frames[frameIndex].buffer; }
+    [[nodiscard]] vk::Buffer getCurrentBuffer() const { return m_frames[m_frameIndex].buffer; }
+    [[nodiscard]] vk::DeviceSize getUsedSize() const { return m_offset; }
+
+private:
+    struct FrameBuffer
+    {
+        vk::Buffer buffer{};
+        GpuAllocation allocation{};
+    };
+
+    std::array<FrameBuffer, MaxFramesInFlight> m_frames{};
+    vk::DeviceSize m_frameSize{};
+    vk::DeviceSize m_alignment{1};
+    vk::DeviceSize m_offset{};
+    UInt32 m_frameIndex{};
+    bool m_reportedOverflow{};
+};
@@ -0,0 +1,429 @@
+module Render.UploadManager;
+import Render.TextureLoading;
+import Render.Utils;
+
+namespace
+{
+    // Covers the texel size of every format and the usual optimal copy offset alignment
+    constexpr vk::DeviceSize stagingAlignment = 16;
+
+    constexpr vk::ImageSubresourceRange colorRange
+    {
+        .aspectMask = vk::ImageAspectFlagBits::eColor,
+        .baseMipLevel = 0,
+        .levelCount = 1,
+        .baseArrayLayer = 0,
+        .layerCount = 1,
+    };
+
+    vk::DeviceSize alignStaging(vk::DeviceSize offset)
+    {
+        return (offset + stagingAlignment - 1) / stagingAlignment * stagingAlignment;
+    }
+}
+
+void UploadManager::init(vk::Device device, GpuAllocator& allocator, vk::Queue transferQueue, UInt32 transferFamily, UInt32 graphicsFamily, vk::DeviceSize ringSize)
+{
+    m_device = device;
+    m_allocator = &allocator;
+    m_queue = transferQueue;
+    m_transferFamily = transferFamily;
+    m_graphicsFamily = graphicsFamily;
+    m_ringSize = ringSize;
+
+    const RenderUtils::CreateBufferInfo ringInfo
+    {
+        .device = m_device,
+        .allocator = m_allocator,
+        .size = m_ringSize,
+        .usage = vk::BufferUsageFlagBits::eTransferSrc,
+        .properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+    };
+
+    std::tie(m_ring.buffer, m_ring.allocation) = RenderUtils::createBuffer(ringInfo);
+    check(m_ring.allocation.mapped, "[UploadManager] Failed to map staging ring!", ErrorType::FatalError);
+
+    constexpr vk::SemaphoreTypeCreateInfo timelineInfo
+    {
+        .semaphoreType = vk::SemaphoreType::eTimeline,
+        .initialValue = 0,
+    };
+
+    const vk::SemaphoreCreateInfo semaphoreInfo
+    {
+        .pNext = &timelineInfo,
+    };
+
+    m_timeline = m_device.createSemaphore(semaphoreInfo, nullptr);
+    if (!m_timeline)
+    {
+        fatalError("failed to create upload timeline semaphore!");
+    }
+
+    const vk::CommandPoolCreateInfo poolInfo
+    {
+        .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer | vk::CommandPoolCreateFlagBits::eTransient,
+        .queueFamilyIndex = m_transferFamily,
+    };
+
+    m_commandPool = m_device.createCommandPool(poolInfo, nullptr);
+    if (!m_commandPool)
+    {
+        fatalError("failed to create transfer command pool!");
+    }
+}
+
+void UploadManager::shutdown()
+{
+    // Recorded copies may point at resources destroyed during shutdown, so they're dropped instead of submitted
+    while (!m_submissions.empty())
+        reclaim(true);
+
+    for (StagingBuffer& staging : m_recordingOversized)
+    {
+        m_device.destroyBuffer(staging.buffer);
+        m_allocator->free(staging.allocation);
+    }
+
+    m_device.destroyCommandPool(m_commandPool); // Frees the command buffers
+    m_device.destroySemaphore(m_timeline);
+    m_device.destroyBuffer(m_ring.buffer);
+    m_allocator->free(m_ring.allocation);
+
+    m_commandPool = nullptr;
+    m_timeline = nullptr;
+    m_ring = {};
+    m_recording = nullptr;
+    m_recordingOversized.clear();
+    m_freeCommandBuffers.clear();
+    m_recordedBufferAcquires.clear();
+    m_recordedImageAcquires.clear();
+    m_bufferAcquires.clear();
+    m_imageAcquires.clear();
+}
+
+void UploadManager::clear()
+{
+    submit();
+    while (!m_submissions.empty())
+        reclaim(true);
+
+    m_bufferAcquires.clear();
+    m_imageAcquires.clear();
+}
+
+std::tuple<vk::Buffer, GpuAllocation> UploadManager::createBuffer(const void* data, vk::DeviceSize size, vk::BufferUsageFlags usage)
+{
+    const Staging staging = stage(data, size);
+
+    const RenderUtils::CreateBufferInfo bufferInfo
+    {
+        .device = m_device,
+        .allocator = m_allocator,
+        .size = size,
+        .usage = usage | vk::BufferUsageFlagBits::eTransferDst,
+        .properties = vk::MemoryPropertyFlagBits::eDeviceLocal,
+    };
+
+    auto result = RenderUtils::createBuffer(bufferInfo);
+    const vk::Buffer buffer = std::get<vk::Buffer>(result);
+
+    const vk::CommandBuffer commandBuffer = getCommandBuffer();
+
+    const vk::BufferCopy region
+    {
+        .srcOffset = staging.offset,
+        .dstOffset = 0,
+        .size = size,
+    };
+    commandBuffer.copyBuffer(staging.buffer, buffer, region);
+
+    if (transfersOwnership())
+    {
+        auto ownershipBarrier = [&](vk::AccessFlags srcAccessMask, vk::AccessFlags dstAccessMask)
+        {
+            return vk::BufferMemoryBarrier
+            {
+                .srcAccessMask = srcAccessMask,
+                .dstAccessMask = dstAccessMask,
+                .srcQueueFamilyIndex = m_transferFamily,
+                .dstQueueFamilyIndex = m_graphicsFamily,
+                .buffer = buffer,
+                .offset = 0,
+                .size = vk::WholeSize,
+            };
+        };
+
+        const vk::BufferMemoryBarrier release = ownershipBarrier(vk::AccessFlagBits::eTransferWrite, {});
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, release, nullptr);
+
+        m_recordedBufferAcquires.push_back(ownershipBarrier({}, vk::AccessFlagBits::eVertexAttributeRead | vk::AccessFlagBits::eIndexRead));
+    }
+
+    return result;
+}
+
+std::tuple<vk::Image, GpuAllocation> UploadManager::createTexture(const TextureData& data)
+{
+    const vk::DeviceSize size = data.size.width * data.size.height * 4;
+    const Staging staging = stage(data.pixels.data(), size);
+
+    const vk::Extent2D extent{narrow_cast<UInt32>(data.size.width), narrow_cast<UInt32>(data.size.height)};
+
+    auto result = RenderUtils::createImage
+    (
+        m_device,
+        *m_allocator,
+        vk::MemoryPropertyFlagBits::eDeviceLocal,
+        extent,
+        data.format,
+        vk::ImageTiling::eOptimal,
+        vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled
+    );
+
+    const vk::Image image = std::get<vk::Image>(result);
+    const vk::CommandBuffer commandBuffer = getCommandBuffer();
+
+    auto layoutBarrier = [&](vk::ImageLayout oldLayout, vk::ImageLayout newLayout, vk::AccessFlags srcAccessMask, vk::AccessFlags dstAccessMask, UInt32 srcFamily, UInt32 dstFamily)
+    {
+        return vk::ImageMemoryBarrier
+        {
+            .srcAccessMask = srcAccessMask,
+            .dstAccessMask = dstAccessMask,
+            .oldLayout = oldLayout,
+            .newLayout = newLayout,
+            .srcQueueFamilyIndex = srcFamily,
+            .dstQueueFamilyIndex = dstFamily,
+            .image = image,
+            .subresourceRange = colorRange,
+        };
+    };
+
+    const vk::ImageMemoryBarrier toTransfer = layoutBarrier(vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, {}, vk::AccessFlagBits::eTransferWrite, vk::QueueFamilyIgnored, vk::QueueFamilyIgnored);
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, nullptr, nullptr, toTransfer);
+
+    const vk::BufferImageCopy region
+    {
+        .bufferOffset = staging.offset,
+        .bufferRowLength = 0u,
+        .bufferImageHeight = 0u,
+        .imageSubresource
+        {
+            .aspectMask = vk::ImageAspectFlagBits::eColor,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1,
+        },
+        .imageOffset = {0, 0, 0},
+        .imageExtent = {extent.width, extent.height, 1},
+    };
+    commandBuffer.copyBufferToImage(staging.buffer, image, vk::ImageLayout::eTransferDstOptimal, region);
+
+    // The graphics queue repeats the layout transition when it acquires the image
+    if (transfersOwnership())
+    {
+        const vk::ImageMemoryBarrier release = layoutBarrier(vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eTransferWrite, {}, m_transferFamily, m_graphicsFamily);
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eBottomOfPipe, {}, nullptr, nullptr, release);
+
+        m_recordedImageAcquires.push_back(layoutBarrier(vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, {}, vk::AccessFlagBits::eShaderRead, m_transferFamily, m_graphicsFamily));
+    }
+    else
+    {
+        const vk::ImageMemoryBarrier toShader = layoutBarrier(vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead, vk::QueueFamilyIgnored, vk::QueueFamilyIgnored);
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, nullptr, nullptr, toShader);
+    }
+
+    return result;
+}
+
+void UploadManager::submit()
+{
+    if (!m_recording)
+        return;
+
+    m_recording.end();
+
+    const UInt64 value = m_lastSubmitted + 1;
+
+    const vk::TimelineSemaphoreSubmitInfo timelineInfo
+    {
+        .signalSemaphoreValueCount = 1,
+        .pSignalSemaphoreValues = &value,
+    };
+
+    const vk::SubmitInfo submitInfo
+    {
+        .pNext = &timelineInfo,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &m_recording,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &m_timeline,
+    };
+
+    if (m_queue.submit(1, &submitInfo, nullptr) != vk::Result::eSuccess)
+    {
+        fatalError("failed to submit uploads!");
+    }
+
+    m_lastSubmitted = value;
+    m_submissions.push_back({.value = value, .commandBuffer = m_recording, .ringEnd = m_head, .oversized = std::move(m_recordingOversized)});
+    m_recording = nullptr;
+    m_recordingOversized.clear();
+
+    m_bufferAcquires.insert(m_bufferAcquires.end(), m_recordedBufferAcquires.begin(), m_recordedBufferAcquires.end());
+    m_imageAcquires.insert(m_imageAcquires.end(), m_recordedImageAcquires.begin(), m_recordedImageAcquires.end());
+    m_recordedBufferAcquires.clear();
+    m_recordedImageAcquires.clear();
+}
+
+UInt64 UploadManager::acquire(vk::CommandBuffer commandBuffer)
+{
+    if (!m_bufferAcquires.empty() || !m_imageAcquires.empty())
+    {
+        commandBuffer.pipelineBarrier(consumerStages, consumerStages, {}, nullptr, m_bufferAcquires, m_imageAcquires);
+        m_bufferAcquires.clear();
+        m_imageAcquires.clear();
+    }
+
+    reclaim(false);
+
+    if (m_lastAcquired == m_lastSubmitted)
+        return 0;
+
+    m_lastAcquired = m_lastSubmitted;
+    return m_lastSubmitted;
+}
+
+// Copies the data into the ring, waiting for the oldest submissions when it's full
+UploadManager::Staging UploadManager::stage(const void* data, vk::DeviceSize size)
+{
+    if (size > m_ringSize)
+    {
+        const RenderUtils::CreateBufferInfo stagingInfo
+        {
+            .device = m_device,
+            .allocator = m_allocator,
+            .size = size,
+            .usage = vk::BufferUsageFlagBits::eTransferSrc,
+            .properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
+            .strategy = AllocationStrategy::Linear,
+        };
+
+        StagingBuffer& staging = m_recordingOversized.emplace_back();
+        std::tie(staging.buffer, staging.allocation) = RenderUtils::createBuffer(stagingInfo);
+        std::memcpy(staging.allocation.mapped, data, size);
+        return {staging.buffer, 0};
+    }
+
+    vk::DeviceSize offset{};
+    while (!tryAllocate(size, offset))
+    {
+        submit();
+        reclaim(true);
+    }
+
+    std::memcpy(m_ring.allocation.mapped + offset, data, size);
+    return {m_ring.buffer, offset};
+}
+
+bool UploadManager::tryAllocate(vk::DeviceSize size, vk::DeviceSize& offset)
+{
+    const vk::DeviceSize aligned = alignStaging(m_head);
+
+    // Used space is [tail, head): fits before the end, or wraps around to the start
+    if (m_head >= m_tail)
+    {
+        if (aligned + size <= m_ringSize)
+            offset = aligned;
+        else if (size < m_tail)
+            offset = 0;
+        else
+            return false;
+    }
+    // Used space is [tail, end) and [0, head): fits between them. Head never catches up with the tail, so the two
+    // only meet when the ring is empty.
+    else if (aligned + size < m_tail)
+    {
+        offset = aligned;
+    }
+    else
+    {
+        return false;
+    }
+
+    m_head = offset + size;
+    return true;
+}
+
+vk::CommandBuffer UploadManager::getCommandBuffer()
+{
+    if (m_recording)
+        return m_recording;
+
+    if (m_freeCommandBuffers.empty())
+    {
+        const vk::CommandBufferAllocateInfo allocInfo
+        {
+            .commandPool = m_commandPool,
+            .level = vk::CommandBufferLevel::ePrimary,
+            .commandBufferCount = 1,
+        };
+
+        m_freeCommandBuffers.push_back(m_device.allocateCommandBuffers(allocInfo).front());
+    }
+
+    m_recording = m_freeCommandBuffers.back();
+    m_freeCommandBuffers.pop_back();
+
+    constexpr vk::CommandBufferBeginInfo beginInfo
+    {
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+    };
+    m_recording.begin(beginInfo);
+
+    return m_recording;
+}
+
+// Submissions complete in order, so the ring's tail follows the last completed one
+void UploadManager::reclaim(bool waitForOldest)
+{
+    if (waitForOldest && !m_submissions.empty())
+    {
+        const UInt64 value = m_submissions.front().value;
+
+        const vk::SemaphoreWaitInfo waitInfo
+        {
+            .semaphoreCount = 1,
+            .pSemaphores = &m_timeline,
+            .pValues = &value,
+        };
+
+        if (m_device.waitSemaphores(waitInfo, std::numeric_limits<UInt64>::max()) != vk::Result::eSuccess)
+        {
+            fatalError("failed to wait for uploads!");
+        }
+    }
+
+    const UInt64 completed = m_submissions.empty() ? m_lastSubmitted : m_device.getSemaphoreCounterValue(m_timeline);
+
+    while (!m_submissions.empty() && m_submissions.front().value <= completed)
+    {
+        Submission& submission = m_submissions.front();
+        m_tail = submission.ringEnd;
+        m_freeCommandBuffers.push_back(submission.commandBuffer);
+
+        for (StagingBuffer& staging : submission.oversized)
+        {
+            m_device.destroyBuffer(staging.buffer);
+            m_allocator->free(staging.allocation);
+        }
+
+        m_submissions.pop_front();
+    }
+
+    if (m_submissions.empty() && !m_recording)
+    {
+        m_head = 0;
+        m_tail = 0;
+    }
+}
@@ -0,0 +1,106 @@
+export module Render.UploadManager;
+import Assets.Texture;
+import Core;
+import Render.MemoryAllocator;
+import Render.Vulkan;
+
+// Uploads buffer and texture data through one persistently mapped staging ring. Copies are recorded as they're
+// requested and submitted to the transfer queue together once per frame, signalling a timeline semaphore that the
+// graphics submission waits on, so the render thread never waits on the GPU for an upload. Staging space is reclaimed
+// as the timeline passes each submission, and only a full ring waits for the oldest one.
+// When the transfer queue belongs to another family than the graphics queue, every destination is released by the
+// transfer queue and acquired by the graphics queue in the frame that first waits for it.
+// Only used from the render thread.
+export class UploadManager
+{
+public:
+    static constexpr vk::DeviceSize defaultRingSize = 64 * 1024 * 1024;
+
+    // Where the graphics submission waits for the timeline, and where acquired resources are first used
+    static constexpr vk::PipelineStageFlags consumerStages = vk::PipelineStageFlagBits::eVertexInput | vk::PipelineStageFlagBits::eFragmentShader;
+
+    void init(vk::Device device, GpuAllocator& allocator, vk::Queue transferQueue, UInt32 transferFamily, UInt32 graphicsFamily, vk::DeviceSize ringSize = defaultRingSize);
+
+    // Waits for every submission, only call while shutting down
+    void shutdown();
+
+    // Submits and waits for every copy, dropping acquires that haven't been recorded yet. Only call when every
+    // uploaded resource is about to be destroyed.
+    void clear();
+
+    // Creates a device local buffer and records the copy of the data into it
+    [[nodiscard]] std::tuple<vk::Buffer, GpuAllocation> createBuffer(const void* data, vk::DeviceSize size, vk::BufferUsageFlags usage);
+
+    template <typename T>
+    [[nodiscard]] std::tuple<vk::Buffer, GpuAllocation> createBuffer(const std::vector<T>& data, vk::BufferUsageFlags usage)
+    {
+        return createBuffer(data.data(), sizeof(T) * data.size(), usage);
+    }
+
+    // Creates a sampled image, in shader read only layout once the copy is done
+    [[nodiscard]] std::tuple<vk::Image, GpuAllocation> createTexture(const TextureData& data);
+
+    // Submits the copies recorded since the last call in one batch
+    void submit();
+
+    // Records the graphics queue's half of the ownership transfers submitted so far. Returns the timeline value the
+    // graphics submission has to wait on, or 0 when there's nothing new to wait for.
+    [[nodiscard]] UInt64 acquire(vk::CommandBuffer commandBuffer);
+
+    [[nodiscard]] vk::Semaphore getTimeline() const { return m_timeline; }
+
+private:
+    struct StagingBuffer
+    {
+        vk::Buffer buffer{};
+        GpuAllocation allocation{};
+    };
+
+    struct Submission
+    {
+        UInt64 value{};
+        vk::CommandBuffer commandBuffer{};
+        vk::DeviceSize ringEnd{}; // The ring is in use up to here until the submission completes
+        std::vector<StagingBuffer> oversized; // Uploads too big for the ring get their own staging buffer
+    };
+
+    struct Staging
+    {
+        vk::Buffer buffer{};
+        vk::DeviceSize offset{};
+    };
+
+    [[nodiscard]] Staging stage(const void* data, vk::DeviceSize size);
+    [[nodiscard]] bool tryAllocate(vk::DeviceSize size, vk::DeviceSize& offset);
+    [[nodiscard]] vk::CommandBuffer getCommandBuffer();
+    void reclaim(bool waitForOldest);
+
+    [[nodiscard]] bool transfersOwnership() const { return m_transferFamily != m_graphicsFamily; }
+
+    vk::Device m_device{};
+    GpuAllocator* m_allocator{};
+    vk::Queue m_queue{};
+    UInt32 m_transferFamily{};
+    UInt32 m_graphicsFamily{};
+
+    StagingBuffer m_ring{};
+    vk::DeviceSize m_ringSize{};
+    vk::DeviceSize m_head{}; // Next free byte
+    vk::DeviceSize m_tail{}; // Oldest byte still in use
+
+    vk::Semaphore m_timeline{};
+    UInt64 m_lastSubmitted{};
+    UInt64 m_lastAcquired{};
+
+    vk::CommandPool m_commandPool{};
+    std::vector<vk::CommandBuffer> m_freeCommandBuffers;
+    vk::CommandBuffer m_recording{};
+    std::vector<StagingBuffer> m_recordingOversized;
+    std::deque<Submission> m_submissions;
+
+    // Acquire barriers of releases recorded but not submitted yet, and of those submitted but not acquired yet
+    std::vector<vk::BufferMemoryBarrier> m_recordedBufferAcquires;
+    std::vector<vk::ImageMemoryBarrier> m_recordedImageAcquires;
+    std::vector<vk::BufferMemoryBarrier> m_bufferAcquires;
+    std::vector<vk::ImageMemoryBarrier> m_imageAcquires;
+};
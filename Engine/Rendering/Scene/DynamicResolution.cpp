@@ -0,0 +1,38 @@
+module Render.DynamicResolution;
+
+float RenderScaleController::update(float frameTime)
+{
+    if (!m_settings.enabled)
+    {
+        m_scale = m_settings.maxScale;
+        return m_scale;
+    }
+
+    m_smoothedFrameTime = m_smoothedFrameTime == 0.f ? frameTime : std::lerp(m_smoothedFrameTime, frameTime, smoothing);
+
+    if (++m_framesSinceChange < m_settings.cooldownFrames)
+        return m_scale;
+
+    float scale = m_scale;
+    if (m_smoothedFrameTime > m_settings.targetFrameTime)
+        scale = std::max(m_settings.minScale, m_scale - m_settings.step);
+    else if (m_smoothedFrameTime < m_settings.targetFrameTime * m_settings.headroom)
+        scale = std::min(m_settings.maxScale, m_scale + m_settings.step);
+
+    if (scale != m_scale)
+    {
+        m_scale = scale;
+        m_framesSinceChange = 0;
+    }
+
+    return m_scale;
+}
+
+void RenderScaleController::setSettings(const DynamicResolutionSettings& settings)
+{
+    check(settings.minScale > 0.f && settings.minScale <= settings.maxScale, "[RenderScaleController] Invalid scale range!", ErrorType::Warning);
+
+    m_settings = settings;
+    m_scale = std::clamp(m_scale, m_settings.minScale, m_settings.maxScale);
+    m_framesSinceChange = 0;
+}
@@ -0,0 +1,38 @@
+export module Render.DynamicResolution;
+import Core;
+
+export struct DynamicResolutionSettings
+{
+    bool enabled{true};
+    float targetFrameTime{1.f / 120.f}; // Seconds of GPU time per frame, leaving room for a second viewport at 60Hz
+    float minScale{0.5f};
+    float maxScale{1.f};
+    float step{0.125f};     // Scale change per adjustment, so images are reallocated in a few coarse sizes
+    float headroom{0.8f};   // Only scales up once frames take less than this fraction of the target
+    UInt32 cooldownFrames{30}; // Frames to wait after an adjustment, until its effect shows in the frame time
+};
+
+// Picks a viewport's render scale from the GPU time it took to render. The time is smoothed, and the scale only drops
+// while frames are over the target and only rises while they're comfortably under it, so a frame time near the target
+// never makes the scale, and with it the viewport's images, flip back and forth.
+export class RenderScaleController
+{
+public:
+    RenderScaleController() = default;
+    explicit RenderScaleController(const DynamicResolutionSettings& settings) : m_settings{settings} {}
+
+    // Returns the scale to render the next frame at
+    float update(float frameTime);
+
+    void setSettings(const DynamicResolutionSettings& settings);
+    [[nodiscard]] const DynamicResolutionSettings& getSettings() const { return m_settings; }
+    [[nodiscard]] float getScale() const { return m_scale; }
+
+private:
+    static constexpr float smoothing = 0.1f;
+
+    DynamicResolutionSettings m_settings;
+    float m_smoothedFrameTime{};
+    float m_scale{1.f};
+    UInt32 m_framesSinceChange{};
+};
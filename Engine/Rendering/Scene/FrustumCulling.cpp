@@ -0,0 +1,107 @@
+module Render.FrustumCulling;
+import Simd;
+
+Frustum Frustum::fromViewProjection(const Mat4& viewProjection)
+{
+    // Gribb-Hartmann: each plane is a sum or difference of the fourth row and another row of the matrix
+    auto row = [&](Int32 index)
+    {
+        return Vec4{viewProjection[0][index], viewProjection[1][index], viewProjection[2][index], viewProjection[3][index]};
+    };
+
+    const Vec4 x = row(0);
+    const Vec4 y = row(1);
+    const Vec4 z = row(2);
+    const Vec4 w = row(3);
+
+    // The near plane is taken for a [-1, 1] depth range, which for [0, 1] only keeps a little more than needed
+    return {{w + x, w - x, w + y, w - y, w + z, w - z}};
+}
+
+void FrustumCuller::clear()
+{
+    for (std::size_t axis = 0; axis < 3; ++axis)
+    {
+        m_centers[axis].clear();
+        m_extents[axis].clear();
+    }
+    m_count = 0;
+}
+
+void FrustumCuller::addBox(const Vec3& center, const Vec3& extents)
+{
+    for (Int32 axis = 0; axis < 3; ++axis)
+    {
+        m_centers[axis].push_back(center[axis]);
+        m_extents[axis].push_back(extents[axis]);
+    }
+    m_count++;
+}
+
+CullingStats FrustumCuller::cull(const Frustum& frustum, JobSystem* jobs)
+{
+    if (m_count == 0)
+        return {};
+
+    // Pad to whole batches, the padding's results are never read
+    const std::size_t batchCount = (m_count + Float4::width - 1) / Float4::width;
+    for (std::size_t axis = 0; axis < 3; ++axis)
+    {
+        m_centers[axis].resize(batchCount * Float4::width);
+        m_extents[axis].resize(batchCount * Float4::width);
+    }
+    m_visible.resize(batchCount * Float4::width);
+
+    auto cullRange = [&](std::size_t begin, std::size_t end) { cullBatches(frustum, begin, end); };
+
+    if (jobs)
+        jobs->parallelFor(batchCount, grainSize / Float4::width, cullRange);
+    else
+        cullRange(0, batchCount);
+
+    const auto visible = static_cast<UInt32>(std::count(m_visible.begin(), m_visible.begin() + m_count, UInt8{1}));
+    return {.visible = visible, .culled = static_cast<UInt32>(m_count) - visible};
+}
+
+// A box is outside when it's entirely behind one of the planes: its center's distance plus its projected radius is
+// negative
+void FrustumCuller::cullBatches(const Frustum& frustum, std::size_t firstBatch, std::size_t lastBatch)
+{
+    const Float4 zero = Float4::broadcast(0.f);
+
+    for (std::size_t batch = firstBatch; batch < lastBatch; ++batch)
+    {
+        const std::size_t first = batch * Float4::width;
+
+        const Float4 centerX = Float4::load(&m_centers[0][first]);
+        const Float4 centerY = Float4::load(&m_centers[1][first]);
+        const Float4 centerZ = Float4::load(&m_centers[2][first]);
+        const Float4 extentX = Float4::load(&m_extents[0][first]);
+        const Float4 extentY = Float4::load(&m_extents[1][first]);
+        const Float4 extentZ = Float4::load(&m_extents[2][first]);
+
+        UInt32 inside = 0xF;
+
+        for (const Vec4& plane : frustum.planes)
+        {
+            const Float4 distance = Simd::add
+            (
+                Simd::add(Simd::mul(centerX, Float4::broadcast(plane.x)), Simd::mul(centerY, Float4::broadcast(plane.y))),
+                Simd::add(Simd::mul(centerZ, Float4::broadcast(plane.z)), Float4::broadcast(plane.w))
+            );
+
+            const Float4 radius = Simd::add
+            (
+                Simd::add(Simd::mul(extentX, Float4::broadcast(std::abs(plane.x))), Simd::mul(extentY, Float4::broadcast(std::abs(plane.y)))),
+                Simd::mul(extentZ, Float4::broadcast(std::abs(plane.z)))
+            );
+
+            inside &= Simd::moveMask(Simd::lessEqual(Simd::sub(zero, radius), distance));
+            if (!inside)
+                break;
+        }
+
+        for (std::size_t lane = 0; lane < Float4::width; ++lane)
+            m_visible[first + lane] = (inside >> lane) & 1;
+    }
+}
@@ -0,0 +1,51 @@
+export module Render.FrustumCulling;
+import Core;
+import Job;
+import Math;
+
+export struct Frustum
+{
+    // Left, right, bottom, top, near, far. The normals point inside and aren't normalised, which the box test allows
+    std::array<Vec4, 6> planes{};
+
+    [[nodiscard]] static Frustum fromViewProjection(const Mat4& viewProjection);
+};
+
+export struct CullingStats
+{
+    UInt32 visible{};  // Drawn
+    UInt32 culled{};   // Outside the frustum
+    UInt32 occluded{}; // Inside the frustum, hidden behind occluders
+
+    CullingStats& operator+=(const CullingStats& other)
+    {
+        visible += other.visible;
+        culled += other.culled;
+        occluded += other.occluded;
+        return *this;
+    }
+};
+
+// Tests axis aligned boxes against a frustum, four at a time. Boxes are stored as structure of arrays so each plane test
+// is a handful of SIMD operations per batch, and batches are spread across the job system's workers.
+export class FrustumCuller
+{
+public:
+    static constexpr std::size_t grainSize = 1024; // Boxes per parallel chunk
+
+    void clear();
+    void addBox(const Vec3& center, const Vec3& extents);
+
+    // Tests every box added since the last clear. Runs on the calling thread when no job system is given.
+    CullingStats cull(const Frustum& frustum, JobSystem* jobs);
+
+    [[nodiscard]] bool isVisible(std::size_t index) const { return m_visible[index]; }
+
+private:
+    void cullBatches(const Frustum& frustum, std::size_t firstBatch, std::size_t lastBatch);
+
+    std::array<std::vector<float>, 3> m_centers;
+    std::array<std::vector<float>, 3> m_extents;
+    std::vector<UInt8> m_visible;
+    std::size_t m_count{};
+};
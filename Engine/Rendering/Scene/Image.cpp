@@ -1,4 +1,5 @@
 module Render.Image;
+import Render.DeletionQueue;
 import Render.TextureLoading;
 
 Image::Image(VulkanContext& context, const ImageCreateInfo& info): VulkanResource{context}
@@ -19,10 +20,10 @@ void Image::recreate(const ImageCreateInfo& info)
 
 void Image::create(const ImageCreateInfo& info)
 {
-    std::tie(m_image, m_memory) = RenderUtils::createImage
+    std::tie(m_image, m_allocation) = RenderUtils::createImage
     (
         context().device,
-        context().physicalDevice,
+        *context().allocator,
         info.memoryProperties,
         info.extent,
         info.format,
@@ -33,14 +34,21 @@ void Image::create(const ImageCreateInfo& info)
     m_view = RenderUtils::createImageView(context().device, m_image, info.format, info.aspect);
 }
 
+// Recreated images may still be in use by frames in flight
 void Image::destroy()
 {
-    if (m_view)
-        context().device.destroyImageView(m_view);
+    context().deletionQueue->push([device = context().device, allocator = context().allocator, image = m_image, view = m_view, allocation = m_allocation]() mutable
+    {
+        if (view)
+            device.destroyImageView(view);
 
-    if (m_image)
-        context().device.destroyImage(m_image);
+        if (image)
+            device.destroyImage(image);
 
-    if (m_memory)
-        context().device.freeMemory(m_memory);
+        allocator->free(allocation);
+    });
+
+    m_image = nullptr;
+    m_view = nullptr;
+    m_allocation = {};
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 export module Render.Image;
 import Core;
+import Render.MemoryAllocator;
 import Render.VulkanResource;
 
 export struct ImageCreateInfo
@@ -32,6 +33,6 @@ private:
     void destroy();
 
     vk::Image m_image{};
-    vk::DeviceMemory m_memory{};
+    GpuAllocation m_allocation{};
     vk::ImageView m_view{};
 };
\ No newline at end of file
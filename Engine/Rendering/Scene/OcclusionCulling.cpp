@@ -0,0 +1,282 @@
+module Render.OcclusionCulling;
+import Simd;
+
+namespace
+{
+    // Below this clip space w a point is treated as behind the camera
+    constexpr float minClipW = 1e-5f;
+
+    // Depth runs from zero to one, so the near plane is at clip z = 0, in front of the camera plane at w = 0
+    bool isClippedByNearPlane(const Vec4& clip)
+    {
+        return clip.z < 0.f || clip.w < minClipW;
+    }
+
+    Vec3 toScreen(const Vec4& clip)
+    {
+        return
+        {
+            (clip.x / clip.w * 0.5f + 0.5f) * static_cast<float>(OcclusionCuller::width),
+            (clip.y / clip.w * 0.5f + 0.5f) * static_cast<float>(OcclusionCuller::height),
+            clip.z / clip.w,
+        };
+    }
+
+    Int32 toPixel(float coordinate, Int32 size)
+    {
+        return static_cast<Int32>(std::clamp(coordinate, 0.f, static_cast<float>(size)));
+    }
+
+    const Float4 laneOffsets = Float4::load(std::array{0.f, 1.f, 2.f, 3.f}.data());
+}
+
+void OcclusionCuller::beginFrame(const Mat4& viewProjection)
+{
+    m_viewProjection = viewProjection;
+    m_triangles.clear();
+    m_boxCenters.clear();
+    m_boxExtents.clear();
+}
+
+void OcclusionCuller::addOccluder(const MeshData& mesh, const Mat4& model)
+{
+    const Mat4 transform = m_viewProjection * model;
+
+    m_clipPositions.clear();
+    m_clipPositions.reserve(mesh.vertices.size());
+    for (const Vertex& vertex : mesh.vertices)
+        m_clipPositions.push_back(transform * Vec4{vertex.pos, 1.f});
+
+    for (std::size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+        addTriangle(m_clipPositions[mesh.indices[i]], m_clipPositions[mesh.indices[i + 1]], m_clipPositions[mesh.indices[i + 2]]);
+}
+
+void OcclusionCuller::addBox(const Vec3& center, const Vec3& extents)
+{
+    m_boxCenters.push_back(center);
+    m_boxExtents.push_back(extents);
+}
+
+UInt32 OcclusionCuller::cull(JobSystem* jobs)
+{
+    m_visible.assign(m_boxCenters.size(), 1);
+    if (m_triangles.empty() || m_boxCenters.empty())
+        return 0;
+
+    m_depth.assign(width * height, 1.f);
+    m_cellDepth.resize(cellsX * cellsY);
+
+    auto rasterizeTiles = [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t tile = begin; tile < end; ++tile)
+            rasterizeTile(static_cast<Int32>(tile));
+    };
+
+    auto testBoxes = [&](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t box = begin; box < end; ++box)
+            m_visible[box] = testBox(box);
+    };
+
+    // Tiles own disjoint pixels and cells, so they need no synchronisation. Testing only reads what they wrote.
+    if (jobs)
+    {
+        jobs->parallelFor(tilesX * tilesY, 1, rasterizeTiles);
+        jobs->parallelFor(m_boxCenters.size(), grainSize, testBoxes);
+    }
+    else
+    {
+        rasterizeTiles(0, tilesX * tilesY);
+        testBoxes(0, m_boxCenters.size());
+    }
+
+    return static_cast<UInt32>(std::ranges::count(m_visible, UInt8{0}));
+}
+
+// Both windings are kept: occluders are solid, so back faces are hidden behind front faces anyway, and skipping them
+// would make culling depend on how each mesh is wound
+void OcclusionCuller::addTriangle(const Vec4& a, const Vec4& b, const Vec4& c)
+{
+    if (isClippedByNearPlane(a) || isClippedByNearPlane(b) || isClippedByNearPlane(c))
+        return;
+
+    std::array vertices{toScreen(a), toScreen(b), toScreen(c)};
+
+    float area = (vertices[1].x - vertices[0].x) * (vertices[2].y - vertices[0].y)
+        - (vertices[2].x - vertices[0].x) * (vertices[1].y - vertices[0].y);
+
+    if (!(std::abs(area) > 0.f))
+        return;
+
+    if (area < 0.f)
+    {
+        std::swap(vertices[1], vertices[2]);
+        area = -area;
+    }
+
+    Triangle triangle
+    {
+        .minX = toPixel(std::floor(std::min({vertices[0].x, vertices[1].x, vertices[2].x})), width),
+        .minY = toPixel(std::floor(std::min({vertices[0].y, vertices[1].y, vertices[2].y})), height),
+        .maxX = toPixel(std::ceil(std::max({vertices[0].x, vertices[1].x, vertices[2].x})), width),
+        .maxY = toPixel(std::ceil(std::max({vertices[0].y, vertices[1].y, vertices[2].y})), height),
+    };
+
+    if (triangle.minX >= triangle.maxX || triangle.minY >= triangle.maxY)
+        return;
+
+    // Edge i runs from vertex i to the next one, and is proportional to the barycentric weight of the vertex opposite
+    for (std::size_t edge = 0; edge < 3; ++edge)
+    {
+        const Vec3& from = vertices[edge];
+        const Vec3& to = vertices[(edge + 1) % 3];
+        triangle.edgeX[edge] = from.y - to.y;
+        triangle.edgeY[edge] = to.x - from.x;
+        triangle.edgeConstant[edge] = -(triangle.edgeX[edge] * from.x + triangle.edgeY[edge] * from.y);
+    }
+
+    auto interpolate = [&](const std::array<float, 3>& edges)
+    {
+        return (edges[1] * vertices[0].z + edges[2] * vertices[1].z + edges[0] * vertices[2].z) / area;
+    };
+
+    triangle.depthX = interpolate(triangle.edgeX);
+    triangle.depthY = interpolate(triangle.edgeY);
+    triangle.depthConstant = interpolate(triangle.edgeConstant);
+
+    m_triangles.push_back(triangle);
+}
+
+// Pixels are covered when their center is inside the triangle, four at a time
+void OcclusionCuller::rasterizeTile(Int32 tile)
+{
+    const Int32 tileX = tile % tilesX * tileWidth;
+    const Int32 tileY = tile / tilesX * tileHeight;
+    const Float4 zero = Float4::broadcast(0.f);
+    const Float4 centerOffsets = Simd::add(laneOffsets, Float4::broadcast(0.5f));
+
+    for (const Triangle& triangle : m_triangles)
+    {
+        const Int32 minX = std::max(triangle.minX, tileX) & ~3;
+        const Int32 maxX = std::min(triangle.maxX, tileX + tileWidth);
+        const Int32 minY = std::max(triangle.minY, tileY);
+        const Int32 maxY = std::min(triangle.maxY, tileY + tileHeight);
+
+        if (minX >= maxX || minY >= maxY)
+            continue;
+
+        const std::array edgeX{Float4::broadcast(triangle.edgeX[0]), Float4::broadcast(triangle.edgeX[1]), Float4::broadcast(triangle.edgeX[2])};
+        const Float4 depthX = Float4::broadcast(triangle.depthX);
+
+        for (Int32 y = minY; y < maxY; ++y)
+        {
+            const float centerY = static_cast<float>(y) + 0.5f;
+            std::array<Float4, 3> rowEdges;
+            for (std::size_t edge = 0; edge < 3; ++edge)
+                rowEdges[edge] = Float4::broadcast(triangle.edgeY[edge] * centerY + triangle.edgeConstant[edge]);
+            const Float4 rowDepth = Float4::broadcast(triangle.depthY * centerY + triangle.depthConstant);
+
+            float* row = &m_depth[y * width];
+            for (Int32 x = minX; x < maxX; x += 4)
+            {
+                const Float4 centerX = Simd::add(Float4::broadcast(static_cast<float>(x)), centerOffsets);
+
+                Float4 inside = Simd::lessEqual(zero, Simd::add(Simd::mul(edgeX[0], centerX), rowEdges[0]));
+                inside = Simd::maskAnd(inside, Simd::lessEqual(zero, Simd::add(Simd::mul(edgeX[1], centerX), rowEdges[1])));
+                inside = Simd::maskAnd(inside, Simd::lessEqual(zero, Simd::add(Simd::mul(edgeX[2], centerX), rowEdges[2])));
+
+                if (!Simd::moveMask(inside))
+                    continue;
+
+                const Float4 depth = Simd::add(Simd::mul(depthX, centerX), rowDepth);
+                const Float4 current = Float4::load(row + x);
+                Simd::select(inside, Simd::min(current, depth), current).store(row + x);
+            }
+        }
+    }
+
+    for (Int32 cellY = tileY / cellSize; cellY < (tileY + tileHeight) / cellSize; ++cellY)
+    {
+        for (Int32 cellX = tileX / cellSize; cellX < (tileX + tileWidth) / cellSize; ++cellX)
+        {
+            Float4 farthest = zero;
+            for (Int32 y = cellY * cellSize; y < (cellY + 1) * cellSize; ++y)
+            {
+                for (Int32 x = cellX * cellSize; x < (cellX + 1) * cellSize; x += 4)
+                    farthest = Simd::max(farthest, Float4::load(&m_depth[y * width + x]));
+            }
+            m_cellDepth[cellY * cellsX + cellX] = Simd::reduceMax(farthest);
+        }
+    }
+}
+
+// A box is hidden when its nearest depth is behind the occluders on every pixel its screen rectangle covers. Cells whose
+// farthest depth is already in front of the box are skipped whole.
+bool OcclusionCuller::testBox(std::size_t index) const
+{
+    const Vec3& center = m_boxCenters[index];
+    const Vec3& extents = m_boxExtents[index];
+
+    float minX = std::numeric_limits<float>::max();
+    float minY = std::numeric_limits<float>::max();
+    float maxX = std::numeric_limits<float>::lowest();
+    float maxY = std::numeric_limits<float>::lowest();
+    float nearest = std::numeric_limits<float>::max();
+
+    for (Int32 corner = 0; corner < 8; ++corner)
+    {
+        const Vec3 offset{corner & 1 ? extents.x : -extents.x, corner & 2 ? extents.y : -extents.y, corner & 4 ? extents.z : -extents.z};
+        const Vec4 clip = m_viewProjection * Vec4{center + offset, 1.f};
+
+        // Crossing the near plane, the rectangle can't be trusted
+        if (isClippedByNearPlane(clip))
+            return true;
+
+        const Vec3 screen = toScreen(clip);
+        minX = std::min(minX, screen.x);
+        minY = std::min(minY, screen.y);
+        maxX = std::max(maxX, screen.x);
+        maxY = std::max(maxY, screen.y);
+        nearest = std::min(nearest, screen.z);
+    }
+
+    const Int32 x0 = toPixel(std::floor(minX), width);
+    const Int32 y0 = toPixel(std::floor(minY), height);
+    const Int32 x1 = toPixel(std::ceil(maxX), width);
+    const Int32 y1 = toPixel(std::ceil(maxY), height);
+
+    // Entirely off screen: leave it to the frustum test
+    if (x0 >= x1 || y0 >= y1)
+        return true;
+
+    const Float4 boxDepth = Float4::broadcast(nearest);
+    const Float4 first = Float4::broadcast(static_cast<float>(x0));
+    const Float4 last = Float4::broadcast(static_cast<float>(x1));
+
+    for (Int32 cellY = y0 / cellSize; cellY <= (y1 - 1) / cellSize; ++cellY)
+    {
+        for (Int32 cellX = x0 / cellSize; cellX <= (x1 - 1) / cellSize; ++cellX)
+        {
+            if (nearest > m_cellDepth[cellY * cellsX + cellX])
+                continue;
+
+            for (Int32 x = cellX * cellSize; x < (cellX + 1) * cellSize; x += 4)
+            {
+                if (x + 4 <= x0 || x >= x1)
+                    continue;
+
+                const Float4 pixelX = Simd::add(Float4::broadcast(static_cast<float>(x)), laneOffsets);
+                const Float4 inRange = Simd::maskAnd(Simd::lessEqual(first, pixelX), Simd::less(pixelX, last));
+
+                for (Int32 y = std::max(y0, cellY * cellSize); y < std::min(y1, (cellY + 1) * cellSize); ++y)
+                {
+                    const Float4 uncovered = Simd::lessEqual(boxDepth, Float4::load(&m_depth[y * width + x]));
+                    if (Simd::moveMask(Simd::maskAnd(uncovered, inRange)))
+                        return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
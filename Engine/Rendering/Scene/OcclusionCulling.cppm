@@ -0,0 +1,69 @@
+export module Render.OcclusionCulling;
+import Assets.Mesh;
+import Core;
+import Job;
+import Math;
+
+// Software occlusion culling. Occluder meshes are rasterized on the CPU into a small depth buffer, and boxes that are
+// behind it everywhere they cover are culled. The buffer is split into tiles rasterized in parallel, and each tile
+// keeps the farthest depth of its 8x8 cells, so most boxes are rejected without touching single pixels.
+// Depth is NDC depth ([0, 1], far is 1), which is linear in screen space for perspective and orthographic cameras alike.
+export class OcclusionCuller
+{
+public:
+    static constexpr Int32 width = 256;
+    static constexpr Int32 height = 128;
+    static constexpr Int32 tileWidth = 64;
+    static constexpr Int32 tileHeight = 32;
+    static constexpr Int32 cellSize = 8;
+    static constexpr std::size_t grainSize = 256; // Boxes per parallel chunk
+
+    // Clears the occluders and boxes of the previous frame
+    void beginFrame(const Mat4& viewProjection);
+
+    // Triangles crossing the near plane are skipped rather than clipped, so they never occlude anything
+    void addOccluder(const MeshData& mesh, const Mat4& model);
+    void addBox(const Vec3& center, const Vec3& extents);
+    [[nodiscard]] bool hasOccluders() const { return !m_triangles.empty(); }
+
+    // Rasterizes the occluders, then tests every box against them. Returns how many boxes were occluded.
+    // Runs on the calling thread when no job system is given.
+    UInt32 cull(JobSystem* jobs);
+
+    [[nodiscard]] bool isVisible(std::size_t index) const { return m_visible[index]; }
+
+private:
+    static constexpr Int32 tilesX = width / tileWidth;
+    static constexpr Int32 tilesY = height / tileHeight;
+    static constexpr Int32 cellsX = width / cellSize;
+    static constexpr Int32 cellsY = height / cellSize;
+
+    static_assert(width % tileWidth == 0 && height % tileHeight == 0);
+    static_assert(tileWidth % cellSize == 0 && tileHeight % cellSize == 0 && cellSize % 4 == 0);
+
+    // Set up once, then rasterized by every tile its bounds overlap
+    struct Triangle
+    {
+        std::array<float, 3> edgeX{}; // Edge functions: edgeX * x + edgeY * y + edgeConstant, non-negative inside
+        std::array<float, 3> edgeY{};
+        std::array<float, 3> edgeConstant{};
+        float depthX{};               // Depth plane: depthX * x + depthY * y + depthConstant
+        float depthY{};
+        float depthConstant{};
+        Int32 minX{}, minY{}, maxX{}, maxY{}; // Pixel bounds, max exclusive
+    };
+
+    void addTriangle(const Vec4& a, const Vec4& b, const Vec4& c);
+    void rasterizeTile(Int32 tile);
+    [[nodiscard]] bool testBox(std::size_t index) const;
+
+    Mat4 m_viewProjection{1};
+    std::vector<Triangle> m_triangles;
+    std::vector<Vec4> m_clipPositions; // Scratch, reused for every occluder
+    std::vector<float> m_depth;
+    std::vector<float> m_cellDepth; // Farthest depth of each cell
+
+    std::vector<Vec3> m_boxCenters;
+    std::vector<Vec3> m_boxExtents;
+    std::vector<UInt8> m_visible;
+};
@@ -1,35 +1,53 @@
 module Render.RenderObject;
 import AssetManager;
+import Render.Pipeline.Mesh;
 import Render.TextureLoading;
 import Render.Utils;
 
-template<typename T>
-auto findRenderObject(std::vector<T>& span, Entity entity)
-{
-    return std::ranges::find_if(span, [&](auto&& object) { return object.entity == entity; });
-}
-
 void RenderObjectManager::init
 (
     vk::Device device,
-    vk::PhysicalDevice physicalDevice,
-    vk::SurfaceKHR surface,
     vk::DescriptorPool descriptorPool,
-    vk::DescriptorSetLayout descriptorSetLayout,
-    vk::Queue queue,
-    vk::CommandPool cmdPool
+    vk::DescriptorSetLayout cameraSetLayout,
+    TextureTable& textureTable,
+    UploadManager& uploads,
+    GpuAllocator& allocator,
+    DeletionQueue& deletionQueue,
+    DescriptorCache& descriptors,
+    UniformRing& uniforms
 )
 {
     m_device = device;
-    m_physicalDevice = physicalDevice;
-    m_surface = surface;
     m_descriptorPool = descriptorPool;
-    m_descriptorSetLayout = descriptorSetLayout;
-    m_queue = queue;
-    m_cmdPool = cmdPool;
+    m_cameraSetLayout = cameraSetLayout;
+    m_textureTable = &textureTable;
+    m_uploads = &uploads;
+    m_allocator = &allocator;
+    m_deletionQueue = &deletionQueue;
+    m_descriptors = &descriptors;
+    m_uniforms = &uniforms;
     m_objects.reserve(100);
     m_meshes.reserve(100);
     m_textures.reserve(100);
+    createCameraDescriptorSets();
+}
+
+void RenderObjectManager::shutdown()
+{
+    clear();
+
+    if (m_cameraDescriptorSets.front())
+    {
+        m_deletionQueue->push([device = m_device, pool = m_descriptorPool, descriptors = m_descriptors, sets = m_cameraDescriptorSets]
+        {
+            for (const vk::DescriptorSet set : sets)
+                descriptors->forget(set);
+
+            const auto result = device.freeDescriptorSets(pool, static_cast<UInt32>(sets.size()), sets.data());
+            check(result == vk::Result::eSuccess, "[RenderObjectManager::shutdown] Failed to free camera descriptor sets!");
+        });
+        m_cameraDescriptorSets = {};
+    }
 }
 
 void RenderObjectManager::clear()
@@ -37,31 +55,34 @@ void RenderObjectManager::clear()
     m_meshMap.clear();
     m_textureMap.clear();
 
-    for (auto& span : m_objects | std::views::values)
-        for (auto& object : span)
-            removeRenderObject(object);
     m_objects.clear();
 
-    for (const LineRenderObject& lineObject : m_lineObjects)
-        removeLineRenderObject(lineObject);
+    for (LineRenderObject& object : m_lineObjects)
+        destroyLineBuffer(object);
     m_lineObjects.clear();
+    m_debugLines.clear();
 
-    for (const Mesh& mesh : m_meshes)
+    // Frames in flight may still draw with the meshes and textures, so they're destroyed once those have finished
+    m_deletionQueue->push([device = m_device, allocator = m_allocator, textureTable = m_textureTable, meshes = std::move(m_meshes), textures = std::move(m_textures)]() mutable
     {
-        m_device.destroyBuffer(mesh.vertexBuffer);
-        m_device.freeMemory(mesh.vertexBufferMemory);
-        m_device.destroyBuffer(mesh.indexBuffer);
-        m_device.freeMemory(mesh.indexBufferMemory);
-    }
-    m_meshes.clear();
+        for (Mesh& mesh : meshes)
+        {
+            device.destroyBuffer(mesh.vertexBuffer);
+            allocator->free(mesh.vertexAllocation);
+            device.destroyBuffer(mesh.indexBuffer);
+            allocator->free(mesh.indexAllocation);
+        }
 
-    for (const Texture& texture : m_textures)
-    {
-        m_device.destroySampler(texture.sampler);
-        m_device.destroyImageView(texture.view);
-        m_device.destroyImage(texture.image);
-        m_device.freeMemory(texture.memory);
-    }
+        for (Texture& texture : textures)
+        {
+            textureTable->remove(texture.tableIndex);
+            device.destroyImageView(texture.view);
+            device.destroyImage(texture.image);
+            allocator->free(texture.allocation);
+        }
+    });
+
+    m_meshes.clear();
     m_textures.clear();
 }
 
@@ -70,9 +91,11 @@ void RenderObjectManager::setCamera(const Camera& camera)
     m_camera = std::move(camera);
 }
 
-void RenderObjectManager::addRenderObject(Entity entity, const MeshData* mesh, const TextureData* texture, Mat4 transform, RenderLayer layer, Vec4 tint)
+void RenderObjectManager::addRenderObject(Entity entity, const MeshData* mesh, const TextureData* texture, Mat4 transform, RenderLayer layer, Vec4 tint, bool occluder)
 {
-    RenderObject object
+    check(!m_objects[layer].contains(entity), "Added a render object more than once!");
+
+    RenderObject& object = m_objects[layer].insert(entity, RenderObject
     {
         .entity = entity,
         .mesh = getOrCreateMesh(mesh),
@@ -80,211 +103,350 @@ void RenderObjectManager::addRenderObject(Entity entity, const MeshData* mesh, c
         .layer = layer,
         .tint = std::move(tint),
         .model = std::move(transform),
-        .uniformBuffers = std::vector<vk::Buffer>(MaxFramesInFlight),
-        .uniformBuffersMemory = std::vector<vk::DeviceMemory>(MaxFramesInFlight),
-        .uniformBuffersMapped = std::vector<void*>(MaxFramesInFlight),
-    };
-
-    static constexpr vk::DeviceSize bufferSize = sizeof(UniformBufferObject);
+        .occluder = occluder,
+    });
+    updateBounds(object);
+}
 
-    const RenderUtils::CreateBufferInfo bufferInfo
+void RenderObjectManager::removeRenderObject(Entity entity)
+{
+    for (SparseSet<RenderObject>& objects : m_objects | std::views::values)
     {
-        .device = m_device,
-        .physicalDevice = m_physicalDevice,
-        .size = bufferSize,
-        .usage = vk::BufferUsageFlagBits::eUniformBuffer,
-        .properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-    };
+        objects.erase(entity);
+    }
+}
 
-    auto bufferRange = std::views::zip(object.uniformBuffers, object.uniformBuffersMemory, object.uniformBuffersMapped);
+void RenderObjectManager::setObjectTransform(Entity entity, const Mat4& worldTransform)
+{
+    for (SparseSet<RenderObject>& objects : m_objects | std::views::values)
+    {
+        if (RenderObject* object = objects.find(entity))
+        {
+            object->model = worldTransform;
+            updateBounds(*object);
+        }
+    }
 
-    for (auto&& [buffer, memory, mapped] : bufferRange)
+    if (LineRenderObject* object = m_lineObjects.find(entity))
     {
-        std::tie(buffer, memory) = createBuffer(bufferInfo);
-        if (m_device.mapMemory(memory, 0, bufferSize, {}, &mapped) != vk::Result::eSuccess)
-            return;
+        object->model = worldTransform;
     }
+}
 
-    std::vector layouts(MaxFramesInFlight, m_descriptorSetLayout);
-    const vk::DescriptorSetAllocateInfo allocInfo
+void RenderObjectManager::setObjectTransforms(std::span<const RenderCommands::ObjectTransform> transforms)
+{
+    for (const auto& [entity, worldTransform] : transforms)
     {
-        .descriptorPool = m_descriptorPool,
-        .descriptorSetCount = static_cast<UInt32>(layouts.size()),
-        .pSetLayouts = layouts.data(),
-    };
+        setObjectTransform(entity, worldTransform);
+    }
+}
+
+void RenderObjectManager::addLineRenderObject(Entity entity, std::vector<LineVertex>&& vertices, Mat4 transform)
+{
+    check(!m_lineObjects.contains(entity), "Added a line render object more than once!");
+
+    LineRenderObject object;
+    object.entity = entity;
+    object.model = std::move(transform);
+    object.vertexCount = static_cast<UInt32>(vertices.size());
 
-    object.descriptorSets = m_device.allocateDescriptorSets(allocInfo);
+    if (!vertices.empty())
+    {
+        std::tie(object.vertexBuffer, object.vertexAllocation) = m_uploads->createBuffer(vertices, vk::BufferUsageFlagBits::eVertexBuffer);
+    }
 
-    m_objects[layer].emplace_back(std::move(object));
+    m_lineObjects.insert(entity, std::move(object));
+    log(std::format("Added debug render object for entity '{}'", entity));
 }
 
-void RenderObjectManager::removeRenderObject(Entity entity)
+void RenderObjectManager::removeLineRenderObject(Entity entity)
 {
-    for (auto& span : m_objects | std::views::values)
+    if (LineRenderObject* object = m_lineObjects.find(entity))
     {
-        if (auto it = findRenderObject(span, entity); it != span.end())
-        {
-            removeRenderObject(*it);
-            span.erase(it);
-        }
+        destroyLineBuffer(*object);
+        m_lineObjects.erase(entity);
     }
 }
 
-void RenderObjectManager::setObjectTransform(Entity entity, const Mat4& worldTransform)
+void RenderObjectManager::setDebugLines(std::vector<LineVertex>&& vertices)
 {
-    for (auto& span : m_objects | std::views::values)
+    m_debugLines = std::move(vertices);
+}
+
+void RenderObjectManager::setObjectVisibility(Entity entity, bool visible)
+{
+    for (SparseSet<RenderObject>& objects : m_objects | std::views::values)
     {
-        if (auto it = findRenderObject(span, entity); it != span.end())
+        if (RenderObject* object = objects.find(entity))
         {
-            it->model = worldTransform;
+            object->visible = visible;
+            return;
         }
     }
 
-    if (auto it = findRenderObject(m_lineObjects, entity); it != m_lineObjects.end())
+    if (LineRenderObject* object = m_lineObjects.find(entity))
     {
-        it->model = worldTransform;
+        object->visible = visible;
     }
 }
 
-void RenderObjectManager::addLineRenderObject(Entity entity, std::vector<LineVertex>&& vertices, Mat4 transform)
+namespace
 {
-    check(!std::ranges::any_of(m_lineObjects, [&](const LineRenderObject& object) { return object.entity == entity; }), "Added a line render object more than once!");
-
-    LineRenderObject object;
-
-    const RenderUtils::CreateDataBufferInfo vertexBufferInfo
+    // Draw key, from the most significant bits:
+    //   layer (4) | pipeline (4) | mesh (20) | texture (20) | depth (16)  for opaque layers, front to back
+    //   layer (4) | pipeline (4) | ~depth (16) | mesh (20) | texture (20)  for blended layers, back to front
+    // Sorting the keys groups opaque draws by mesh, so each mesh is bound and drawn once. Textures are indexed per
+    // instance from the texture table and no longer split draws, they only order instances within one.
+    constexpr UInt64 resourceBits = 20;
+    constexpr UInt64 resourceMask = (UInt64{1} << resourceBits) - 1;
+
+    enum class DrawPipeline : UInt64
     {
-        .device = m_device,
-        .physicalDevice = m_physicalDevice,
-        .surface = m_surface,
-        .usageType = vk::BufferUsageFlagBits::eVertexBuffer,
-        .transferQueue = m_queue,
-        .transferCommandPool = m_cmdPool,
+        Mesh,
+        Gizmo,
     };
 
-    object.entity = entity;
-    object.vertices = std::move(vertices);
-    object.model = std::move(transform);
-    object.uniformBuffers = std::vector<vk::Buffer>(MaxFramesInFlight);
-    object.uniformBuffersMemory = std::vector<vk::DeviceMemory>(MaxFramesInFlight);
-    object.uniformBuffersMapped = std::vector<void*>(MaxFramesInFlight);
-
-    std::tie(object.vertexBuffer, object.vertexBufferMemory) = createDataBuffer(object.vertices, vertexBufferInfo);
-
-    static constexpr vk::DeviceSize bufferSize = sizeof(UniformBufferObject);
+    DrawPipeline getPipeline(RenderLayer layer)
+    {
+        return layer == RenderLayer::Gizmo ? DrawPipeline::Gizmo : DrawPipeline::Mesh;
+    }
 
-    const RenderUtils::CreateBufferInfo bufferInfo
+    vk::Pipeline getPipeline(const RenderPipelineSet& pipelines, DrawPipeline pipeline)
     {
-        .device = m_device,
-        .physicalDevice = m_physicalDevice,
-        .size = bufferSize,
-        .usage = vk::BufferUsageFlagBits::eUniformBuffer,
-        .properties = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent,
-    };
+        return pipeline == DrawPipeline::Gizmo ? pipelines.gizmo : pipelines.mesh;
+    }
 
-    auto bufferRange = std::views::zip(object.uniformBuffers, object.uniformBuffersMemory, object.uniformBuffersMapped);
+    bool isBlended(RenderLayer layer)
+    {
+        return layer == RenderLayer::Gizmo;
+    }
 
-    for (auto&& [buffer, memory, mapped] : bufferRange)
+    // The bits of a non-negative float order the same way as its value, so the top 16 keep the order at lower precision
+    UInt64 getDepthBucket(const Mat4& view, const Mat4& model)
     {
-        std::tie(buffer, memory) = createBuffer(bufferInfo);
-        if (m_device.mapMemory(memory, 0, bufferSize, {}, &mapped) != vk::Result::eSuccess)
-            return;
+        const float viewDepth = -(view * model[3]).z;
+        return std::bit_cast<UInt32>(std::max(viewDepth, 0.f)) >> 16;
     }
 
-    std::vector layouts(MaxFramesInFlight, m_descriptorSetLayout);
-    const vk::DescriptorSetAllocateInfo allocInfo
+    UInt64 makeDrawKey(const RenderObject& object, const Mat4& view)
     {
-        .descriptorPool = m_descriptorPool,
-        .descriptorSetCount = static_cast<UInt32>(layouts.size()),
-        .pSetLayouts = layouts.data(),
-    };
+        const UInt64 prefix = static_cast<UInt64>(object.layer) << 60 | static_cast<UInt64>(getPipeline(object.layer)) << 56;
+        const UInt64 resources = (object.mesh & resourceMask) << resourceBits | (object.texture & resourceMask);
+        const UInt64 depth = getDepthBucket(view, object.model);
 
-    object.descriptorSets = m_device.allocateDescriptorSets(allocInfo);
+        if (isBlended(object.layer))
+            return prefix | (~depth & 0xFFFF) << 40 | resources;
 
-    m_lineObjects.emplace_back(std::move(object));
-    log(std::format("Added debug render object for entity '{}'", entity));
+        return prefix | resources << 16 | depth;
+    }
 }
 
-void RenderObjectManager::removeLineRenderObject(Entity entity)
+// Objects sharing a mesh are drawn together as one instanced draw, with their per-object data written contiguously
+// into the frame's ring buffer. Each instance carries its texture's index into the texture table.
+bool RenderObjectManager::prepareFrame(UInt32 frameIndex, JobSystem* jobs)
 {
-    if (auto it = findRenderObject(m_lineObjects, entity); it != m_lineObjects.end())
+    m_drawObjects.clear();
+    m_drawKeys.clear();
+    m_drawIndices.clear();
+    m_drawBatches.clear();
+    m_debugLineCount = 0;
+    m_culler.clear();
+
+    m_frameCameraSet = m_cameraDescriptorSets[frameIndex];
+    if (!m_frameCameraSet)
+        return false;
+
+    const UniformAllocation cameraAllocation = m_uniforms->allocate(sizeof(CameraUniforms));
+    if (!cameraAllocation.data)
+        return false;
+
+    const CameraUniforms uniforms{.view = m_camera.view, .proj = m_camera.proj};
+    std::memcpy(cameraAllocation.data, &uniforms, sizeof(CameraUniforms));
+    m_cameraOffset = cameraAllocation.offset;
+
+    if (!m_debugLines.empty())
     {
-        removeLineRenderObject(*it);
-        m_lineObjects.erase(it);
+        const std::size_t size = sizeof(LineVertex) * m_debugLines.size();
+        const UniformAllocation allocation = m_uniforms->allocate(size);
+        if (allocation.data)
+        {
+            std::memcpy(allocation.data, m_debugLines.data(), size);
+            m_debugLineOffset = allocation.offset;
+            m_debugLineCount = static_cast<UInt32>(m_debugLines.size());
+        }
     }
-}
 
-void RenderObjectManager::setObjectVisibility(Entity entity, bool visible)
-{
-    for (auto& span : m_objects | std::views::values)
+    for (const SparseSet<RenderObject>& objects : m_objects | std::views::values)
     {
-        if (auto it = findRenderObject(span, entity); it != span.end())
+        for (const RenderObject& object : objects)
         {
-            it->visible = visible;
-            return;
+            if (!object.visible || object.mesh >= m_meshes.size())
+                continue;
+
+            m_culler.addBox(object.boundsCenter, object.boundsExtents);
+            m_drawObjects.push_back(&object);
+        }
+    }
+
+    const Mat4 viewProjection = m_camera.proj * m_camera.view;
+    m_cullingStats = m_culler.cull(Frustum::fromViewProjection(viewProjection), jobs);
+
+    m_occlusionCuller.beginFrame(viewProjection);
+    for (std::size_t i = 0; i < m_drawObjects.size(); ++i)
+    {
+        if (!m_culler.isVisible(i))
+            continue;
+
+        const RenderObject& object = *m_drawObjects[i];
+        if (object.occluder && !isBlended(object.layer))
+            m_occlusionCuller.addOccluder(*m_meshes[object.mesh].data, object.model);
+
+        m_drawIndices.push_back(static_cast<UInt32>(i));
+    }
+
+    // Blended layers draw over the world, so only opaque objects can be hidden
+    if (m_occlusionCuller.hasOccluders())
+    {
+        for (const UInt32 index : m_drawIndices)
+        {
+            const RenderObject& object = *m_drawObjects[index];
+            if (!isBlended(object.layer))
+                m_occlusionCuller.addBox(object.boundsCenter, object.boundsExtents);
+        }
+
+        m_cullingStats.occluded = m_occlusionCuller.cull(jobs);
+        m_cullingStats.visible -= m_cullingStats.occluded;
+
+        std::size_t box = 0;
+        std::size_t kept = 0;
+        for (const UInt32 index : m_drawIndices)
+        {
+            if (isBlended(m_drawObjects[index]->layer) || m_occlusionCuller.isVisible(box++))
+                m_drawIndices[kept++] = index;
         }
+        m_drawIndices.resize(kept);
     }
 
-    if (auto it = findRenderObject(m_lineObjects, entity); it != m_lineObjects.end())
+    for (const UInt32 index : m_drawIndices)
+        m_drawKeys.push_back(makeDrawKey(*m_drawObjects[index], m_camera.view));
+
+    if (m_drawIndices.empty())
+        return true;
+
+    check(m_meshes.size() <= resourceMask && m_textures.size() <= resourceMask, "[RenderObjectManager] Too many meshes or textures for the draw keys!");
+
+    m_sorter.sort(m_drawKeys, m_drawIndices);
+
+    const UniformAllocation allocation = m_uniforms->allocate(sizeof(MeshInstanceData) * m_drawIndices.size());
+    if (!allocation.data)
+        return true;
+
+    m_instanceOffset = allocation.offset;
+
+    auto* instances = static_cast<MeshInstanceData*>(allocation.data);
+    for (std::size_t i = 0; i < m_drawIndices.size(); ++i)
     {
-        it->visible = visible;
+        const RenderObject& object = *m_drawObjects[m_drawIndices[i]];
+        const Texture& texture = m_textures[object.texture];
+        instances[i] =
+        {
+            .model = object.model,
+            .tint = object.tint,
+            .texture = texture.tableIndex,
+            .sampler = static_cast<UInt32>(texture.sampler),
+        };
     }
+
+    for (std::size_t first = 0; first < m_drawIndices.size();)
+    {
+        const RenderObject& object = *m_drawObjects[m_drawIndices[first]];
+
+        std::size_t last = first + 1;
+        while (last < m_drawIndices.size())
+        {
+            const RenderObject& next = *m_drawObjects[m_drawIndices[last]];
+            if (next.layer != object.layer || next.mesh != object.mesh)
+                break;
+            ++last;
+        }
+
+        m_drawBatches.push_back({.layer = object.layer, .mesh = object.mesh, .firstInstance = static_cast<UInt32>(first), .instanceCount = static_cast<UInt32>(last - first)});
+        first = last;
+    }
+
+    return true;
 }
 
-void RenderObjectManager::renderFrame
-(
-    RenderLayer layer,
-    vk::CommandBuffer commandBuffer,
-    vk::PipelineLayout pipelineLayout,
-    UInt32 currentFrame
-)
+// All pipelines share one layout, so the camera stays bound across pipeline switches
+void RenderObjectManager::bindCamera(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout) const
 {
-    auto it = m_objects.find(layer);
-    if (it == m_objects.end())
+    commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 0, 1, &m_frameCameraSet, 1, &m_cameraOffset);
+}
+
+void RenderObjectManager::recordDraws(vk::CommandBuffer commandBuffer, const RenderPipelineSet& pipelines, std::size_t firstBatch, std::size_t lastBatch) const
+{
+    if (firstBatch >= lastBatch)
         return;
 
-    for (RenderObject& object : it->second)
-    {
-        if (!object.visible)
-            continue;
+    bindCamera(commandBuffer, pipelines.layout);
+    m_textureTable->bind(commandBuffer, pipelines.layout, 1);
 
-        updateDescriptorSets(object);
+    const vk::DeviceSize instanceOffset = m_instanceOffset;
+    commandBuffer.bindVertexBuffers(1, {m_uniforms->getCurrentBuffer()}, {instanceOffset});
 
-        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 0, 1,
-            &object.descriptorSets[currentFrame], 0, nullptr);
+    std::optional<DrawPipeline> boundPipeline;
+    std::size_t boundMesh = std::numeric_limits<std::size_t>::max();
 
-        updateUniformBuffer(object, currentFrame);
+    for (const DrawBatch& batch : std::span{m_drawBatches}.subspan(firstBatch, lastBatch - firstBatch))
+    {
+        const DrawPipeline pipeline = getPipeline(batch.layer);
+        if (pipeline != boundPipeline)
+        {
+            commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, getPipeline(pipelines, pipeline));
+            boundPipeline = pipeline;
+        }
 
-        const Mesh& mesh = m_meshes[object.mesh];
-        constexpr vk::DeviceSize offsets[] = {0};
+        const Mesh& mesh = m_meshes[batch.mesh];
+        if (batch.mesh != boundMesh)
+        {
+            constexpr vk::DeviceSize offsets[] = {0};
+            commandBuffer.bindVertexBuffers(0, {mesh.vertexBuffer}, offsets);
+            commandBuffer.bindIndexBuffer(mesh.indexBuffer, 0, MeshData::indexType);
+            boundMesh = batch.mesh;
+        }
 
-        commandBuffer.bindVertexBuffers(0, {mesh.vertexBuffer}, offsets);
-        commandBuffer.bindIndexBuffer(mesh.indexBuffer, 0, MeshData::indexType);
-        commandBuffer.drawIndexed(mesh.indexCount, 1, 0, 0, 0);
+        commandBuffer.drawIndexed(mesh.indexCount, batch.instanceCount, 0, 0, batch.firstInstance);
     }
 }
 
-void RenderObjectManager::renderLineFrame(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout, UInt32 currentFrame)
+// Line objects keep their vertices in their own buffers. Debug lines change every frame, so they're written into the
+// frame's ring buffer instead, where a frame in flight never sees them change.
+void RenderObjectManager::recordLines(vk::CommandBuffer commandBuffer, const RenderPipelineSet& pipelines) const
 {
-    for (LineRenderObject& object : m_lineObjects)
+    bindCamera(commandBuffer, pipelines.layout);
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipelines.line);
+
+    for (const LineRenderObject& object : m_lineObjects)
     {
-        if (!object.visible)
+        if (!object.visible || !object.vertexBuffer)
             continue;
 
-        RenderUtils::updateBuffer(object.vertices, m_device, object.vertexBufferMemory); // TODO(perf): Shouldn't need to do this every frame
+        const ObjectPushConstants constants{.model = object.model};
+        commandBuffer.pushConstants(pipelines.layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(ObjectPushConstants), &constants);
 
-        updateLineDescriptorSets(object);
+        constexpr vk::DeviceSize offsets[] = {0};
+        commandBuffer.bindVertexBuffers(0, {object.vertexBuffer}, offsets);
+        commandBuffer.draw(object.vertexCount, 1, 0, 0);
+    }
 
-        commandBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipelineLayout, 0, 1,
-                                         &object.descriptorSets[currentFrame], 0, nullptr);
+    if (m_debugLineCount == 0)
+        return;
 
-        const vk::Buffer vertexBuffers[] = {object.vertexBuffer};
-        constexpr vk::DeviceSize offsets[] = {0};
+    static constexpr ObjectPushConstants identity{.model = Mat4{1}};
+    commandBuffer.pushConstants(pipelines.layout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(ObjectPushConstants), &identity);
 
-        updateUniformBuffer(object, currentFrame);
-        commandBuffer.bindVertexBuffers(0, vertexBuffers, offsets);
-        commandBuffer.draw(static_cast<UInt32>(object.vertices.size()), 1, 0, 0);
-    }
+    commandBuffer.bindVertexBuffers(0, {m_uniforms->getCurrentBuffer()}, {vk::DeviceSize{m_debugLineOffset}});
+    commandBuffer.draw(m_debugLineCount, 1, 0, 0);
 }
 
 std::size_t RenderObjectManager::getOrCreateMesh(const MeshData* mesh)
@@ -299,208 +461,146 @@ std::size_t RenderObjectManager::getOrCreateMesh(const MeshData* mesh)
     Mesh& renderMesh = m_meshes.emplace_back();
     renderMesh.id = m_meshes.size() - 1;
 
-    const RenderUtils::CreateDataBufferInfo vertexBufferInfo
-    {
-        .device = m_device,
-        .physicalDevice = m_physicalDevice,
-        .surface = m_surface,
-        .usageType = vk::BufferUsageFlagBits::eVertexBuffer,
-        .transferQueue = m_queue,
-        .transferCommandPool = m_cmdPool,
-    };
-    std::tie(renderMesh.vertexBuffer, renderMesh.vertexBufferMemory) = createDataBuffer(mesh->vertices, vertexBufferInfo);
-
-    const RenderUtils::CreateDataBufferInfo indexBufferInfo
-    {
-        .device = m_device,
-        .physicalDevice = m_physicalDevice,
-        .surface = m_surface,
-        .usageType = vk::BufferUsageFlagBits::eIndexBuffer,
-        .transferQueue = m_queue,
-        .transferCommandPool = m_cmdPool,
-    };
-    std::tie(renderMesh.indexBuffer, renderMesh.indexBufferMemory) = createDataBuffer(mesh->indices, indexBufferInfo);
+    // Recorded now, copied on the transfer queue before the frame that first draws the mesh
+    std::tie(renderMesh.vertexBuffer, renderMesh.vertexAllocation) = m_uploads->createBuffer(mesh->vertices, vk::BufferUsageFlagBits::eVertexBuffer);
+    std::tie(renderMesh.indexBuffer, renderMesh.indexAllocation) = m_uploads->createBuffer(mesh->indices, vk::BufferUsageFlagBits::eIndexBuffer);
 
     renderMesh.indexCount = mesh->indices.size();
+    renderMesh.data = mesh;
+
+    Vec3 boundsMin = mesh->vertices.front().pos;
+    Vec3 boundsMax = boundsMin;
+    for (const Vertex& vertex : mesh->vertices)
+    {
+        boundsMin = Math::min(boundsMin, vertex.pos);
+        boundsMax = Math::max(boundsMax, vertex.pos);
+    }
+    renderMesh.boundsCenter = (boundsMin + boundsMax) * 0.5f;
+    renderMesh.boundsExtents = (boundsMax - boundsMin) * 0.5f;
 
     m_meshMap.emplace(mesh, renderMesh.id);
 
     return renderMesh.id;
 }
 
+// Transforms the mesh's local box and takes the box enclosing it
+void RenderObjectManager::updateBounds(RenderObject& object) const
+{
+    if (object.mesh >= m_meshes.size())
+        return;
+
+    const Mesh& mesh = m_meshes[object.mesh];
+    object.boundsCenter = Vec3{object.model * Vec4{mesh.boundsCenter, 1.f}};
+
+    const Mat3 absolute{Math::abs(Vec3{object.model[0]}), Math::abs(Vec3{object.model[1]}), Math::abs(Vec3{object.model[2]})};
+    object.boundsExtents = absolute * mesh.boundsExtents;
+}
+
 std::size_t RenderObjectManager::getOrCreateTexture(const TextureData* texture)
 {
+    // The default entry needs no image of its own
+    if (m_textures.empty())
+        m_textures.emplace_back();
+
+    if (!texture)
+        return defaultTexture;
+
     if (auto it = m_textureMap.find(texture); it != m_textureMap.end())
         return it->second;
 
-    if (!texture)
+    // Failures are cached as the default texture, so a broken texture is only tried once
+    const TextureData& data = *texture;
+    const std::size_t byteCount = static_cast<std::size_t>(data.size.width) * static_cast<std::size_t>(data.size.height) * 4;
+    if (!check(byteCount > 0 && data.pixels.size() >= byteCount, "[RenderObjectManager] Tried to add texture with missing pixels", ErrorType::Warning))
     {
-        static const TextureData whiteTexture
-        {
-            .size = {1, 1},
-            .format = vk::Format::eR8G8B8A8Srgb,
-            .pixels = {255, 255, 255, 255}
-        };
-        texture = &whiteTexture;
+        m_textureMap.emplace(texture, defaultTexture);
+        return defaultTexture;
     }
 
-    const TextureData& data = *texture;
-
-    Texture& renderTexture = m_textures.emplace_back();
-    renderTexture.id = m_textures.size() - 1;
-    std::tie(renderTexture.image, renderTexture.memory) = RenderUtils::createTextureImage(data, m_device, m_physicalDevice, m_queue, m_cmdPool);
-
-    if (renderTexture.image)
+    // Recorded now, copied on the transfer queue before the frame that first draws the texture
+    auto [image, allocation] = m_uploads->createTexture(data);
+    if (!image)
     {
-        renderTexture.view = RenderUtils::createTextureImageView(m_device, renderTexture.image);
-        renderTexture.sampler = RenderUtils::createTextureSampler(m_device, m_physicalDevice);
-        m_textureMap.emplace(texture, renderTexture.id);
+        report("[RenderObjectManager] Failed to create texture image!");
+        m_textureMap.emplace(texture, defaultTexture);
+        return defaultTexture;
     }
 
-    return renderTexture.id;
-}
-
-void RenderObjectManager::updateDescriptorSets(const RenderObject& object) const
-{
-    const Texture* texture = m_textures.size() > object.texture ? &m_textures.at(object.texture) : nullptr;
-    const bool hasTexture = texture && texture->image;
-    const UInt32 descriptorWriteCount = static_cast<UInt32>(hasTexture) + 1;
+    const vk::ImageView view = RenderUtils::createTextureImageView(m_device, image);
+    const UInt32 tableIndex = m_textureTable->add(view);
 
-    for (std::size_t i = 0; i < MaxFramesInFlight; i++)
+    // The table reports when it is full. The upload is already recorded, so the image goes once it has run.
+    if (tableIndex == TextureTable::defaultIndex)
     {
-        std::array<vk::DescriptorBufferInfo, 1> bufferInfos;
-        std::array<vk::DescriptorImageInfo, 1> imageInfos;
-        std::array<vk::WriteDescriptorSet, 2> descriptorWrites;
-
-        bufferInfos[0] = vk::DescriptorBufferInfo
+        m_deletionQueue->push([device = m_device, allocator = m_allocator, image, allocation, view]() mutable
         {
-            .buffer = object.uniformBuffers[i],
-            .offset = 0,
-            .range = sizeof(UniformBufferObject),
-        };
-
-        descriptorWrites[0] = vk::WriteDescriptorSet
-        {
-            .dstSet = object.descriptorSets[i],
-            .dstBinding = 0,
-            .descriptorCount = 1,
-            .descriptorType = vk::DescriptorType::eUniformBuffer,
-            .pBufferInfo = &bufferInfos[0],
-        };
+            device.destroyImageView(view);
+            device.destroyImage(image);
+            allocator->free(allocation);
+        });
 
-        if (hasTexture)
-        {
-            imageInfos[0] = vk::DescriptorImageInfo
-            {
-                .sampler = texture->sampler,
-                .imageView = texture->view,
-                .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal,
-            };
-
-            descriptorWrites[1] = vk::WriteDescriptorSet
-            {
-                .dstSet = object.descriptorSets[i],
-                .dstBinding = 1,
-                .descriptorCount = 1,
-                .descriptorType = vk::DescriptorType::eCombinedImageSampler,
-                .pImageInfo = &imageInfos[0],
-            };
-        }
-
-        m_device.updateDescriptorSets
-        (
-            descriptorWriteCount,
-            descriptorWrites.data(),
-            0,
-            nullptr
-        );
+        m_textureMap.emplace(texture, defaultTexture);
+        return defaultTexture;
     }
-}
 
-// ReSharper disable once CppParameterMayBeConstPtrOrRef
-void RenderObjectManager::updateUniformBuffer(RenderObject& object, UInt32 currentImage)
-{
-    UniformBufferObject uniformBufferObject
+    Texture& renderTexture = m_textures.emplace_back(Texture
     {
-        .model = object.model,
-        .view = m_camera.view,
-        .proj = m_camera.proj,
-        .tint = object.tint
-    };
-
-    std::memcpy(object.uniformBuffersMapped[currentImage], &uniformBufferObject, sizeof(uniformBufferObject));
+        .id = m_textures.size(),
+        .image = image,
+        .allocation = allocation,
+        .view = view,
+        .tableIndex = tableIndex,
+    });
+
+    m_textureMap.emplace(texture, renderTexture.id);
+    return renderTexture.id;
 }
 
-void RenderObjectManager::updateUniformBuffer(LineRenderObject& object, UInt32 currentImage)
+// Written once: the camera binding is dynamic, so each frame only picks its offset into the ring buffer
+void RenderObjectManager::createCameraDescriptorSets()
 {
-    UniformBufferObject uniformBufferObject
+    std::array<vk::DescriptorSetLayout, MaxFramesInFlight> layouts;
+    layouts.fill(m_cameraSetLayout);
+
+    const vk::DescriptorSetAllocateInfo allocInfo
     {
-        .model = object.model,
-        .view = m_camera.view,
-        .proj = m_camera.proj,
+        .descriptorPool = m_descriptorPool,
+        .descriptorSetCount = static_cast<UInt32>(layouts.size()),
+        .pSetLayouts = layouts.data(),
     };
 
-    std::memcpy(object.uniformBuffersMapped[currentImage], &uniformBufferObject, sizeof(uniformBufferObject));
-}
+    if (m_device.allocateDescriptorSets(&allocInfo, m_cameraDescriptorSets.data()) != vk::Result::eSuccess)
+    {
+        report("[RenderObjectManager] Failed to allocate camera descriptor sets!");
+        m_cameraDescriptorSets = {};
+        return;
+    }
 
-void RenderObjectManager::updateLineDescriptorSets(const LineRenderObject& object) const
-{
     for (std::size_t i = 0; i < MaxFramesInFlight; i++)
     {
-        const vk::DescriptorBufferInfo vertexBufferInfo
+        const vk::DescriptorBufferInfo bufferInfo
         {
-            .buffer = object.uniformBuffers[i],
+            .buffer = m_uniforms->getBuffer(i),
             .offset = 0,
-            .range = sizeof(UniformBufferObject),
+            .range = sizeof(CameraUniforms),
         };
 
-        std::vector descriptorWrites
-        {
-            vk::WriteDescriptorSet
-            {
-                .dstSet = object.descriptorSets[i],
-                .dstBinding = 0,
-                .dstArrayElement = 0,
-                .descriptorCount = 1,
-                .descriptorType = vk::DescriptorType::eUniformBuffer,
-                .pBufferInfo = &vertexBufferInfo,
-            }
-        };
-
-        m_device.updateDescriptorSets
-        (
-            static_cast<UInt32>(descriptorWrites.size()),
-            descriptorWrites.data(),
-            0,
-            nullptr
-        );
+        m_descriptors->writeBuffer(m_cameraDescriptorSets[i], 0, vk::DescriptorType::eUniformBufferDynamic, bufferInfo);
     }
 }
 
-void RenderObjectManager::removeRenderObject(const RenderObject& object)
+// Frames in flight may still draw the lines
+void RenderObjectManager::destroyLineBuffer(LineRenderObject& object)
 {
-    for (auto&& [buffer, memory] : std::views::zip(object.uniformBuffers, object.uniformBuffersMemory))
-    {
-        m_device.destroyBuffer(buffer);
-        m_device.freeMemory(memory);
-    }
-
-    check(std::in_range<UInt32>(object.descriptorSets.size()), "Truncating value of object.descriptorSets.size() when freeing descriptor sets!");
-    auto result = m_device.freeDescriptorSets(m_descriptorPool, static_cast<UInt32>(object.descriptorSets.size()), object.descriptorSets.data());
-    check(result == vk::Result::eSuccess, "[RenderObjectManager::clear] Failed to free descriptor sets!");
-}
+    if (!object.vertexBuffer)
+        return;
 
-void RenderObjectManager::removeLineRenderObject(const LineRenderObject& object)
-{
-    for (auto&& [buffer, memory] : std::views::zip(object.uniformBuffers, object.uniformBuffersMemory))
+    m_deletionQueue->push([device = m_device, allocator = m_allocator, buffer = object.vertexBuffer, allocation = object.vertexAllocation]() mutable
     {
-        m_device.destroyBuffer(buffer);
-        m_device.freeMemory(memory);
-    }
-    m_device.destroyBuffer(object.vertexBuffer);
-    m_device.freeMemory(object.vertexBufferMemory);
+        device.destroyBuffer(buffer);
+        allocator->free(allocation);
+    });
 
-    check(std::in_range<UInt32>(object.descriptorSets.size()), "Truncating value of object.descriptorSets.size() when freeing descriptor sets!");
-    auto result = m_device.freeDescriptorSets(m_descriptorPool, static_cast<UInt32>(object.descriptorSets.size()), object.descriptorSets.data());
-    check(result == vk::Result::eSuccess, "[RenderObjectManager::clear] Failed to free descriptor sets!");
+    object.vertexBuffer = nullptr;
+    object.vertexAllocation = {};
 }
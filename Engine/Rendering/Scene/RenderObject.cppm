@@ -5,17 +5,30 @@ import Core;
 import Engine.Camera;
 import Guid;
 import Math;
+import Job;
+import RadixSort;
+import Render.Commands;
+import Render.DeletionQueue;
+import Render.DescriptorCache;
+import Render.FrustumCulling;
+import Render.MemoryAllocator;
+import Render.OcclusionCulling;
 import Render.RenderLayer;
+import Render.TextureTable;
+import Render.UniformRing;
+import Render.UploadManager;
 import Render.Vulkan;
-import ThreadSafeQueue;
+import Render.VulkanResource;
+import SparseSet;
 
 struct Texture
 {
     std::size_t id{};
     vk::Image image{};
-    vk::DeviceMemory memory{};
+    GpuAllocation allocation{};
     vk::ImageView view{};
-    vk::Sampler sampler{}; // TODO: should be shared between textures??
+    UInt32 tableIndex{TextureTable::defaultIndex}; // Until the texture has a slot of its own
+    SamplerType sampler{SamplerType::Linear};
 };
 
 struct Mesh
@@ -23,9 +36,12 @@ struct Mesh
     std::size_t id{};
     UInt32 indexCount{};
     vk::Buffer vertexBuffer{};
-    vk::DeviceMemory vertexBufferMemory{};
+    GpuAllocation vertexAllocation{};
     vk::Buffer indexBuffer{};
-    vk::DeviceMemory indexBufferMemory{};
+    GpuAllocation indexAllocation{};
+    const MeshData* data{}; // Kept for occluders, which are rasterized on the CPU
+    Vec3 boundsCenter{};  // Local space
+    Vec3 boundsExtents{};
 };
 
 struct LineMesh
@@ -33,15 +49,20 @@ struct LineMesh
     std::size_t id{};
     std::vector<LineVertex> vertices;
     vk::Buffer vertexBuffer{};
-    vk::DeviceMemory vertexBufferMemory{};
+    GpuAllocation vertexAllocation{};
 };
 
-struct UniformBufferObject
+// Written once per view and frame, shared by every draw of the view
+export struct CameraUniforms
 {
-    Mat4 model{};
     Mat4 view{};
     Mat4 proj{};
-    Vec4 tint{};
+};
+
+// Per-draw data of line objects, pushed straight into the command buffer. Meshes are instanced instead.
+export struct ObjectPushConstants
+{
+    Mat4 model{};
 };
 
 struct RenderObject
@@ -53,10 +74,18 @@ struct RenderObject
     RenderLayer layer{RenderLayer::World};
     Vec4 tint{1};
     Mat4 model{1};
-    std::vector<vk::Buffer> uniformBuffers;
-    std::vector<vk::DeviceMemory> uniformBuffersMemory;
-    std::vector<void*> uniformBuffersMapped;
-    std::vector<vk::DescriptorSet> descriptorSets;
+    bool occluder{};
+    Vec3 boundsCenter{};  // World space, follows the model matrix
+    Vec3 boundsExtents{};
+};
+
+// One instanced draw of a mesh, over a contiguous range of the frame's instance data
+struct DrawBatch
+{
+    RenderLayer layer{};
+    std::size_t mesh{};
+    UInt32 firstInstance{};
+    UInt32 instanceCount{};
 };
 
 struct LineRenderObject
@@ -64,13 +93,9 @@ struct LineRenderObject
     Entity entity{};
     bool visible{true};
     Mat4 model{1};
-    std::vector<LineVertex> vertices;
-    vk::Buffer vertexBuffer{};
-    vk::DeviceMemory vertexBufferMemory{};
-    std::vector<vk::Buffer> uniformBuffers;
-    std::vector<vk::DeviceMemory> uniformBuffersMemory;
-    std::vector<void*> uniformBuffersMapped;
-    std::vector<vk::DescriptorSet> descriptorSets;
+    UInt32 vertexCount{};
+    vk::Buffer vertexBuffer{}; // Uploaded once when added
+    GpuAllocation vertexAllocation{};
 };
 
 export class RenderObjectManager
@@ -79,51 +104,72 @@ public:
     void init
     (
         vk::Device device,
-        vk::PhysicalDevice physicalDevice,
-        vk::SurfaceKHR surface,
         vk::DescriptorPool descriptorPool,
-        vk::DescriptorSetLayout descriptorSetLayout,
-        vk::Queue queue,
-        vk::CommandPool cmdPool
+        vk::DescriptorSetLayout cameraSetLayout,
+        TextureTable& textureTable,
+        UploadManager& uploads,
+        GpuAllocator& allocator,
+        DeletionQueue& deletionQueue,
+        DescriptorCache& descriptors,
+        UniformRing& uniforms
     );
 
+    void shutdown();
     void clear();
     void setCamera(const Camera& camera);
 
-    void addRenderObject(Entity entity, const MeshData* mesh, const TextureData* texture, Mat4 transform, RenderLayer layer, Vec4 tint);
+    void addRenderObject(Entity entity, const MeshData* mesh, const TextureData* texture, Mat4 transform, RenderLayer layer, Vec4 tint, bool occluder);
     void removeRenderObject(Entity entity);
     void setObjectTransform(Entity entity, const Mat4& worldTransform);
+    void setObjectTransforms(std::span<const RenderCommands::ObjectTransform> transforms);
     void addLineRenderObject(Entity entity, std::vector<LineVertex>&& vertices, Mat4 transform);
     void removeLineRenderObject(Entity entity);
     void setObjectVisibility(Entity entity, bool visible);
 
-    void renderFrame
-    (
-        RenderLayer layer,
-        vk::CommandBuffer commandBuffer,
-        vk::PipelineLayout pipelineLayout,
-        UInt32 currentFrame
-    );
+    // Replaces the world's immediate-mode debug lines, drawn until the next batch arrives
+    void setDebugLines(std::vector<LineVertex>&& vertices);
 
-    void renderLineFrame
-    (
-        vk::CommandBuffer commandBuffer,
-        vk::PipelineLayout pipelineLayout,
-        UInt32 currentFrame
-    );
+    // Culls every layer to the camera's frustum and occluders, sorts what's left into draw batches that minimise
+    // pipeline and mesh binds and blend back to front, and writes the camera, instance and debug line data into the
+    // frame's ring buffer. Textures are indexed per instance from the texture table, so objects sharing a mesh share a
+    // batch. Culling runs in parallel on the job system when one is given.
+    // Returns false when there's nothing to record, like when the frame's ring buffer is full.
+    bool prepareFrame(UInt32 frameIndex, JobSystem* jobs);
+    [[nodiscard]] const CullingStats& getCullingStats() const { return m_cullingStats; }
+    [[nodiscard]] std::size_t getDrawBatchCount() const { return m_drawBatches.size(); }
+
+    // Records the prepared batches [firstBatch, lastBatch) into a command buffer with no state bound yet. Only reads
+    // what prepareFrame wrote, so separate ranges can be recorded on separate threads.
+    void recordDraws(vk::CommandBuffer commandBuffer, const RenderPipelineSet& pipelines, std::size_t firstBatch, std::size_t lastBatch) const;
+
+    // Records each line object from its own buffer, then every debug line in a single draw. Thread safe like recordDraws.
+    void recordLines(vk::CommandBuffer commandBuffer, const RenderPipelineSet& pipelines) const;
 
 private:
+    // Texture entry sampling the table's default texture, used by untextured objects and textures that failed to load
+    static constexpr std::size_t defaultTexture = 0;
+
     std::size_t getOrCreateMesh(const MeshData* mesh);
+    void updateBounds(RenderObject& object) const;
     std::size_t getOrCreateTexture(const TextureData* texture);
-    void updateDescriptorSets(const RenderObject& object) const;
-    void updateUniformBuffer(RenderObject& object, UInt32 currentImage);
-    void updateUniformBuffer(LineRenderObject& object, UInt32 currentImage);
-    void updateLineDescriptorSets(const LineRenderObject& object) const;
-    void removeRenderObject(const RenderObject& object);
-    void removeLineRenderObject(const LineRenderObject& object);
-
-    std::unordered_map<RenderLayer, std::vector<RenderObject>> m_objects;
-    std::vector<LineRenderObject> m_lineObjects;
+    void createCameraDescriptorSets();
+    void destroyLineBuffer(LineRenderObject& object);
+    void bindCamera(vk::CommandBuffer commandBuffer, vk::PipelineLayout pipelineLayout) const;
+
+    // Keyed by entity so every command resolves its object in constant time, while each layer's draw list stays packed
+    std::unordered_map<RenderLayer, SparseSet<RenderObject>> m_objects;
+    SparseSet<LineRenderObject> m_lineObjects;
+    std::vector<LineVertex> m_debugLines; // World space
+
+    // Scratch, reused every frame
+    std::vector<const RenderObject*> m_drawObjects; // Visible flagged, in the culler's order
+    std::vector<UInt64> m_drawKeys;
+    std::vector<UInt32> m_drawIndices; // Into m_drawObjects for those that passed culling, sorted along with the keys
+    std::vector<DrawBatch> m_drawBatches;
+    RadixSorter m_sorter;
+    FrustumCuller m_culler;
+    OcclusionCuller m_occlusionCuller;
+    CullingStats m_cullingStats;
     std::vector<Mesh> m_meshes;
     std::vector<Texture> m_textures;
 
@@ -131,11 +177,21 @@ private:
     std::unordered_map<const TextureData*, std::size_t> m_textureMap;
 
     vk::Device m_device{};
-    vk::PhysicalDevice m_physicalDevice{};
-    vk::SurfaceKHR m_surface{};
     vk::DescriptorPool m_descriptorPool{};
-    vk::DescriptorSetLayout m_descriptorSetLayout{};
-    vk::Queue m_queue{};
-    vk::CommandPool m_cmdPool{};
+    vk::DescriptorSetLayout m_cameraSetLayout{};
+    TextureTable* m_textureTable{};
+    std::array<vk::DescriptorSet, MaxFramesInFlight> m_cameraDescriptorSets{}; // One per uniform ring buffer
+
+    // Where prepareFrame wrote the frame's data into the ring buffer
+    vk::DescriptorSet m_frameCameraSet{};
+    UInt32 m_cameraOffset{};
+    UInt32 m_instanceOffset{};
+    UInt32 m_debugLineOffset{};
+    UInt32 m_debugLineCount{}; // Zero when the debug lines didn't fit
+    UploadManager* m_uploads{};
+    GpuAllocator* m_allocator{};
+    DeletionQueue* m_deletionQueue{};
+    DescriptorCache* m_descriptors{};
+    UniformRing* m_uniforms{};
     Camera m_camera{};
 };
@@ -1,28 +1,44 @@
 module Render.RenderWorld;
-import Render.RenderLayer;
 
 RenderWorld::RenderWorld(VulkanContext& context, const RenderWorldCreateInfo& info)
     : VulkanResource{context},
       m_world{info.world}
 {
-    m_objects.init(context.device, context.physicalDevice, context.surface, info.descriptorPool, info.descriptorSetLayout, context.graphicsQueue, context.commandPool);
+    m_objects.init(context.device, info.descriptorPool, info.cameraSetLayout, *info.textures, *info.uploads, *context.allocator, *context.deletionQueue, *context.descriptorCache, *info.uniforms);
 }
 
 RenderWorld::~RenderWorld()
 {
-    m_objects.clear();
+    m_objects.shutdown();
 }
 
-void RenderWorld::drawFrame(const RenderPassContext& renderContext)
+void RenderWorld::prepareFrame(UInt32 frameIndex, JobSystem* jobs)
 {
-    renderContext.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, renderContext.pipelines.mesh);
-    m_objects.renderFrame(RenderLayer::World, renderContext.commandBuffer, renderContext.pipelines.layout, renderContext.frameIndex);
+    m_prepared = m_objects.prepareFrame(frameIndex, jobs);
+}
+
+std::size_t RenderWorld::getChunkCount() const
+{
+    if (!m_prepared)
+        return 0;
+
+    return (m_objects.getDrawBatchCount() + batchesPerChunk - 1) / batchesPerChunk + 1;
+}
 
-    renderContext.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, renderContext.pipelines.gizmo);
-    m_objects.renderFrame(RenderLayer::Gizmo, renderContext.commandBuffer, renderContext.pipelines.layout, renderContext.frameIndex);
+void RenderWorld::recordChunk(vk::CommandBuffer commandBuffer, const RenderPipelineSet& pipelines, std::size_t chunk) const
+{
+    const std::size_t firstBatch = chunk * batchesPerChunk;
+    const std::size_t batchCount = m_objects.getDrawBatchCount();
 
-    renderContext.commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, renderContext.pipelines.line);
-    m_objects.renderLineFrame(renderContext.commandBuffer, renderContext.pipelines.layout, renderContext.frameIndex);
+    if (firstBatch >= batchCount)
+        m_objects.recordLines(commandBuffer, pipelines);
+    else
+        m_objects.recordDraws(commandBuffer, pipelines, firstBatch, std::min(firstBatch + batchesPerChunk, batchCount));
+}
+
+CullingStats RenderWorld::getCullingStats() const
+{
+    return m_prepared ? m_objects.getCullingStats() : CullingStats{};
 }
 
 RenderObjectManager& RenderWorld::objects() { return m_objects; }
@@ -32,7 +48,10 @@ const RenderObjectManager& RenderWorld::objects() const { return m_objects; }
 RenderWorldManager::RenderWorldManager(VulkanContext& vulkanContext, const RenderWorldManagerContext& worldManagerContext)
     : VulkanResource{vulkanContext},
       m_descriptorPool{worldManagerContext.descriptorPool},
-      m_descriptorSetLayout{worldManagerContext.descriptorSetLayout} {}
+      m_cameraSetLayout{worldManagerContext.cameraSetLayout},
+      m_textures{worldManagerContext.textures},
+      m_uniforms{worldManagerContext.uniforms},
+      m_uploads{worldManagerContext.uploads} {}
 
 void RenderWorldManager::registerWorld(WorldHandle world)
 {
@@ -42,7 +61,7 @@ void RenderWorldManager::registerWorld(WorldHandle world)
         return;
     }
 
-    m_renderWorlds.try_emplace(world, context(), RenderWorldCreateInfo{.world = world, .descriptorPool = m_descriptorPool, .descriptorSetLayout = m_descriptorSetLayout});
+    m_renderWorlds.try_emplace(world, context(), RenderWorldCreateInfo{.world = world, .descriptorPool = m_descriptorPool, .cameraSetLayout = m_cameraSetLayout, .textures = &m_textures, .uniforms = &m_uniforms, .uploads = &m_uploads});
 }
 
 void RenderWorldManager::unregisterWorld(WorldHandle world)
@@ -54,6 +73,9 @@ void RenderWorldManager::unregisterWorld(WorldHandle world)
     }
 
     m_renderWorlds.erase(world);
+
+    // Queued after the world's own resources, so the blocks they leave empty go back to the driver
+    context().deletionQueue->push([allocator = context().allocator] { allocator->releaseEmptyBlocks(); });
 }
 
 RenderObjectManager& RenderWorldManager::getObjectManager(WorldHandle world)
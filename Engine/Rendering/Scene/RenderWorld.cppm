@@ -1,5 +1,10 @@
 export module Render.RenderWorld;
+import Job;
+import Render.FrustumCulling;
 import Render.RenderObject;
+import Render.TextureTable;
+import Render.UniformRing;
+import Render.UploadManager;
 import Render.VulkanResource;
 import WorldHandle;
 
@@ -7,7 +12,10 @@ export struct RenderWorldCreateInfo
 {
     WorldHandle world;
     vk::DescriptorPool descriptorPool{};
-    vk::DescriptorSetLayout descriptorSetLayout{};
+    vk::DescriptorSetLayout cameraSetLayout{};
+    TextureTable* textures{};
+    UniformRing* uniforms{};
+    UploadManager* uploads{};
 };
 
 export class RenderWorld : VulkanResource
@@ -16,19 +24,36 @@ public:
     RenderWorld(VulkanContext& context, const RenderWorldCreateInfo& info);
     ~RenderWorld();
 
-    void drawFrame(const RenderPassContext& renderContext);
+    // Draw batches recorded together into one secondary command buffer. Enough that a chunk outweighs its command
+    // buffer, few enough that large draw lists spread over every worker.
+    static constexpr std::size_t batchesPerChunk = 64;
+
+    // Culls and sorts the world for the frame. Not thread safe, and done once per frame even when several viewports
+    // show the world.
+    void prepareFrame(UInt32 frameIndex, JobSystem* jobs);
+
+    // The prepared draws split into chunks that record independently, in the order they have to execute. The last
+    // chunk holds the lines.
+    [[nodiscard]] std::size_t getChunkCount() const;
+    void recordChunk(vk::CommandBuffer commandBuffer, const RenderPipelineSet& pipelines, std::size_t chunk) const;
+
+    [[nodiscard]] CullingStats getCullingStats() const;
     [[nodiscard]] RenderObjectManager& objects();
     [[nodiscard]] const RenderObjectManager& objects() const;
 
 private:
     WorldHandle m_world;
     RenderObjectManager m_objects;
+    bool m_prepared{}; // Whether this frame has anything to record
 };
 
 export struct RenderWorldManagerContext
 {
     vk::DescriptorPool& descriptorPool;
-    vk::DescriptorSetLayout& descriptorSetLayout;
+    vk::DescriptorSetLayout& cameraSetLayout;
+    TextureTable& textures;
+    UniformRing& uniforms;
+    UploadManager& uploads;
 };
 
 export class RenderWorldManager : VulkanResource
@@ -48,6 +73,9 @@ public:
 
 private:
     vk::DescriptorPool& m_descriptorPool;
-    vk::DescriptorSetLayout& m_descriptorSetLayout;
+    vk::DescriptorSetLayout& m_cameraSetLayout;
+    TextureTable& m_textures;
+    UniformRing& m_uniforms;
+    UploadManager& m_uploads;
     std::unordered_map<WorldHandle, RenderWorld> m_renderWorlds;
 };
@@ -1,5 +1,6 @@
 module Render.Viewport;
 import Core;
+import Render.DeletionQueue;
 import Render.Utils;
 import Math;
 
@@ -9,25 +10,52 @@ Viewport::Viewport(ViewportId id, VulkanContext& context, ViewportCreateInfo&& i
       m_renderWorlds{std::move(info.renderWorlds)},
       m_requestedArea{info.requestedArea},
       m_extent{static_cast<UInt32>(info.requestedArea.size.width), static_cast<UInt32>(info.requestedArea.size.height)},
+      m_renderExtent{m_extent},
       m_offset{info.requestedArea.position.x, info.requestedArea.position.y},
       m_colorFormat{info.colorFormat},
-      m_color{context, makeColorImageInfo()},
-      m_depth{context, makeDepthImageInfo()} {}
+      m_depthFormat{RenderUtils::findDepthFormat(context.physicalDevice)},
+      m_color{context, makeColorImageInfo()}
+{
+    const vk::PhysicalDeviceLimits limits = context.physicalDevice.getProperties().limits;
+    if (!limits.timestampComputeAndGraphics)
+    {
+        log("[Viewport] Device can't time graphics work, dynamic resolution is disabled");
+        return;
+    }
+
+    m_timestampPeriod = limits.timestampPeriod;
+    m_timestamps = context.device.createQueryPool(vk::QueryPoolCreateInfo
+    {
+        .queryType = vk::QueryType::eTimestamp,
+        .queryCount = 2 * MaxFramesInFlight,
+    });
+}
+
+// Frames in flight may still write the timestamps
+Viewport::~Viewport()
+{
+    if (m_timestamps)
+        context().deletionQueue->push([device = context().device, pool = m_timestamps] { device.destroyQueryPool(pool); });
+}
 
 void Viewport::recreate()
 {
-    m_colorLayout = vk::ImageLayout::eUndefined;
-    m_depthLayout = vk::ImageLayout::eUndefined;
+    m_colorState = {};
 
     if (m_extent.width == 0 || m_extent.height == 0)
         return;
 
+    m_renderExtent = getScaledExtent(m_scaleController.getScale());
     m_color.recreate(makeColorImageInfo());
-    m_depth.recreate(makeDepthImageInfo());
 }
 
-void Viewport::update()
+void Viewport::update(UInt32 frameIndex)
 {
+    if (const std::optional<float> gpuTime = readGpuTime(frameIndex))
+        m_scaleController.update(*gpuTime);
+
+    m_timestampsWritten[frameIndex] = false;
+
     if (m_requestedArea.size.width != m_extent.width
         || m_requestedArea.size.height != m_extent.height
         || m_requestedArea.position.x != m_offset.x
@@ -39,165 +67,236 @@ void Viewport::update()
 
         recreate();
     }
+    // The controller only changes the scale in coarse steps after a cooldown, so this reallocates rarely
+    else if (m_extent.width > 0 && m_extent.height > 0 && getScaledExtent(m_scaleController.getScale()) != m_renderExtent)
+    {
+        recreate();
+    }
 }
 
-void Viewport::drawFrame(const RenderPassContext& renderContext)
+vk::Extent2D Viewport::getScaledExtent(float scale) const
 {
-    //--------------------------------------------------------------------------
-    // Render scene into offscreen viewport image
-    //--------------------------------------------------------------------------
-    const vk::RenderingAttachmentInfo colorAttachmentInfo
+    auto scaled = [scale](UInt32 size) { return std::max(1u, static_cast<UInt32>(std::lround(static_cast<float>(size) * scale))); };
+    return {scaled(m_extent.width), scaled(m_extent.height)};
+}
+
+std::optional<float> Viewport::readGpuTime(UInt32 frameIndex) const
+{
+    if (!m_timestamps || !m_timestampsWritten[frameIndex])
+        return std::nullopt;
+
+    std::array<UInt64, 2> ticks{};
+    const vk::Result result = context().device.getQueryPoolResults
+    (
+        m_timestamps,
+        2 * frameIndex,
+        2,
+        sizeof(ticks),
+        ticks.data(),
+        sizeof(UInt64),
+        vk::QueryResultFlagBits::e64
+    );
+
+    if (result != vk::Result::eSuccess || ticks[1] < ticks[0])
+        return std::nullopt;
+
+    return static_cast<float>(static_cast<double>(ticks[1] - ticks[0]) * m_timestampPeriod * 1e-9);
+}
+
+std::optional<Viewport::CopyRegion> Viewport::getCopyRegion(vk::Extent2D destinationExtent) const
+{
+    if (!m_color.getImage())
+        return std::nullopt;
+
+    const IVec2 srcOffset
     {
-        .imageView = m_color.getView(),
-        .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
-        .loadOp = vk::AttachmentLoadOp::eClear,
-        .storeOp = vk::AttachmentStoreOp::eStore,
-        .clearValue = vk::ClearColorValue{0.f, 0.f, 0.f, 1.f}
+        std::max(0, -m_offset.x),
+        std::max(0, -m_offset.y)
     };
 
-    const vk::RenderingAttachmentInfo depthAttachmentInfo
+    const IVec2 dstOffset
     {
-        .imageView = m_depth.getView(),
-        .imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
-        .loadOp = vk::AttachmentLoadOp::eClear,
-        .storeOp = vk::AttachmentStoreOp::eDontCare,
-        .clearValue = vk::ClearDepthStencilValue{1.f, 0}
+        std::max(0,  m_offset.x),
+        std::max(0,  m_offset.y)
     };
 
-    const vk::RenderingInfo renderingInfo
+    const Size2D size
+    {
+        std::min(static_cast<int>(m_extent.width) - srcOffset.x, static_cast<int>(destinationExtent.width) - dstOffset.x),
+        std::min(static_cast<int>(m_extent.height) - srcOffset.y, static_cast<int>(destinationExtent.height) - dstOffset.y)
+    };
+
+    if (size.width <= 0 || size.height <= 0)
+        return std::nullopt;
+
+    return CopyRegion{srcOffset, dstOffset, size};
+}
+
+bool Viewport::isDrawn(vk::Extent2D destinationExtent) const
+{
+    return getCopyRegion(destinationExtent).has_value();
+}
+
+vk::CommandBuffer Viewport::recordChunk(ThreadCommandPools& commandPools, const RenderPipelineSet& pipelines, const RenderWorld& world, std::size_t chunk) const
+{
+    const vk::CommandBufferInheritanceRenderingInfo renderingInfo
     {
-        .renderArea = {{0,0}, m_extent},
-        .layerCount = 1,
         .colorAttachmentCount = 1,
-        .pColorAttachments = &colorAttachmentInfo,
-        .pDepthAttachment = &depthAttachmentInfo,
+        .pColorAttachmentFormats = &m_colorFormat,
+        .depthAttachmentFormat = m_depthFormat,
+        .rasterizationSamples = vk::SampleCountFlagBits::e1,
+    };
+
+    const vk::CommandBufferInheritanceInfo inheritance
+    {
+        .pNext = &renderingInfo,
     };
 
-    if (m_color.getImage())
+    const vk::CommandBuffer commandBuffer = commandPools.beginSecondary(inheritance);
+
+    // Secondary command buffers inherit no dynamic state
+    const vk::Viewport viewport
     {
-        const IVec2 srcOffset
+        .x = 0,
+        .y = 0,
+        .width = static_cast<float>(m_renderExtent.width),
+        .height = static_cast<float>(m_renderExtent.height),
+        .minDepth = 0.f,
+        .maxDepth = 1.f,
+    };
+
+    commandBuffer.setViewport(0, 1, &viewport);
+
+    const vk::Rect2D scissor
+    {
+        .offset = {0,0},
+        .extent = m_renderExtent,
+    };
+
+    commandBuffer.setScissor(0, 1, &scissor);
+
+    world.recordChunk(commandBuffer, pipelines, chunk);
+
+    commandBuffer.end();
+    return commandBuffer;
+}
+
+RenderGraphImage Viewport::addRenderPass(RenderGraph& graph, UInt32 frameIndex, std::span<const vk::CommandBuffer> chunks)
+{
+    m_cullingStats = {};
+    for (const RenderWorld& world : m_renderWorlds)
+        m_cullingStats += world.getCullingStats();
+
+    const RenderGraphImage color = graph.importImage(m_color.getImage(), m_color.getView(), vk::ImageAspectFlagBits::eColor, m_colorState);
+
+    // Depth is only needed while rendering, so its memory is shared with every other viewport's
+    const RenderGraphImage depth = graph.createTransient
+    ({
+        .extent = m_renderExtent,
+        .format = m_depthFormat,
+        .usage = vk::ImageUsageFlagBits::eDepthStencilAttachment,
+        .aspect = vk::ImageAspectFlagBits::eDepth,
+    });
+
+    auto execute = [this, frameIndex, chunks, color, depth](vk::CommandBuffer commandBuffer, const RenderGraph& graph)
+    {
+        const UInt32 firstTimestamp = 2 * frameIndex;
+        if (m_timestamps)
         {
-            std::max(0, -m_offset.x),
-            std::max(0, -m_offset.y)
-        };
+            commandBuffer.resetQueryPool(m_timestamps, firstTimestamp, 2);
+            commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, m_timestamps, firstTimestamp);
+        }
 
-        const IVec2 dstOffset
+        const vk::RenderingAttachmentInfo colorAttachmentInfo
         {
-            std::max(0,  m_offset.x),
-            std::max(0,  m_offset.y)
+            .imageView = graph.getView(color),
+            .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+            .loadOp = vk::AttachmentLoadOp::eClear,
+            .storeOp = vk::AttachmentStoreOp::eStore,
+            .clearValue = vk::ClearColorValue{0.f, 0.f, 0.f, 1.f}
         };
 
-        const vk::Extent2D swapchainExtent = renderContext.destination.extent;
+        const vk::RenderingAttachmentInfo depthAttachmentInfo
+        {
+            .imageView = graph.getView(depth),
+            .imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+            .loadOp = vk::AttachmentLoadOp::eClear,
+            .storeOp = vk::AttachmentStoreOp::eDontCare,
+            .clearValue = vk::ClearDepthStencilValue{1.f, 0}
+        };
 
-        const Size2D size
+        // Every draw comes from the chunks' secondary command buffers
+        const vk::RenderingInfo renderingInfo
         {
-            std::min(static_cast<int>(m_extent.width) - srcOffset.x, static_cast<int>(swapchainExtent.width) - dstOffset.x),
-            std::min(static_cast<int>(m_extent.height) - srcOffset.y, static_cast<int>(swapchainExtent.height) - dstOffset.y)
+            .flags = vk::RenderingFlagBits::eContentsSecondaryCommandBuffers,
+            .renderArea = {{0,0}, m_renderExtent},
+            .layerCount = 1,
+            .colorAttachmentCount = 1,
+            .pColorAttachments = &colorAttachmentInfo,
+            .pDepthAttachment = &depthAttachmentInfo,
         };
 
-        if (size.width > 0 && size.height > 0)
+        commandBuffer.beginRendering(renderingInfo);
+
+        if (!chunks.empty())
+            commandBuffer.executeCommands(chunks);
+
+        commandBuffer.endRendering();
+
+        if (m_timestamps)
         {
-            RenderUtils::transitionImageLayout
-            (
-                renderContext.commandBuffer,
-                m_color.getImage(),
-                m_colorLayout,
-                vk::ImageLayout::eColorAttachmentOptimal,
-                {},
-                vk::AccessFlagBits::eColorAttachmentWrite,
-                vk::PipelineStageFlagBits::eTopOfPipe,
-                vk::PipelineStageFlagBits::eColorAttachmentOutput
-            );
-            m_colorLayout = vk::ImageLayout::eColorAttachmentOptimal;
-
-            RenderUtils::transitionImageLayout
-            (
-                renderContext.commandBuffer,
-                m_depth.getImage(),
-                m_depthLayout,
-                vk::ImageLayout::eDepthStencilAttachmentOptimal,
-                {},
-                vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite,
-                vk::PipelineStageFlagBits::eTopOfPipe,
-                vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
-                vk::ImageAspectFlagBits::eDepth
-            );
-            m_depthLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal;
-
-            renderContext.commandBuffer.beginRendering(renderingInfo);
-
-            const vk::Viewport viewport
-            {
-                .x = 0,
-                .y = 0,
-                .width = static_cast<float>(m_extent.width),
-                .height = static_cast<float>(m_extent.height),
-                .minDepth = 0.f,
-                .maxDepth = 1.f,
-            };
+            commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, m_timestamps, firstTimestamp + 1);
+            m_timestampsWritten[frameIndex] = true;
+        }
+    };
+
+    graph.addPass
+    (
+        std::format("Viewport {}", m_id.value),
+        {{color, ImageUsage::ColorAttachment}, {depth, ImageUsage::DepthAttachment}},
+        std::move(execute)
+    );
 
-            renderContext.commandBuffer.setViewport(0, 1, &viewport);
+    return color;
+}
+
+void Viewport::blit(vk::CommandBuffer commandBuffer, vk::Image destination, vk::Extent2D destinationExtent) const
+{
+    const std::optional<CopyRegion> region = getCopyRegion(destinationExtent);
+    if (!region)
+        return;
 
-            const vk::Rect2D scissor
+    const auto [srcOffset, dstOffset, size] = *region;
+
+    // The region is in viewport space, the image is rendered at the scaled extent
+    const float scaleX = static_cast<float>(m_renderExtent.width) / static_cast<float>(m_extent.width);
+    const float scaleY = static_cast<float>(m_renderExtent.height) / static_cast<float>(m_extent.height);
+
+    auto toRender = [](int position, float scale) { return static_cast<Int32>(std::lround(static_cast<float>(position) * scale)); };
+
+    commandBuffer.blitImage
+    (
+        m_color.getImage(),
+        vk::ImageLayout::eTransferSrcOptimal,
+        destination,
+        vk::ImageLayout::eTransferDstOptimal,
+        vk::ImageBlit
+        {
+            .srcSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor, .layerCount = 1},
+            .srcOffsets = std::array
             {
-                .offset = {0,0},
-                .extent = m_extent,
-            };
-
-            renderContext.commandBuffer.setScissor(0, 1, &scissor);
-
-            for (auto& world : m_renderWorlds)
-                world.get().drawFrame(renderContext);
-
-            renderContext.commandBuffer.endRendering();
-
-            //------------------------------------------------------------------
-            // Copy viewport into swapchain
-            //------------------------------------------------------------------
-
-            RenderUtils::transitionImageLayout
-            (
-                renderContext.commandBuffer,
-                m_color.getImage(),
-                m_colorLayout,
-                vk::ImageLayout::eTransferSrcOptimal,
-                vk::AccessFlagBits::eColorAttachmentWrite,
-                vk::AccessFlagBits::eTransferRead,
-                vk::PipelineStageFlagBits::eColorAttachmentOutput,
-                vk::PipelineStageFlagBits::eTransfer
-            );
-            m_colorLayout = vk::ImageLayout::eTransferSrcOptimal;
-
-            RenderUtils::transitionImageLayout
-            (
-                renderContext.commandBuffer,
-                renderContext.destination.image,
-                *renderContext.destination.layout,
-                vk::ImageLayout::eTransferDstOptimal,
-                vk::AccessFlagBits::eColorAttachmentWrite,
-                vk::AccessFlagBits::eTransferWrite,
-                vk::PipelineStageFlagBits::eColorAttachmentOutput,
-                vk::PipelineStageFlagBits::eTransfer
-            );
-            *renderContext.destination.layout = vk::ImageLayout::eTransferDstOptimal;
-
-            renderContext.commandBuffer.copyImage
-            (
-                m_color.getImage(),
-                vk::ImageLayout::eTransferSrcOptimal,
-                renderContext.destination.image,
-                vk::ImageLayout::eTransferDstOptimal,
-                vk::ImageCopy
-                {
-                    .srcSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor, .layerCount = 1},
-                    .srcOffset = {srcOffset.x, srcOffset.y, 0},
-                    .dstSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor, .layerCount = 1},
-                    .dstOffset = {dstOffset.x, dstOffset.y, 0},
-                    .extent = {static_cast<UInt32>(size.width), static_cast<UInt32>(size.height), 1}
-                }
-            );
-        }
-    }
+                vk::Offset3D{toRender(srcOffset.x, scaleX), toRender(srcOffset.y, scaleY), 0},
+                vk::Offset3D{toRender(srcOffset.x + size.width, scaleX), toRender(srcOffset.y + size.height, scaleY), 1}
+            },
+            .dstSubresource = {.aspectMask = vk::ImageAspectFlagBits::eColor, .layerCount = 1},
+            .dstOffsets = std::array
+            {
+                vk::Offset3D{dstOffset.x, dstOffset.y, 0},
+                vk::Offset3D{dstOffset.x + size.width, dstOffset.y + size.height, 1}
+            }
+        },
+        vk::Filter::eLinear
+    );
 }
 
 void Viewport::setArea(Rect area)
@@ -225,10 +324,15 @@ const Camera& Viewport::getCamera() const
     return m_camera;
 }
 
+void Viewport::setDynamicResolution(const DynamicResolutionSettings& settings)
+{
+    m_scaleController.setSettings(settings);
+}
+
 ImageCreateInfo Viewport::makeColorImageInfo() const
 {
     return {
-        .extent = m_extent,
+        .extent = m_renderExtent,
         .format = m_colorFormat,
         .usage = vk::ImageUsageFlagBits::eColorAttachment |
                  vk::ImageUsageFlagBits::eSampled |
@@ -237,16 +341,6 @@ ImageCreateInfo Viewport::makeColorImageInfo() const
     };
 }
 
-ImageCreateInfo Viewport::makeDepthImageInfo() const
-{
-    return {
-        .extent = m_extent,
-        .format = RenderUtils::findDepthFormat(context().physicalDevice),
-        .usage = vk::ImageUsageFlagBits::eDepthStencilAttachment,
-        .aspect = vk::ImageAspectFlagBits::eDepth
-    };
-}
-
 ViewportId ViewportManager::createViewport(ViewportCreateInfo&& info)
 {
     const ViewportId id{m_nextId++};
@@ -274,21 +368,102 @@ const Camera& ViewportManager::getCamera(ViewportId id) const
     return m_viewports.at(id).getCamera();
 }
 
+const CullingStats& ViewportManager::getCullingStats(ViewportId id) const
+{
+    return m_viewports.at(id).getCullingStats();
+}
+
 void ViewportManager::setCamera(ViewportId id, const Camera& camera)
 {
     m_viewports.at(id).setCamera(camera);
 }
 
-void ViewportManager::update()
+float ViewportManager::getRenderScale(ViewportId id) const
+{
+    return m_viewports.at(id).getRenderScale();
+}
+
+void ViewportManager::setDynamicResolution(ViewportId id, const DynamicResolutionSettings& settings)
+{
+    m_viewports.at(id).setDynamicResolution(settings);
+}
+
+void ViewportManager::update(UInt32 frameIndex)
 {
     for (Viewport& viewport : m_viewports | std::views::values)
-        viewport.update();
+        viewport.update(frameIndex);
 }
 
-void ViewportManager::drawViewports(const RenderPassContext& renderContext)
+void ViewportManager::drawViewports(const RenderPassContext& renderContext, ThreadCommandPools& commandPools, RenderGraph& graph, RenderGraphImage destination)
 {
+    m_drawnViewports.clear();
+    m_preparedWorlds.clear();
+    m_chunks.clear();
+
     for (Viewport& viewport : m_viewports | std::views::values)
-        viewport.drawFrame(renderContext);
+    {
+        if (!viewport.isDrawn(renderContext.destination.extent))
+            continue;
+
+        m_drawnViewports.push_back(&viewport);
+
+        for (RenderWorld& world : viewport.getRenderWorlds())
+        {
+            if (!std::ranges::contains(m_preparedWorlds, &world))
+            {
+                world.prepareFrame(static_cast<UInt32>(renderContext.frameIndex), renderContext.jobs);
+                m_preparedWorlds.push_back(&world);
+            }
+
+            for (std::size_t chunk = 0; chunk < world.getChunkCount(); ++chunk)
+                m_chunks.push_back({.viewport = &viewport, .world = &world, .chunk = chunk});
+        }
+    }
+
+    auto record = [&](std::size_t begin, std::size_t end)
+    {
+        for (RecordChunk& chunk : std::span{m_chunks}.subspan(begin, end - begin))
+            chunk.commandBuffer = chunk.viewport->recordChunk(commandPools, renderContext.pipelines, *chunk.world, chunk.chunk);
+    };
+
+    if (renderContext.jobs)
+        renderContext.jobs->parallelFor(m_chunks.size(), 1, record);
+    else
+        record(0, m_chunks.size());
+
+    // Filled completely before any pass takes a span of it
+    m_chunkBuffers.clear();
+    for (const RecordChunk& chunk : m_chunks)
+        m_chunkBuffers.push_back(chunk.commandBuffer);
+
+    std::vector<ImageAccess> compositeImages;
+    compositeImages.reserve(m_drawnViewports.size() + 1);
+
+    std::size_t firstChunk = 0;
+    for (Viewport* viewport : m_drawnViewports)
+    {
+        std::size_t lastChunk = firstChunk;
+        while (lastChunk < m_chunks.size() && m_chunks[lastChunk].viewport == viewport)
+            ++lastChunk;
+
+        const std::span<const vk::CommandBuffer> chunks = std::span{m_chunkBuffers}.subspan(firstChunk, lastChunk - firstChunk);
+        const RenderGraphImage color = viewport->addRenderPass(graph, static_cast<UInt32>(renderContext.frameIndex), chunks);
+        compositeImages.push_back({color, ImageUsage::TransferSrc});
+
+        firstChunk = lastChunk;
+    }
+
+    if (m_drawnViewports.empty())
+        return;
+
+    // One pass for every viewport, so the destination is only transitioned once and all images wait in one batch
+    compositeImages.push_back({destination, ImageUsage::TransferDst});
+
+    graph.addPass("Viewport composite", std::move(compositeImages), [this, destination, extent = renderContext.destination.extent](vk::CommandBuffer commandBuffer, const RenderGraph& graph)
+    {
+        for (const Viewport* viewport : m_drawnViewports)
+            viewport->blit(commandBuffer, graph.getImage(destination), extent);
+    });
 }
 
 void ViewportManager::recreateImages()
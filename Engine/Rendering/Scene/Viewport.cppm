@@ -3,8 +3,13 @@ export import Engine.Viewport;
 import Core;
 import Engine.Camera;
 import Geometry;
+import Math;
+import Render.DynamicResolution;
+import Render.FrustumCulling;
+import Render.Graph;
 import Render.Image;
 import Render.RenderWorld;
+import Render.ThreadCommandPools;
 import Render.VulkanResource;
 
 export struct ViewportCreateInfo
@@ -18,30 +23,71 @@ export class Viewport : VulkanResource
 {
 public:
     Viewport(ViewportId id, VulkanContext& context, ViewportCreateInfo&& info);
+    ~Viewport();
+    Viewport(const Viewport&) = delete;
+    Viewport& operator=(const Viewport&) = delete;
+
     void recreate();
-    void update();
-    void drawFrame(const RenderPassContext& renderContext);
+
+    // Called once the frame's fence has signalled, so the GPU time of the frame last drawn in its slot is known
+    void update(UInt32 frameIndex);
+
+    // Whether any of the viewport lands on the destination, so it has to be drawn at all
+    [[nodiscard]] bool isDrawn(vk::Extent2D destinationExtent) const;
+    [[nodiscard]] std::span<const std::reference_wrapper<RenderWorld>> getRenderWorlds() const { return m_renderWorlds; }
+
+    // Records a chunk of a prepared world into a secondary command buffer from the calling thread's pool, continuing the
+    // viewport's rendering. Thread safe.
+    [[nodiscard]] vk::CommandBuffer recordChunk(ThreadCommandPools& commandPools, const RenderPipelineSet& pipelines, const RenderWorld& world, std::size_t chunk) const;
+
+    // Adds the pass rendering the recorded chunks in order, returning the color image it renders
+    RenderGraphImage addRenderPass(RenderGraph& graph, UInt32 frameIndex, std::span<const vk::CommandBuffer> chunks);
+
+    // Scales the rendered image into the destination, with the image in transfer source and the destination in
+    // transfer destination layout
+    void blit(vk::CommandBuffer commandBuffer, vk::Image destination, vk::Extent2D destinationExtent) const;
+
     void setArea(Rect area);
     [[nodiscard]] Rect getArea() const;
     [[nodiscard]] float getAspectRatio() const;
     void setCamera(Camera camera);
     const Camera& getCamera() const;
+    [[nodiscard]] const CullingStats& getCullingStats() const { return m_cullingStats; } // Of the last frame drawn
+    [[nodiscard]] float getRenderScale() const { return m_scaleController.getScale(); }
+    void setDynamicResolution(const DynamicResolutionSettings& settings);
 
 private:
+    struct CopyRegion
+    {
+        IVec2 srcOffset{};
+        IVec2 dstOffset{};
+        Size2D size{};
+    };
+
+    // The part of the viewport inside the destination, if any
+    [[nodiscard]] std::optional<CopyRegion> getCopyRegion(vk::Extent2D destinationExtent) const;
+    [[nodiscard]] vk::Extent2D getScaledExtent(float scale) const;
+    [[nodiscard]] std::optional<float> readGpuTime(UInt32 frameIndex) const; // Seconds
     [[nodiscard]] ImageCreateInfo makeColorImageInfo() const;
-    [[nodiscard]] ImageCreateInfo makeDepthImageInfo() const;
 
     ViewportId m_id;
     std::vector<std::reference_wrapper<RenderWorld>> m_renderWorlds;
     Camera m_camera;
+    CullingStats m_cullingStats;
     Rect m_requestedArea;
     vk::Extent2D m_extent{1000, 800};
+    vk::Extent2D m_renderExtent{1000, 800}; // Of the images, the extent scaled by the render scale
     vk::Offset2D m_offset{};
-    vk::ImageLayout m_colorLayout{vk::ImageLayout::eUndefined};
-    vk::ImageLayout m_depthLayout{vk::ImageLayout::eUndefined};
+    ImageState m_colorState;
     vk::Format m_colorFormat{};
-    Image m_color;
-    Image m_depth;
+    vk::Format m_depthFormat{};
+    Image m_color; // Depth is transient, owned by the render graph
+
+    // Two timestamps per frame in flight around the viewport's rendering, none if the device can't time graphics work
+    vk::QueryPool m_timestamps{};
+    float m_timestampPeriod{}; // Nanoseconds per tick
+    std::array<bool, MaxFramesInFlight> m_timestampsWritten{};
+    RenderScaleController m_scaleController;
 };
 
 export class ViewportManager : VulkanResource
@@ -55,13 +101,35 @@ public:
     [[nodiscard]] float getAspectRatio(ViewportId id) const;
     const Camera& getCamera(ViewportId id) const;
     void setCamera(ViewportId id, const Camera& camera);
+    [[nodiscard]] const CullingStats& getCullingStats(ViewportId id) const;
+    [[nodiscard]] float getRenderScale(ViewportId id) const;
+    void setDynamicResolution(ViewportId id, const DynamicResolutionSettings& settings);
+
+    void update(UInt32 frameIndex);
 
-    void update();
-    void drawViewports(const RenderPassContext& renderContext);
+    // Prepares every world shown once, then records the draws of every viewport in parallel chunks on the job system,
+    // each into its own secondary command buffer. Adds a pass per viewport executing its chunks, and one composing
+    // them all into the destination.
+    void drawViewports(const RenderPassContext& renderContext, ThreadCommandPools& commandPools, RenderGraph& graph, RenderGraphImage destination);
     void recreateImages();
     void shutdown();
 
 private:
+    struct RecordChunk
+    {
+        Viewport* viewport{};
+        const RenderWorld* world{};
+        std::size_t chunk{};
+        vk::CommandBuffer commandBuffer{};
+    };
+
     std::unordered_map<ViewportId, Viewport> m_viewports;
+
+    // Scratch, reused every frame
+    std::vector<Viewport*> m_drawnViewports;
+    std::vector<const RenderWorld*> m_preparedWorlds;
+    std::vector<RecordChunk> m_chunks; // Grouped by viewport, in the order they execute
+    std::vector<vk::CommandBuffer> m_chunkBuffers;
+
     ViewportId::ValueType m_nextId{};
 };
\ No newline at end of file
@@ -0,0 +1,27 @@
+export module Render.Shaders;
+import Core;
+
+// SPIR-V of every shader, compiled by the Shaders target and embedded in the binary so pipelines are created without
+// reading anything from disk
+export namespace Shaders
+{
+    inline constexpr UInt32 meshVertex[]
+    {
+#include "Shader.vert.spv.inc"
+    };
+
+    inline constexpr UInt32 meshFragment[]
+    {
+#include "Shader.frag.spv.inc"
+    };
+
+    inline constexpr UInt32 lineVertex[]
+    {
+#include "LineShader.vert.spv.inc"
+    };
+
+    inline constexpr UInt32 lineFragment[]
+    {
+#include "LineShader.frag.spv.inc"
+    };
+}
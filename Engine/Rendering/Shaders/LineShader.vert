@@ -4,13 +4,16 @@ layout(location = 0) in vec3 inPosition;
 layout (location = 1) in vec4 inColor;
 layout (location = 0) out vec4 outColor;
 
-layout(set = 0, binding = 0) uniform UBO {
-    mat4 model;
+layout(set = 0, binding = 0) uniform CameraUniforms {
     mat4 view;
     mat4 proj;
-} ubo;
+} camera;
+
+layout(push_constant) uniform ObjectPushConstants {
+    mat4 model;
+} object;
 
 void main() {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    gl_Position = camera.proj * camera.view * object.model * vec4(inPosition, 1.0);
     outColor = inColor;
 }
\ No newline at end of file
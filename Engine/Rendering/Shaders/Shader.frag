@@ -1,13 +1,16 @@
 #version 450
+#extension GL_EXT_nonuniform_qualifier : require
 
-layout (binding = 1) uniform sampler2D texSampler;
+layout (set = 1, binding = 0) uniform sampler samplers[2];
+layout (set = 1, binding = 1) uniform texture2D textures[];
 
 layout (location = 0) in vec2 inUV;
 layout (location = 1) in vec4 inTint;
+layout (location = 2) flat in uvec2 inMaterial;
 
 layout (location = 0) out vec4 outColor;
 
 void main()
 {
-    outColor = texture(texSampler, inUV) * inTint;
+    outColor = texture(sampler2D(textures[nonuniformEXT(inMaterial.x)], samplers[inMaterial.y]), inUV) * inTint;
 }
\ No newline at end of file
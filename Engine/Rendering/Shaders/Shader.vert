@@ -1,22 +1,27 @@
 #version 450
 
-layout (binding = 0) uniform UniformBufferObject
+layout (set = 0, binding = 0) uniform CameraUniforms
 {
-    mat4 model;
     mat4 view;
     mat4 proj;
-    vec4 tint;
-} ubo;
+} camera;
 
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec2 inUV;
 
+// Per instance
+layout (location = 2) in mat4 inModel;
+layout (location = 6) in vec4 inTint;
+layout (location = 7) in uvec2 inMaterial; // Texture table index, sampler
+
 layout (location = 0) out vec2 outUV;
 layout (location = 1) out vec4 outTint;
+layout (location = 2) flat out uvec2 outMaterial;
 
 void main()
 {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    gl_Position = camera.proj * camera.view * inModel * vec4(inPosition, 1.0);
     outUV = inUV;
-    outTint = ubo.tint;
+    outTint = inTint;
+    outMaterial = inMaterial;
 }
\ No newline at end of file
@@ -75,10 +75,8 @@ QueueFamilyIndices QueueFamilyUtils::findQueueFamilies(vk::PhysicalDevice device
 		else if ((family.queueFlags & vk::QueueFlagBits::eTransfer))
 			indices.get(QueueFamilyType::Transfer) = i;
 
-		{
-			if (device.getSurfaceSupportKHR(i, surface))
-				indices.get(QueueFamilyType::Present) = i;
-		}
+		if (surface && device.getSurfaceSupportKHR(i, surface))
+			indices.get(QueueFamilyType::Present) = i;
 
 		if (areAllIndicesSet(indices))
 			break;
@@ -90,5 +88,17 @@ QueueFamilyIndices QueueFamilyUtils::findQueueFamilies(vk::PhysicalDevice device
 		indices.get(QueueFamilyType::Graphics) = static_cast<UInt32>(it - queueFamilies.begin());
 	}
 
+	// Without a surface nothing is presented, the present queue is only ever the graphics one
+	if (!surface)
+	{
+		indices.get(QueueFamilyType::Present) = indices.get(QueueFamilyType::Graphics);
+	}
+
+	// Graphics queues can always transfer, so devices without a dedicated transfer family upload on the graphics one
+	if (!indices.get(QueueFamilyType::Transfer))
+	{
+		indices.get(QueueFamilyType::Transfer) = indices.get(QueueFamilyType::Graphics);
+	}
+
 	return indices;
 }
\ No newline at end of file
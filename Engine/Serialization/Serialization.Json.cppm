@@ -65,6 +65,9 @@ int toNumber<int>(const JsonObject& j) { return j.GetInt(); }
 template<>
 UInt64 toNumber<UInt64>(const JsonObject& j) { return j.GetUint64(); }
 
+template<>
+float toNumber<float>(const JsonObject& j) { return j.GetFloat(); }
+
 template<typename T>
 std::optional<T> Json::toNumber(const JsonObject& j, const char* key)
 {
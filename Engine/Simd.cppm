@@ -0,0 +1,178 @@
+module;
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENGINE_SIMD_SSE 1
+#include <immintrin.h>
+#else
+#define ENGINE_SIMD_SSE 0
+#endif
+
+export module Simd;
+import Core;
+
+// Four packed floats, backed by SSE when available and by plain arrays otherwise.
+// Comparisons return lane masks (all bits set or clear) that can be combined with maskAnd() and consumed by select()
+// or moveMask().
+export struct Float4
+{
+    static constexpr std::size_t width = 4;
+
+#if ENGINE_SIMD_SSE
+    __m128 value;
+#else
+    std::array<float, width> value;
+#endif
+
+    [[nodiscard]] inline static Float4 broadcast(float scalar);
+    [[nodiscard]] inline static Float4 load(const float* data);
+    inline void store(float* data) const;
+
+    [[nodiscard]] inline float operator[](std::size_t lane) const;
+};
+
+export namespace Simd
+{
+    [[nodiscard]] inline Float4 add(Float4 a, Float4 b);
+    [[nodiscard]] inline Float4 sub(Float4 a, Float4 b);
+    [[nodiscard]] inline Float4 mul(Float4 a, Float4 b);
+
+    // Like minps/maxps: if either lane is NaN, the lane from b is returned
+    [[nodiscard]] inline Float4 min(Float4 a, Float4 b);
+    [[nodiscard]] inline Float4 max(Float4 a, Float4 b);
+
+    [[nodiscard]] inline Float4 less(Float4 a, Float4 b);
+    [[nodiscard]] inline Float4 lessEqual(Float4 a, Float4 b);
+    [[nodiscard]] inline Float4 maskAnd(Float4 a, Float4 b);
+
+    // Picks a where the mask is set, b elsewhere
+    [[nodiscard]] inline Float4 select(Float4 mask, Float4 a, Float4 b);
+
+    // One bit per lane, lane 0 in the lowest bit
+    [[nodiscard]] inline UInt32 moveMask(Float4 mask);
+
+    [[nodiscard]] inline float reduceMin(Float4 a);
+    [[nodiscard]] inline float reduceMax(Float4 a);
+}
+
+#if ENGINE_SIMD_SSE
+
+inline Float4 Float4::broadcast(float scalar) { return {_mm_set1_ps(scalar)}; }
+inline Float4 Float4::load(const float* data) { return {_mm_loadu_ps(data)}; }
+inline void Float4::store(float* data) const { _mm_storeu_ps(data, value); }
+
+inline float Float4::operator[](std::size_t lane) const
+{
+    alignas(16) std::array<float, width> lanes;
+    _mm_store_ps(lanes.data(), value);
+    return lanes[lane];
+}
+
+inline Float4 Simd::add(Float4 a, Float4 b) { return {_mm_add_ps(a.value, b.value)}; }
+inline Float4 Simd::sub(Float4 a, Float4 b) { return {_mm_sub_ps(a.value, b.value)}; }
+inline Float4 Simd::mul(Float4 a, Float4 b) { return {_mm_mul_ps(a.value, b.value)}; }
+inline Float4 Simd::min(Float4 a, Float4 b) { return {_mm_min_ps(a.value, b.value)}; }
+inline Float4 Simd::max(Float4 a, Float4 b) { return {_mm_max_ps(a.value, b.value)}; }
+inline Float4 Simd::less(Float4 a, Float4 b) { return {_mm_cmplt_ps(a.value, b.value)}; }
+inline Float4 Simd::lessEqual(Float4 a, Float4 b) { return {_mm_cmple_ps(a.value, b.value)}; }
+inline Float4 Simd::maskAnd(Float4 a, Float4 b) { return {_mm_and_ps(a.value, b.value)}; }
+
+inline Float4 Simd::select(Float4 mask, Float4 a, Float4 b)
+{
+    return {_mm_or_ps(_mm_and_ps(mask.value, a.value), _mm_andnot_ps(mask.value, b.value))};
+}
+
+inline UInt32 Simd::moveMask(Float4 mask) { return static_cast<UInt32>(_mm_movemask_ps(mask.value)); }
+
+inline float Simd::reduceMin(Float4 a)
+{
+    __m128 m = _mm_min_ps(a.value, _mm_shuffle_ps(a.value, a.value, _MM_SHUFFLE(2, 3, 0, 1)));
+    m = _mm_min_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(m);
+}
+
+inline float Simd::reduceMax(Float4 a)
+{
+    __m128 m = _mm_max_ps(a.value, _mm_shuffle_ps(a.value, a.value, _MM_SHUFFLE(2, 3, 0, 1)));
+    m = _mm_max_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_cvtss_f32(m);
+}
+
+#else
+
+namespace SimdDetail
+{
+    template<typename Fn>
+    Float4 perLane(Float4 a, Float4 b, Fn&& fn)
+    {
+        Float4 result;
+        for (std::size_t i = 0; i < Float4::width; ++i)
+            result.value[i] = fn(a.value[i], b.value[i]);
+        return result;
+    }
+
+    inline float maskFrom(bool condition)
+    {
+        return std::bit_cast<float>(condition ? ~UInt32{0} : UInt32{0});
+    }
+}
+
+inline Float4 Float4::broadcast(float scalar)
+{
+    Float4 result;
+    result.value.fill(scalar);
+    return result;
+}
+
+inline Float4 Float4::load(const float* data)
+{
+    Float4 result;
+    std::copy_n(data, width, result.value.begin());
+    return result;
+}
+
+inline void Float4::store(float* data) const { std::ranges::copy(value, data); }
+
+inline float Float4::operator[](std::size_t lane) const { return value[lane]; }
+
+inline Float4 Simd::add(Float4 a, Float4 b) { return SimdDetail::perLane(a, b, [](float x, float y) { return x + y; }); }
+inline Float4 Simd::sub(Float4 a, Float4 b) { return SimdDetail::perLane(a, b, [](float x, float y) { return x - y; }); }
+inline Float4 Simd::mul(Float4 a, Float4 b) { return SimdDetail::perLane(a, b, [](float x, float y) { return x * y; }); }
+inline Float4 Simd::min(Float4 a, Float4 b) { return SimdDetail::perLane(a, b, [](float x, float y) { return x < y ? x : y; }); }
+inline Float4 Simd::max(Float4 a, Float4 b) { return SimdDetail::perLane(a, b, [](float x, float y) { return x > y ? x : y; }); }
+inline Float4 Simd::less(Float4 a, Float4 b) { return SimdDetail::perLane(a, b, [](float x, float y) { return SimdDetail::maskFrom(x < y); }); }
+inline Float4 Simd::lessEqual(Float4 a, Float4 b) { return SimdDetail::perLane(a, b, [](float x, float y) { return SimdDetail::maskFrom(x <= y); }); }
+
+inline Float4 Simd::maskAnd(Float4 a, Float4 b)
+{
+    return SimdDetail::perLane(a, b, [](float x, float y)
+    {
+        return std::bit_cast<float>(std::bit_cast<UInt32>(x) & std::bit_cast<UInt32>(y));
+    });
+}
+
+inline Float4 Simd::select(Float4 mask, Float4 a, Float4 b)
+{
+    Float4 result;
+    for (std::size_t i = 0; i < Float4::width; ++i)
+        result.value[i] = std::bit_cast<UInt32>(mask.value[i]) != 0 ? a.value[i] : b.value[i];
+    return result;
+}
+
+inline UInt32 Simd::moveMask(Float4 mask)
+{
+    UInt32 bits = 0;
+    for (std::size_t i = 0; i < Float4::width; ++i)
+        bits |= (std::bit_cast<UInt32>(mask.value[i]) >> 31) << i;
+    return bits;
+}
+
+inline float Simd::reduceMin(Float4 a)
+{
+    return std::ranges::min(a.value);
+}
+
+inline float Simd::reduceMax(Float4 a)
+{
+    return std::ranges::max(a.value);
+}
+
+#endif
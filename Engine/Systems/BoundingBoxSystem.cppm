@@ -4,14 +4,17 @@ import Components.Transform;
 import Engine.WorldManager;
 import Engine.SystemManager;
 import Math;
+import Physics;
+import Physics.AabbTree;
 import World.Events;
 
 namespace
 {
     EventSubscription subscription;
+    std::vector<Entity> updatedEntities; // Scratch, sorted by value
 }
 
-constexpr std::vector<Vec3> computeCorners(const BoundingBoxComponent& aabb)
+std::array<Vec3, 8> computeCorners(const BoundingBoxComponent& aabb)
 {
     return
     {
@@ -26,32 +29,48 @@ constexpr std::vector<Vec3> computeCorners(const BoundingBoxComponent& aabb)
     };
 }
 
-void computeWorldCorners(Edit<BoundingBoxComponent>& aabb, const Mat4& worldTransform)
+Aabb computeWorldBounds(const BoundingBoxComponent& aabb, const Mat4& worldTransform)
 {
-    const std::vector<Vec3>& corners = computeCorners(aabb.get());
+    Aabb bounds{Vec3{std::numeric_limits<float>::max()}, Vec3{std::numeric_limits<float>::lowest()}};
 
-    Vec3 minWorld{std::numeric_limits<float>::max()};
-    Vec3 maxWorld{std::numeric_limits<float>::lowest()};
-    
-    for (int i = 0; i < 8; i++)
+    for (const Vec3& corner : computeCorners(aabb))
     {
-        const Vec3 worldPos{worldTransform * Vec4{corners[i], 1.0f}};
-        minWorld = Math::min(minWorld, worldPos);
-        maxWorld = Math::max(maxWorld, worldPos);
+        const Vec3 worldPos{worldTransform * Vec4{corner, 1.0f}};
+        bounds.min = Math::min(bounds.min, worldPos);
+        bounds.max = Math::max(bounds.max, worldPos);
     }
 
-    aabb->minWorld = minWorld;
-    aabb->maxWorld = maxWorld;
+    return bounds;
+}
+
+// Recomputes the world bounds and pushes them to the world's tree. The component is only edited when the bounds
+// actually moved, so entities at rest don't get marked again every frame.
+void updateBounds(World& world, AabbTree& tree, Entity entity)
+{
+    const auto& aabb = world.readComponent<BoundingBoxComponent>(entity);
+    const auto& transform = world.readComponent<RuntimeTransformComponent>(entity);
+    const Aabb bounds = computeWorldBounds(aabb, transform.worldMatrix);
+
+    if (bounds.min != aabb.minWorld || bounds.max != aabb.maxWorld)
+    {
+        auto edit = world.editComponent<BoundingBoxComponent>(entity);
+        edit->minWorld = bounds.min;
+        edit->maxWorld = bounds.max;
+    }
+
+    tree.update(entity, bounds, aabb.channel);
 }
 
 void init(SystemContext& context)
 {
     context.worlds.forEachWorld([](World& world)
     {
-        for (auto&& [entity, aabb, transform] : world.query<Edit<BoundingBoxComponent>, RuntimeTransformComponent>())
+        AabbTree& tree = world.editResource<AabbTree>();
+        for (auto&& [entity, aabb, transform] : world.query<BoundingBoxComponent, RuntimeTransformComponent>())
         {
-            computeWorldCorners(aabb, transform.worldMatrix);
+            updateBounds(world, tree, entity);
         }
+        tree.rebuild();
     });
 
     subscription += context.worlds.subscribe([&worlds = context.worlds](const WorldEvents::ComponentAdded& event)
@@ -59,21 +78,50 @@ void init(SystemContext& context)
         if (event.componentType == getTypeId<BoundingBoxComponent>())
         {
             World& world = worlds.get(event.world);
-            auto aabb = world.editComponent<BoundingBoxComponent>(event.entity);
-            const auto& transform = world.readComponent<RuntimeTransformComponent>(event.entity);
-            computeWorldCorners(aabb, transform.worldMatrix);
+            updateBounds(world, world.editResource<AabbTree>(), event.entity);
         }
     });
+
+    subscription += context.worlds.subscribe([&worlds = context.worlds](const WorldEvents::EntityDestroyed& event)
+    {
+        worlds.get(event.world).editResource<AabbTree>().remove(event.entity);
+    });
+
+    subscription += context.worlds.subscribe([&worlds = context.worlds](const WorldEvents::WorldCleared& event)
+    {
+        worlds.get(event.world).editResource<AabbTree>().clear();
+    });
 }
 
 void update(SystemContext& context, float)
 {
     context.worlds.forEachWorld([](World& world)
     {
-        for (auto&& [entity, aabb, transform] : world.query<Edit<BoundingBoxComponent>, RuntimeTransformComponent>())
+        AabbTree& tree = world.editResource<AabbTree>();
+        updatedEntities.clear();
+
+        // Moved entities, plus boxes edited from elsewhere (e.g. channel changes)
+        for (const Entity entity : world.getMarked<RuntimeTransformComponent>())
         {
-            computeWorldCorners(aabb, transform.worldMatrix);
+            if (world.hasComponent<BoundingBoxComponent>(entity))
+            {
+                updateBounds(world, tree, entity);
+                updatedEntities.push_back(entity);
+            }
         }
+
+        std::ranges::sort(updatedEntities, {}, &Entity::value);
+
+        // Boxes this system edited last frame come back marked. Each entity is only pushed to the tree once per frame:
+        // a second update would see no displacement and shrink the fat box its motion just stretched. Entities that
+        // came to rest get exactly that update, which shrinks the box once they stop.
+        for (const Entity entity : world.getMarked<BoundingBoxComponent>())
+        {
+            if (!std::ranges::binary_search(updatedEntities, entity.value, {}, &Entity::value))
+                updateBounds(world, tree, entity);
+        }
+
+        tree.rebuildIfDegraded();
     });
 }
 
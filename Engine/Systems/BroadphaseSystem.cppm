@@ -0,0 +1,84 @@
+export module Systems.Broadphase;
+import Components.BoundingBox;
+import Components.Transform;
+import Engine.SystemManager;
+import Engine.WorldManager;
+import Physics;
+import Physics.Broadphase;
+import World.Events;
+
+// Keeps each world's Broadphase in sync with the bounding boxes. Runs after the bounding box system, so the world
+// bounds of this frame's moved entities are already up to date.
+namespace
+{
+    EventSubscription subscription;
+
+    void updateProxy(Broadphase& broadphase, Entity entity, const BoundingBoxComponent& box)
+    {
+        broadphase.update(entity, {box.minWorld, box.maxWorld}, box.channel);
+    }
+
+    void init(SystemContext& context)
+    {
+        context.worlds.forEachWorld([](World& world)
+        {
+            Broadphase& broadphase = world.editResource<Broadphase>();
+            for (auto&& [entity, box] : world.query<BoundingBoxComponent>())
+            {
+                updateProxy(broadphase, entity, box);
+            }
+            broadphase.flush();
+        });
+
+        subscription += context.worlds.subscribe([&worlds = context.worlds](const WorldEvents::ComponentAdded& event)
+        {
+            if (event.componentType == getTypeId<BoundingBoxComponent>())
+            {
+                World& world = worlds.get(event.world);
+                updateProxy(world.editResource<Broadphase>(), event.entity, world.readComponent<BoundingBoxComponent>(event.entity));
+            }
+        });
+
+        subscription += context.worlds.subscribe([&worlds = context.worlds](const WorldEvents::EntityDestroyed& event)
+        {
+            worlds.get(event.world).editResource<Broadphase>().remove(event.entity);
+        });
+
+        subscription += context.worlds.subscribe([&worlds = context.worlds](const WorldEvents::WorldCleared& event)
+        {
+            worlds.get(event.world).editResource<Broadphase>().clear();
+        });
+    }
+
+    void update(SystemContext& context, float)
+    {
+        context.worlds.forEachWorld([](World& world)
+        {
+            Broadphase& broadphase = world.editResource<Broadphase>();
+            broadphase.clearEvents();
+
+            for (const Entity entity : world.getMarked<RuntimeTransformComponent>())
+            {
+                if (world.hasComponent<BoundingBoxComponent>(entity))
+                    updateProxy(broadphase, entity, world.readComponent<BoundingBoxComponent>(entity));
+            }
+
+            for (const Entity entity : world.getMarked<BoundingBoxComponent>())
+            {
+                updateProxy(broadphase, entity, world.readComponent<BoundingBoxComponent>(entity));
+            }
+
+            broadphase.flush();
+        });
+    }
+
+    void shutdown(SystemContext&)
+    {
+        subscription.clear();
+    }
+}
+
+export namespace BroadphaseSystem
+{
+    SystemCallbacks callbacks{.init = init, .update = update, .shutdown = shutdown};
+}
@@ -0,0 +1,149 @@
+export module Systems.Physics;
+import Components.RigidBody;
+import Components.Transform;
+import Engine.SystemManager;
+import Engine.WorldManager;
+import Job;
+import Math;
+
+// Integrates rigid bodies with semi-implicit Euler at a fixed substep. Moving bodies are gathered into parallel arrays,
+// integrated in batches across the job system and written back through editComponent, so the transform, bounding box
+// and render systems see them as marked. Bodies move in the space of their TransformComponent, which is world space
+// for root entities.
+export namespace PhysicsSystem
+{
+    constexpr float fixedTimeStep = 1.f / 120.f;
+}
+
+namespace
+{
+    using PhysicsSystem::fixedTimeStep;
+    constexpr int maxSubsteps = 8; // Drops time rather than spiralling when a frame takes too long
+    constexpr std::size_t batchSize = 2048;
+    constexpr Vec3 gravity{0.f, -9.81f, 0.f};
+
+    struct BodyArrays
+    {
+        std::vector<Entity> entities;
+        std::vector<Vec3> positions;
+        std::vector<Quat> rotations;
+        std::vector<Vec3> velocities;
+        std::vector<Vec3> angularVelocities;
+        std::vector<float> inverseMasses;
+
+        void clear()
+        {
+            entities.clear();
+            positions.clear();
+            rotations.clear();
+            velocities.clear();
+            angularVelocities.clear();
+            inverseMasses.clear();
+        }
+
+        [[nodiscard]] std::size_t size() const { return entities.size(); }
+    };
+
+    BodyArrays bodies;
+    float accumulator = 0.f;
+
+    bool isAtRest(const RigidBodyComponent& body)
+    {
+        return body.inverseMass <= 0.f && body.velocity == Vec3{} && body.angularVelocity == Vec3{};
+    }
+
+    void gather(const World& world)
+    {
+        bodies.clear();
+
+        for (auto&& [entity, body, transform] : world.query<RigidBodyComponent, TransformComponent>())
+        {
+            if (isAtRest(body))
+                continue;
+
+            bodies.entities.push_back(entity);
+            bodies.positions.push_back(transform.position);
+            bodies.rotations.push_back(transform.rotation);
+            bodies.velocities.push_back(body.velocity);
+            bodies.angularVelocities.push_back(body.angularVelocity);
+            bodies.inverseMasses.push_back(body.inverseMass);
+        }
+    }
+
+    // Bodies don't interact yet, so each batch runs all the substeps on its own without syncing in between.
+    void integrate(std::size_t begin, std::size_t end, int substeps)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            Vec3 position = bodies.positions[i];
+            Quat rotation = bodies.rotations[i];
+            Vec3 velocity = bodies.velocities[i];
+            const Vec3& angularVelocity = bodies.angularVelocities[i];
+            const Quat spin{0.f, angularVelocity.x, angularVelocity.y, angularVelocity.z};
+            const Vec3 acceleration = bodies.inverseMasses[i] > 0.f ? gravity : Vec3{};
+
+            for (int step = 0; step < substeps; ++step)
+            {
+                velocity += acceleration * fixedTimeStep;
+                position += velocity * fixedTimeStep;
+                rotation = Math::normalize(rotation + spin * rotation * (0.5f * fixedTimeStep));
+            }
+
+            bodies.positions[i] = position;
+            bodies.rotations[i] = rotation;
+            bodies.velocities[i] = velocity;
+        }
+    }
+
+    void scatter(World& world)
+    {
+        for (std::size_t i = 0; i < bodies.size(); ++i)
+        {
+            const Entity entity = bodies.entities[i];
+            {
+                auto transform = world.editComponent<TransformComponent>(entity);
+                transform->position = bodies.positions[i];
+                transform->rotation = bodies.rotations[i];
+            }
+            world.editComponent<RigidBodyComponent>(entity)->velocity = bodies.velocities[i];
+        }
+    }
+
+    void init(SystemContext&)
+    {
+        accumulator = 0.f;
+    }
+
+    void update(SystemContext& context, float deltaTime)
+    {
+        accumulator += deltaTime;
+
+        const int substeps = std::min(static_cast<int>(accumulator / fixedTimeStep), maxSubsteps);
+        if (substeps == 0)
+            return;
+
+        accumulator = substeps == maxSubsteps ? 0.f : accumulator - substeps * fixedTimeStep;
+
+        context.worlds.forEachWorld([&](World& world)
+        {
+            gather(world);
+
+            context.jobs.parallelFor(bodies.size(), batchSize, [substeps](std::size_t begin, std::size_t end)
+            {
+                integrate(begin, end, substeps);
+            });
+
+            scatter(world);
+        });
+    }
+
+    void shutdown(SystemContext&)
+    {
+        bodies = {};
+    }
+}
+
+export namespace PhysicsSystem
+{
+    SystemCallbacks callbacks{.init = init, .update = update, .shutdown = shutdown};
+}
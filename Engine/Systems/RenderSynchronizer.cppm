@@ -9,6 +9,7 @@ import EventBus;
 import Math;
 import Render.CommandProcessor;
 import Render.Commands;
+import Render.DebugDraw;
 import World.Events;
 
 namespace
@@ -33,7 +34,8 @@ void init(SystemContext& context)
 
     subscription += context.worlds.subscribe([&](const WorldEvents::WorldDestroyed& event)
     {
-         context.renderCommands.addCommand(RenderCommands::RemoveWorld{.world = event.world});
+        DebugDraw::removeWorld(event.world);
+        context.renderCommands.addCommand(RenderCommands::RemoveWorld{.world = event.world});
     });
 
     subscription += context.worlds.subscribe([&](const WorldEvents::WorldCleared& event)
@@ -54,7 +56,7 @@ void init(SystemContext& context)
             const auto& component = world.readComponent<ModelComponent>(event.entity);
             const MeshData* mesh = context.assets.tryResolve<MeshData>(component.mesh);
             const TextureData* texture = context.assets.tryResolve<TextureData>(component.texture);
-            context.renderCommands.addCommand(RenderCommands::AddObject{event.world, event.entity, mesh, texture, getWorldTransform(world, event.entity), component.layer, component.tint});
+            context.renderCommands.addCommand(RenderCommands::AddObject{event.world, event.entity, mesh, texture, getWorldTransform(world, event.entity), component.layer, component.tint, component.occluder});
         }
     });
 
@@ -69,11 +71,19 @@ void update(SystemContext& context, float deltaTime)
 {
     context.worlds.forEachWorld([&](World& world)
     {
-        for (const Entity entity : world.getMarked<RuntimeTransformComponent>())
+        const std::span<const Entity> marked = world.getMarked<RuntimeTransformComponent>();
+        if (marked.empty())
+            return;
+
+        std::vector<RenderCommands::ObjectTransform> transforms;
+        transforms.reserve(marked.size());
+
+        for (const Entity entity : marked)
         {
-            const auto& transform = world.readComponent<RuntimeTransformComponent>(entity);
-            context.renderCommands.addCommand(RenderCommands::SetTransform{world.getHandle(), entity, transform.worldMatrix});
+            transforms.push_back({entity, world.readComponent<RuntimeTransformComponent>(entity).worldMatrix});
         }
+
+        context.renderCommands.addCommand(RenderCommands::SetTransforms{world.getHandle(), std::move(transforms)});
     });
 }
 
@@ -0,0 +1,80 @@
+export module Systems.SpatialHash;
+import Components.BoundingBox;
+import Components.Transform;
+import Engine.SystemManager;
+import Engine.WorldManager;
+import Math;
+import Physics.SpatialHashGrid;
+import World.Events;
+
+// Buckets every entity with a bounding box into its world's SpatialHashGrid by the center of its world bounds. Runs
+// after the bounding box system, so the bounds of this frame's moved entities are already up to date.
+namespace
+{
+    EventSubscription subscription;
+
+    void updateEntity(SpatialHashGrid& grid, Entity entity, const BoundingBoxComponent& box)
+    {
+        grid.update(entity, (box.minWorld + box.maxWorld) * 0.5f);
+    }
+
+    void init(SystemContext& context)
+    {
+        context.worlds.forEachWorld([](World& world)
+        {
+            SpatialHashGrid& grid = world.editResource<SpatialHashGrid>();
+            for (auto&& [entity, box] : world.query<BoundingBoxComponent>())
+            {
+                updateEntity(grid, entity, box);
+            }
+        });
+
+        subscription += context.worlds.subscribe([&worlds = context.worlds](const WorldEvents::ComponentAdded& event)
+        {
+            if (event.componentType == getTypeId<BoundingBoxComponent>())
+            {
+                World& world = worlds.get(event.world);
+                updateEntity(world.editResource<SpatialHashGrid>(), event.entity, world.readComponent<BoundingBoxComponent>(event.entity));
+            }
+        });
+
+        subscription += context.worlds.subscribe([&worlds = context.worlds](const WorldEvents::EntityDestroyed& event)
+        {
+            worlds.get(event.world).editResource<SpatialHashGrid>().remove(event.entity);
+        });
+
+        subscription += context.worlds.subscribe([&worlds = context.worlds](const WorldEvents::WorldCleared& event)
+        {
+            worlds.get(event.world).editResource<SpatialHashGrid>().clear();
+        });
+    }
+
+    void update(SystemContext& context, float)
+    {
+        context.worlds.forEachWorld([](World& world)
+        {
+            SpatialHashGrid& grid = world.editResource<SpatialHashGrid>();
+
+            for (const Entity entity : world.getMarked<RuntimeTransformComponent>())
+            {
+                if (world.hasComponent<BoundingBoxComponent>(entity))
+                    updateEntity(grid, entity, world.readComponent<BoundingBoxComponent>(entity));
+            }
+
+            for (const Entity entity : world.getMarked<BoundingBoxComponent>())
+            {
+                updateEntity(grid, entity, world.readComponent<BoundingBoxComponent>(entity));
+            }
+        });
+    }
+
+    void shutdown(SystemContext&)
+    {
+        subscription.clear();
+    }
+}
+
+export namespace SpatialHashSystem
+{
+    SystemCallbacks callbacks{.init = init, .update = update, .shutdown = shutdown};
+}
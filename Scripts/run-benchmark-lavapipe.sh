@@ -0,0 +1,68 @@
+#!/usr/bin/env bash
+# Runs the headless benchmark on lavapipe, Mesa's CPU Vulkan driver, so rendering can be checked on machines without a
+# GPU. The default grid draws 48x48 = 2304 objects, more than the 1000 descriptor sets the pool used to be limited to.
+# Fails unless the run used lavapipe, rendered every frame and logged no allocation failure or validation error.
+#
+# Usage: run-benchmark-lavapipe.sh [BUILD_DIR] [GRID]
+#   BUILD_DIR  defaults to the development preset's build directory
+#   GRID       cones per side of the benchmark grid, defaults to 48
+set -eo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+
+BUILD_DIR="${1:-$PROJECT_DIR/../ECSGameEngine-build/development}"
+GRID="${2:-48}"
+BENCHMARK="$BUILD_DIR/bin/Benchmark"
+
+if [ ! -x "$BENCHMARK" ]; then
+    echo "Could not find $BENCHMARK, build the Benchmark target first"
+    exit 1
+fi
+
+ICD=""
+for candidate in /usr/share/vulkan/icd.d/lvp_icd.*.json /etc/vulkan/icd.d/lvp_icd.*.json; do
+    if [ -f "$candidate" ]; then
+        ICD="$candidate"
+        break
+    fi
+done
+
+if [ -z "$ICD" ]; then
+    echo "Could not find the lavapipe ICD, install mesa-vulkan-drivers"
+    exit 1
+fi
+
+OUTPUT_DIR="$BUILD_DIR/lavapipe"
+mkdir -p "$OUTPUT_DIR"
+
+echo "Running $GRID x $GRID objects on $ICD..."
+
+# Lavapipe is slow, a few hundred frames are enough to cycle through every object and catch pool exhaustion
+cd "$OUTPUT_DIR"
+VK_DRIVER_FILES="$ICD" VK_ICD_FILENAMES="$ICD" "$BENCHMARK" \
+    --grid "$GRID" \
+    --frames 300 \
+    --warmup 10 \
+    --size 640x360 \
+    --output "$OUTPUT_DIR/timings.csv" \
+    --capture-dir "$OUTPUT_DIR" \
+    --capture-every 100 2>&1 | tee "$OUTPUT_DIR/benchmark.log"
+
+if ! grep -q "Using device: llvmpipe" "$OUTPUT_DIR/benchmark.log"; then
+    echo "The benchmark did not run on lavapipe"
+    exit 1
+fi
+
+if ! grep -q "^300 frames at 640x360, $((GRID * GRID)) objects" "$OUTPUT_DIR/benchmark.log"; then
+    echo "The benchmark did not render every frame"
+    exit 1
+fi
+
+if grep -Eq "Failed to allocate|OUT_OF_POOL_MEMORY|VUID-" "$OUTPUT_DIR/benchmark.log"; then
+    echo "The benchmark ran out of descriptors or hit validation errors:"
+    grep -E "Failed to allocate|OUT_OF_POOL_MEMORY|VUID-" "$OUTPUT_DIR/benchmark.log" | sort | uniq -c
+    exit 1
+fi
+
+echo "Done, results in $OUTPUT_DIR"
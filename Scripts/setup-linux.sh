@@ -19,6 +19,7 @@ sudo dnf install -y \
     libasan \
     libxkbcommon-devel \
     mesa-libGL-devel \
+    mesa-vulkan-drivers \
     ninja-build \
     pkgconf-pkg-config \
     vulkan-headers \